@@ -0,0 +1,47 @@
+#include "assetManagerProvider.h"
+#include "environmentProvider.h"
+
+#include <android/asset_manager_jni.h>
+#include <jni.h>
+#include <pthread.h>
+
+// Asset manager of the application context, kept alive by a global reference for the process
+static jobject gAssets = NULL;
+static AAssetManager* gAssetManager = NULL;
+static pthread_mutex_t gAssetManagerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Must be called with the asset manager mutex held
+static void captureAssetManager(JNIEnv* env, jobject context) {
+    jclass contextClass = env->GetObjectClass(context);
+    jmethodID getAssets = env->GetMethodID(contextClass, "getAssets", "()Landroid/content/res/AssetManager;");
+    jobject assets = getAssets != NULL ? env->CallObjectMethod(context, getAssets) : NULL;
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+        assets = NULL;
+    }
+    if (assets != NULL) {
+        gAssets = env->NewGlobalRef(assets);
+        gAssetManager = AAssetManager_fromJava(env, gAssets);
+        env->DeleteLocalRef(assets);
+    }
+    env->DeleteLocalRef(contextClass);
+}
+
+extern "C" {
+
+    void* getAssetManager(void) {
+        pthread_mutex_lock(&gAssetManagerMutex);
+        if (gAssetManager == NULL) {
+            JNIEnv* env = NULL;
+            jobject context = NULL;
+            getEnvironment((void**) &env);
+            getContext(&context);
+            if (env != NULL && context != NULL) {
+                captureAssetManager(env, context);
+            }
+        }
+        AAssetManager* assetManager = gAssetManager;
+        pthread_mutex_unlock(&gAssetManagerMutex);
+        return assetManager;
+    }
+}
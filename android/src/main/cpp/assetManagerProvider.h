@@ -0,0 +1,10 @@
+#ifndef ASSET_MANAGER_PROVIDER_HEADER
+
+#define ASSET_MANAGER_PROVIDER_HEADER
+
+extern "C" {
+    // Returns the AAssetManager of the application, or NULL before the plugin attached. It is
+    // taken from the context of the plugin on the first call and kept for the process.
+    void* getAssetManager(void);
+}
+#endif // ASSET_MANAGER_PROVIDER_HEADER
@@ -1,34 +1,142 @@
 #include "environmentProvider.h"
 
 #include <jni.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const kPluginClass = "com/build38/tak/flutter/TakPlugin";
 
 extern "C" {
     JavaVM* gJavaVM;
     jobject gContext = NULL;
+}
+
+// Working path of the application, set when the plugin attaches. A replaced path is not freed,
+// Dart may still be reading it, and it only changes if the application files directory moves.
+static char* gWorkingPath = NULL;
+static pthread_mutex_t gEnvironmentMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Holds the JNIEnv of the threads attached here, so they are attached once and detached on exit.
+// Threads attached by the JVM itself or by someone else are never stored, nor detached.
+static pthread_key_t gEnvironmentKey;
+static pthread_once_t gEnvironmentKeyOnce = PTHREAD_ONCE_INIT;
+
+static void detachCurrentThread(void* environment) {
+    JavaVM* javaVM = gJavaVM;
+    if (environment != NULL && javaVM != NULL) {
+        javaVM->DetachCurrentThread();
+    }
+}
+
+static void createEnvironmentKey() {
+    pthread_key_create(&gEnvironmentKey, detachCurrentThread);
+}
+
+// TakPlugin.attachEnvironment, called when the plugin attaches to an engine
+static void attachEnvironment(JNIEnv* env, jobject thiz, jobject context, jstring workingPath) {
+    jobject previous = gContext;
+    gContext = env->NewGlobalRef(context);
+    if (previous != NULL) {
+        env->DeleteGlobalRef(previous);
+    }
+
+    pthread_mutex_lock(&gEnvironmentMutex);
+    const char* path = env->GetStringUTFChars(workingPath, NULL);
+    if (path != NULL) {
+        if (gWorkingPath == NULL || strcmp(gWorkingPath, path) != 0) {
+            char* copy = strdup(path);
+            if (copy != NULL) {
+                gWorkingPath = copy;
+            }
+        }
+        env->ReleaseStringUTFChars(workingPath, path);
+    }
+    pthread_mutex_unlock(&gEnvironmentMutex);
+}
+
+// Registered up front, so attaching does not wait for the JVM to look the method up by name
+static void registerNatives(JNIEnv* env) {
+    jclass plugin = env->FindClass(kPluginClass);
+    if (plugin == NULL) {
+        env->ExceptionClear();
+        return;
+    }
+    static const JNINativeMethod methods[] = {
+        {"attachEnvironment", "(Landroid/content/ContextWrapper;Ljava/lang/String;)V", (void*) attachEnvironment},
+    };
+    if (env->RegisterNatives(plugin, methods, sizeof(methods) / sizeof(methods[0])) != JNI_OK) {
+        env->ExceptionClear();
+    }
+    env->DeleteLocalRef(plugin);
+}
+
+extern "C" {
 
     jint JNI_OnLoad(JavaVM* vm, void* reserved) {
         gJavaVM = vm;
+        pthread_once(&gEnvironmentKeyOnce, createEnvironmentKey);
+        JNIEnv* env = NULL;
+        if (vm->GetEnv((void**) &env, JNI_VERSION_1_6) == JNI_OK) {
+            registerNatives(env);
+        }
         return JNI_VERSION_1_6;
     }
 
-    JNIEXPORT jint JNICALL
-    Java_com_build38_tak_flutter_TakPlugin_loadEnvironment(JNIEnv *env, jobject thiz, jobject context) {
-        gContext = env->NewGlobalRef(context);
-        return 0;
+    void getEnvironment(void** environment) {
+        *environment = NULL;
+        JavaVM* javaVM = gJavaVM;
+        if (javaVM == NULL) {
+            return;
+        }
+        pthread_once(&gEnvironmentKeyOnce, createEnvironmentKey);
+
+        JNIEnv* cached = (JNIEnv*) pthread_getspecific(gEnvironmentKey);
+        if (cached != NULL) {
+            *environment = cached;
+            return;
+        }
+        if (javaVM->GetEnv(environment, JNI_VERSION_1_6) == JNI_OK) {
+            return;
+        }
+
+        JNIEnv* attached = NULL;
+        // The NDK declares the environment as JNIEnv**, desktop JVMs as void**
+#if defined __ANDROID__
+        jint attachResult = javaVM->AttachCurrentThread(&attached, NULL);
+#else
+        jint attachResult = javaVM->AttachCurrentThread((void**) &attached, NULL);
+#endif
+        if (attachResult != JNI_OK) {
+            return;
+        }
+        pthread_setspecific(gEnvironmentKey, attached);
+        *environment = attached;
     }
 
-    void getEnvironment(void** environment) {
-        (*gJavaVM).AttachCurrentThread((JNIEnv **) environment, NULL);
+    void attachCurrentThread(void) {
+        void* environment;
+        getEnvironment(&environment);
     }
 
     void getContext(void* context) {
         *((jobject*) context) = gContext;
     }
 
+    const char* getWorkingPath(void) {
+        pthread_mutex_lock(&gEnvironmentMutex);
+        const char* workingPath = gWorkingPath;
+        pthread_mutex_unlock(&gEnvironmentMutex);
+        return workingPath;
+    }
+
     void releaseEnvironment() {
         JNIEnv* jniEnvironment = NULL;
-        (*gJavaVM).AttachCurrentThread(&jniEnvironment, NULL);
-        (*jniEnvironment).DeleteGlobalRef(gContext);
-        gJavaVM = NULL;
+        getEnvironment((void**) &jniEnvironment);
+        if (jniEnvironment != NULL) {
+            jniEnvironment->DeleteGlobalRef(gContext);
+        }
+        // The JVM is kept, threads attached here still have to be detached when they exit
+        gContext = NULL;
     }
-}
\ No newline at end of file
+}
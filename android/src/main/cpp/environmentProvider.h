@@ -1,11 +1,16 @@
-
 #ifndef ENVIRONMENT_PROVIDER_HEADER
 
 #define ENVIRONMENT_PROVIDER_HEADER
 
 extern "C" {
+    // Returns the JNIEnv of the calling thread, or NULL without a JVM. A native thread is attached
+    // on its first call and detached when it exits.
     void getEnvironment(void** environment);
+    // Attaches the calling thread ahead of its first TakLib call, for threads started natively.
+    void attachCurrentThread(void);
     void getContext(void* context);
+    // Returns the working path set when the plugin attached, or NULL before. The string stays valid.
+    const char* getWorkingPath(void);
     void releaseEnvironment(void);
 }
-#endif // ENVIRONMENT_PROVIDER_HEADER
\ No newline at end of file
+#endif // ENVIRONMENT_PROVIDER_HEADER
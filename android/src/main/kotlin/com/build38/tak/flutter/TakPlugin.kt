@@ -29,20 +29,21 @@ class TakPlugin: FlutterPlugin, MethodCallHandler {
     }
 
     /**
-     * Sets up MethodChannel, and gets the application context.
+     * Sets up MethodChannel, gets the application context and hands it to the native library
+     * together with the working directory, so Dart reads them without a channel round trip.
      */
     override fun onAttachedToEngine(flutterPluginBinding: FlutterPlugin.FlutterPluginBinding) {
         channel = MethodChannel(flutterPluginBinding.binaryMessenger, "tak")
         channel.setMethodCallHandler(this)
         context = flutterPluginBinding.applicationContext
+        attachEnvironment(ContextWrapper(context), context.filesDir.absolutePath)
     }
 
     /**
-     * Loads TAK environment and returns the working directory.
+     * Returns the working directory, for when Dart runs before the plugin attached.
      */
     override fun onMethodCall(call: MethodCall, result: Result) {
         if (call.method == "loadEnvironment") {
-            loadEnvironment(ContextWrapper(context))
             val workingPath = context.filesDir.absolutePath
             result.success(workingPath)
         } 
@@ -58,5 +59,6 @@ class TakPlugin: FlutterPlugin, MethodCallHandler {
         channel.setMethodCallHandler(null)
     }
 
-    private external fun loadEnvironment(context: ContextWrapper): Int
+    // Registered by JNI_OnLoad
+    private external fun attachEnvironment(context: ContextWrapper, workingPath: String)
 }
\ No newline at end of file
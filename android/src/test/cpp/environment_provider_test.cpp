@@ -0,0 +1,151 @@
+#include "environmentProvider.h"
+
+#include <jni.h>
+#include <pthread.h>
+#include <stdio.h>
+
+extern "C" jint JNI_OnLoad(JavaVM* vm, void* reserved);
+
+static JavaVM* gVm = NULL;
+static int gFailures = 0;
+
+#define CHECK(condition)                                                     \
+    do {                                                                     \
+        if (!(condition)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                    #condition);                                             \
+            gFailures++;                                                     \
+        }                                                                    \
+    } while (0)
+
+// Threads of the main thread group, which threads attached without arguments join
+static jint activeThreads(JNIEnv* env) {
+    jclass threadClass = env->FindClass("java/lang/Thread");
+    jmethodID activeCount = env->GetStaticMethodID(threadClass, "activeCount", "()I");
+    jint count = env->CallStaticIntMethod(threadClass, activeCount);
+    env->DeleteLocalRef(threadClass);
+    return count;
+}
+
+static bool isAttached() {
+    JNIEnv* env = NULL;
+    return gVm->GetEnv((void**) &env, JNI_VERSION_1_6) == JNI_OK;
+}
+
+struct Observed {
+    bool attachedBefore;
+    JNIEnv* first;
+    JNIEnv* second;
+    bool attachedAfter;
+};
+
+static void* attachOnFirstCall(void* argument) {
+    Observed* observed = (Observed*) argument;
+    observed->attachedBefore = isAttached();
+    getEnvironment((void**) &observed->first);
+    getEnvironment((void**) &observed->second);
+    observed->attachedAfter = isAttached();
+    return NULL;
+}
+
+static void* attachAhead(void* argument) {
+    Observed* observed = (Observed*) argument;
+    attachCurrentThread();
+    observed->attachedBefore = isAttached();
+    getEnvironment((void**) &observed->first);
+    observed->second = observed->first;
+    observed->attachedAfter = isAttached();
+    return NULL;
+}
+
+// Attached by someone else, who also detaches it: the provider must leave it alone on exit
+static void* attachedElsewhere(void* argument) {
+    Observed* observed = (Observed*) argument;
+    JNIEnv* own = NULL;
+    gVm->AttachCurrentThread((void**) &own, NULL);
+    getEnvironment((void**) &observed->first);
+    observed->second = own;
+    observed->attachedAfter = gVm->DetachCurrentThread() == JNI_OK;
+    return NULL;
+}
+
+static Observed runThread(void* (*main)(void*)) {
+    Observed observed = {};
+    pthread_t thread;
+    pthread_create(&thread, NULL, main, &observed);
+    pthread_join(thread, NULL);
+    return observed;
+}
+
+static void testLoadWithoutPluginClass(JNIEnv* env) {
+    // TakPlugin is not on the class path, registering its natives must not leave an exception
+    CHECK(JNI_OnLoad(gVm, NULL) == JNI_VERSION_1_6);
+    CHECK(!env->ExceptionCheck());
+}
+
+static void testJvmThreadIsNotReattached(JNIEnv* env) {
+    JNIEnv* environment = NULL;
+    getEnvironment((void**) &environment);
+    CHECK(environment == env);
+}
+
+static void testNativeThreadIsAttachedOnceAndDetachedOnExit(JNIEnv* env) {
+    jint before = activeThreads(env);
+    Observed observed = runThread(attachOnFirstCall);
+    CHECK(!observed.attachedBefore);
+    CHECK(observed.first != NULL);
+    CHECK(observed.second == observed.first);
+    CHECK(observed.attachedAfter);
+    CHECK(activeThreads(env) == before);
+}
+
+static void testThreadStartHookAttaches(JNIEnv* env) {
+    jint before = activeThreads(env);
+    Observed observed = runThread(attachAhead);
+    CHECK(observed.attachedBefore);
+    CHECK(observed.first != NULL);
+    CHECK(observed.attachedAfter);
+    CHECK(activeThreads(env) == before);
+}
+
+static void testForeignAttachmentIsNotDetached(JNIEnv* env) {
+    jint before = activeThreads(env);
+    Observed observed = runThread(attachedElsewhere);
+    CHECK(observed.first == observed.second);
+    CHECK(observed.attachedAfter);
+    CHECK(activeThreads(env) == before);
+}
+
+static void testManyThreadsDoNotLeakAttachments(JNIEnv* env) {
+    jint before = activeThreads(env);
+    for (int i = 0; i < 64; i++) {
+        runThread(attachOnFirstCall);
+    }
+    CHECK(activeThreads(env) == before);
+}
+
+int main() {
+    JavaVMInitArgs arguments = {};
+    arguments.version = JNI_VERSION_1_6;
+    arguments.ignoreUnrecognized = JNI_TRUE;
+    JNIEnv* env = NULL;
+    if (JNI_CreateJavaVM(&gVm, (void**) &env, &arguments) != JNI_OK) {
+        fprintf(stderr, "Could not create the JVM\n");
+        return 1;
+    }
+
+    testLoadWithoutPluginClass(env);
+    testJvmThreadIsNotReattached(env);
+    testNativeThreadIsAttachedOnceAndDetachedOnExit(env);
+    testThreadStartHookAttaches(env);
+    testForeignAttachmentIsNotDetached(env);
+    testManyThreadsDoNotLeakAttachments(env);
+
+    gVm->DestroyJavaVM();
+    if (gFailures != 0) {
+        fprintf(stderr, "%d checks failed\n", gFailures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
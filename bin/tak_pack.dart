@@ -0,0 +1,90 @@
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+/// Packs protected assets into a single indexed asset pack, read with [FileProtector.openAssetPack].
+///
+/// Usage: dart run tak:tak_pack -o assets/resources.takpack assets/protected/*.tak
+///
+/// Each entry is named after its file, without the .tak extension, and holds the protected file as
+/// it is: entries stay encrypted for the application, the pack only saves opening each of them.
+/// The format is described in src/asset_pack.h.
+const List<int> _magic = [0x54, 0x41, 0x4B, 0x50, 0x41, 0x43, 0x4B, 0x31];
+const int _headerSize = 16;
+const String _extension = '.tak';
+
+void main(List<String> arguments) {
+  String? output;
+  final inputs = <String>[];
+  for (int i = 0; i < arguments.length; i++) {
+    if (arguments[i] == '-o' && i + 1 < arguments.length) {
+      output = arguments[++i];
+    } else {
+      inputs.add(arguments[i]);
+    }
+  }
+  if (output == null || inputs.isEmpty) {
+    stderr.writeln('Usage: tak_pack -o <pack> <file.tak>...');
+    exit(64);
+  }
+
+  final entries = <String, File>{};
+  for (final input in inputs) {
+    String name = input.split(Platform.pathSeparator).last;
+    if (name.endsWith(_extension)) {
+      name = name.substring(0, name.length - _extension.length);
+    }
+    if (name.isEmpty || utf8.encode(name).length > 0xFFFF) {
+      stderr.writeln('Invalid entry name for $input');
+      exit(65);
+    }
+    if (entries.containsKey(name)) {
+      stderr.writeln('Two files are named $name');
+      exit(65);
+    }
+    entries[name] = File(input);
+  }
+  final names = entries.keys.toList()..sort();
+
+  int indexSize = 0;
+  for (final name in names) {
+    indexSize += 2 + utf8.encode(name).length + 16;
+  }
+  final index = BytesBuilder();
+  int offset = _headerSize + indexSize;
+  for (final name in names) {
+    final encodedName = utf8.encode(name);
+    final size = entries[name]!.lengthSync();
+    final fields = ByteData(16)
+      ..setUint64(0, offset, Endian.little)
+      ..setUint64(8, size, Endian.little);
+    index
+      ..add((ByteData(2)..setUint16(0, encodedName.length, Endian.little))
+          .buffer
+          .asUint8List())
+      ..add(encodedName)
+      ..add(fields.buffer.asUint8List());
+    offset += size;
+  }
+
+  final header = ByteData(_headerSize);
+  for (int i = 0; i < _magic.length; i++) {
+    header.setUint8(i, _magic[i]);
+  }
+  header
+    ..setUint32(8, names.length, Endian.little)
+    ..setUint32(12, indexSize, Endian.little);
+
+  final pack = File(output).openSync(mode: FileMode.write);
+  try {
+    pack
+      ..writeFromSync(header.buffer.asUint8List())
+      ..writeFromSync(index.takeBytes());
+    for (final name in names) {
+      pack.writeFromSync(entries[name]!.readAsBytesSync());
+    }
+  } finally {
+    pack.closeSync();
+  }
+  stdout.writeln('Packed ${names.length} assets into $output');
+}
@@ -0,0 +1,75 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:tak/native_tak/tak.dart';
+import 'package:tak/native_tak/tak_byte_array_response.dart';
+import 'package:tak/tak_return_codes.dart';
+
+/// A pack of protected assets, built with `dart run tak:tak_pack`.
+///
+/// The pack is opened and indexed once, its entries are then read by name without looking up a
+/// file for each of them. Use [FileProtector.openAssetPack] to open a pack, and [close] it once
+/// its entries are no longer needed.
+class AssetPack {
+  // Native handle of this pack, 0 once closed.
+  int _handle;
+
+  AssetPack._(this._handle);
+
+  /// Opens the pack at [path]: an absolute path, or on Android a path in the application package
+  /// such as `flutter_assets/assets/resources.takpack`. See [FileProtector.openAssetPack] for the
+  /// packs bundled as Flutter assets.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.generalError] when the pack is missing or malformed.
+  factory AssetPack.open(String path) {
+    final nativePath = path.toNativeUtf8();
+    final handle = malloc<Int32>();
+    int response = nativeAssetPackOpen(nativePath.cast<Char>(), handle);
+    int value = handle.value;
+    malloc.free(handle);
+    malloc.free(nativePath);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+    return AssetPack._(value);
+  }
+
+  /// Number of entries of the pack.
+  int get length {
+    int count = nativeAssetPackEntryCount(_handle);
+    if (count < 0) {
+      throw TakException(TakReturnCode.invalidParameter);
+    }
+    return count;
+  }
+
+  /// Decrypts the entry [name], the name of its file without the .tak extension.
+  ///
+  /// Throws a [TakException] with the following error codes:
+  /// - [TakReturnCode.apiNotInitialized] when T.A.K was not initialized before calling this method.
+  /// - [TakReturnCode.invalidParameter] when the pack is closed.
+  /// - [TakReturnCode.generalError] when the pack has no such entry, or an unexpected error happens.
+  Uint8List read(String name) {
+    final nativeName = name.toNativeUtf8();
+    TakByteBufferResponse response =
+        nativeAssetPackRead(_handle, nativeName.cast<Char>());
+    malloc.free(nativeName);
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnValue);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+    return response.getValue();
+  }
+
+  /// Closes the pack. Reads in progress on other isolates complete first.
+  void close() {
+    if (_handle == 0) {
+      return;
+    }
+    nativeAssetPackClose(_handle);
+    _handle = 0;
+  }
+}
@@ -1,10 +1,14 @@
 import 'dart:ffi';
 import 'dart:typed_data';
 
+import 'package:tak/asset_pack.dart';
+import 'package:tak/native_tak/async_call.dart';
+import 'package:tak/native_tak/read_into_response.dart';
 import 'package:tak/native_tak/tak.dart';
 import 'package:tak/native_tak/tak_byte_array_response.dart';
-import 'package:tak/native_tak/tak_byte_buffer.dart';
+import 'package:tak/native_tak/tak_executor.dart';
 import 'package:tak/tak_plugin.dart';
+import 'package:tak/tak_priority.dart';
 import 'package:tak/tak_return_codes.dart';
 
 import 'package:ffi/ffi.dart';
@@ -22,7 +26,8 @@ class FileProtector {
   ///
   /// [fileName]: The name of the file to be decrypted.
   ///
-  /// Returns the decrypted data as a Uint8List.
+  /// Returns the decrypted data as a Uint8List. Decrypted files are kept in a native cache once it
+  /// is enabled, see [TakPlugin.configureAssetCache] and [prefetch].
   ///
   /// Throws a [TakException] with the following error codes:
   /// - [TakReturnCode.apiNotInitialized] when T.A.K was not initialized before calling this method.
@@ -41,6 +46,61 @@ class FileProtector {
     }
   }
 
+  /// Opens a pack of protected assets built with `dart run tak:tak_pack`.
+  ///
+  /// [packName]: Name of the pack in the assets, with its extension.
+  ///
+  /// Reading many protected assets from one pack opens a single asset instead of one per file.
+  /// Entries are read with [AssetPack.read], under the name [decryptFromFile] would take.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.generalError] when the pack is missing or malformed.
+  AssetPack openAssetPack(String packName) {
+    return AssetPack.open('flutter_assets/assets/$packName');
+  }
+
+  /// Decrypts a large protected file.
+  ///
+  /// Works as [decryptFromFile], but the encrypted file is mapped in memory instead of being read
+  /// into a copy, and the decrypted data is returned without another copy. Decrypted files are not
+  /// kept in the native cache, so this suits files of several megabytes read once.
+  Uint8List decryptFromFileMapped(String fileName) {
+    final file = 'flutter_assets/assets/$fileName'.toNativeUtf8();
+    final extension = 'tak'.toNativeUtf8();
+    TakByteBufferResponse response = nativeFileProtectorDecryptMapped(
+        file.cast<Char>(), extension.cast<Char>());
+    malloc.free(file);
+    malloc.free(extension);
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnValue);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+    return response.getValue();
+  }
+
+  /// Decrypts a large protected file into memory provided by the caller.
+  ///
+  /// Works as [decryptFromFileMapped], but writes the decrypted data to [destination], such as a
+  /// buffer handed to a decoder, and returns the number of bytes written. If the decrypted data does
+  /// not fit in [destination] nothing is written and the required size, greater than [capacity], is
+  /// returned instead.
+  int decryptFromFileInto(
+      String fileName, Pointer<Uint8> destination, int capacity) {
+    final file = 'flutter_assets/assets/$fileName'.toNativeUtf8();
+    final extension = 'tak'.toNativeUtf8();
+    ReadIntoResponse response = nativeFileProtectorDecryptMappedInto(
+        file.cast<Char>(), extension.cast<Char>(), destination, capacity);
+    malloc.free(file);
+    malloc.free(extension);
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnCode);
+    if (mapResponse != TakReturnCode.success &&
+        mapResponse != TakReturnCode.bufferTooSmall) {
+      throw TakException(mapResponse);
+    }
+    return response.length;
+  }
+
   /// Encrypts a byte buffer, returning it ready to be securely stored in persistent storage.
   ///
   /// The data is encrypted with a random AES key in GCM mode. The random AES key gets then encrypted by the WBC
@@ -58,13 +118,9 @@ class FileProtector {
   ///                                  This method is unavailable until the instance is unlocked.
 
   Uint8List encrypt(Uint8List dataToEncrypt) {
-    final dataPointer = uint8ListToPointer(dataToEncrypt);
-
-    final takByteBufferPtr = calloc<TakByteBuffer>();
-    final takByteBuffer = takByteBufferPtr.ref
-      ..buffer = dataPointer
-      ..bufferLength = dataToEncrypt.length;
-    TakByteBufferResponse response = nativeFileProtectorEncrypt(takByteBuffer);
+    TakByteBufferResponse response = using((Arena arena) =>
+        nativeFileProtectorEncryptData(
+            nativeCopyOf(arena, dataToEncrypt), dataToEncrypt.length));
 
     TakReturnCode mapResponse =
         TakReturnCodeMapper.mapErrorCode(response.returnValue);
@@ -91,13 +147,9 @@ class FileProtector {
   /// - [TakReturnCode.generalError] when an unexpected error happens.
 
   Uint8List decrypt(Uint8List dataToDecrypt) {
-    final dataPointer = uint8ListToPointer(dataToDecrypt);
-
-    final takByteBufferPtr = calloc<TakByteBuffer>();
-    final takByteBuffer = takByteBufferPtr.ref
-      ..buffer = dataPointer
-      ..bufferLength = dataToDecrypt.length;
-    TakByteBufferResponse response = nativeFileProtectorDecrypt(takByteBuffer);
+    TakByteBufferResponse response = using((Arena arena) =>
+        nativeFileProtectorDecryptData(
+            nativeCopyOf(arena, dataToDecrypt), dataToDecrypt.length));
 
     TakReturnCode mapResponse =
         TakReturnCodeMapper.mapErrorCode(response.returnValue);
@@ -108,18 +160,137 @@ class FileProtector {
     }
   }
 
+  /// Decrypts the files [fileNames] into the asset cache on a native background thread.
+  ///
+  /// Meant to be called right after initialization with the assets read repeatedly: once
+  /// prefetched, [decryptFromFile] returns them from the cache. A call for an asset still being
+  /// prefetched waits for it instead of decrypting it again. Files that fail to decrypt are
+  /// decrypted again, and reported, by the next [decryptFromFile].
+  ///
+  /// Does nothing until the cache is enabled, see [TakPlugin.configureAssetCache].
+  void prefetch(List<String> fileNames) {
+    if (fileNames.isEmpty) {
+      return;
+    }
+    using((Arena arena) {
+      final natives = arena<Pointer<Char>>(fileNames.length);
+      for (int i = 0; i < fileNames.length; i++) {
+        natives[i] = 'flutter_assets/assets/${fileNames[i]}'
+            .toNativeUtf8(allocator: arena)
+            .cast<Char>();
+      }
+      int response = nativePrefetchAssets(natives, fileNames.length,
+          "tak".toNativeUtf8(allocator: arena).cast<Char>());
+      TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+      if (mapResponse != TakReturnCode.success) {
+        throw TakException(mapResponse);
+      }
+    });
+  }
+
+  /// Decrypts a file without blocking the calling isolate.
+  ///
+  /// Works as [decryptFromFile], but the file is read and decrypted on a native worker thread
+  /// with the given [priority].
+  Future<Uint8List> decryptFromFileAsync(String fileName,
+      {TakPriority? priority}) {
+    String file = 'flutter_assets/assets/$fileName';
+    return TakExecutor.instance
+        .call(AsyncOperation.fileProtectorDecryptFromFile, _takeBuffer,
+            (arena, call) {
+      call
+        ..text = file.toNativeUtf8(allocator: arena)
+        ..secondText = "tak".toNativeUtf8(allocator: arena);
+    }, AsyncLane.of(priority));
+  }
+
+  /// Encrypts a byte buffer without blocking the calling isolate.
+  ///
+  /// Works as [encrypt], but the data is copied and encrypted on a native worker thread with the
+  /// given [priority].
+  Future<Uint8List> encryptAsync(Uint8List dataToEncrypt,
+      {TakPriority? priority}) {
+    return TakExecutor.instance.call(
+        AsyncOperation.fileProtectorEncrypt,
+        _takeBuffer,
+        (arena, call) => _copyInput(arena, call, dataToEncrypt),
+        AsyncLane.of(priority));
+  }
+
+  /// Decrypts a byte buffer without blocking the calling isolate.
+  ///
+  /// Works as [decrypt], but the data is copied and decrypted on a native worker thread with the
+  /// given [priority].
+  Future<Uint8List> decryptAsync(Uint8List dataToDecrypt,
+      {TakPriority? priority}) {
+    return TakExecutor.instance.call(
+        AsyncOperation.fileProtectorDecrypt,
+        _takeBuffer,
+        (arena, call) => _copyInput(arena, call, dataToDecrypt),
+        AsyncLane.of(priority));
+  }
+
+  /// Decrypts a byte buffer into memory provided by the caller.
+  ///
+  /// Works as [decrypt], but writes the decrypted data to [destination] instead of allocating a new
+  /// buffer. The decrypted data is at most 128 bytes shorter than [dataToDecrypt].
+  ///
+  /// [dataToDecrypt]: Data to be decrypted.
+  /// [destination]: Native memory the decrypted data is written to.
+  /// [capacity]: Size of [destination].
+  ///
+  /// Returns the number of bytes written. If the decrypted data does not fit in [destination]
+  /// nothing is written and the required size, greater than [capacity], is returned instead.
+  ///
+  /// Throws a [TakException] in case of errors, including:
+  /// - [TakReturnCode.apiNotInitialized] when T.A.K was not initialized before calling this method.
+  /// - [TakReturnCode.invalidParameter] when plain data has length 0.
+  /// - [TakReturnCode.generalError] when an unexpected error happens.
+  int decryptInto(
+      Uint8List dataToDecrypt, Pointer<Uint8> destination, int capacity) {
+    ReadIntoResponse response = using((Arena arena) =>
+        nativeFileProtectorDecryptInto(nativeCopyOf(arena, dataToDecrypt),
+            dataToDecrypt.length, destination, capacity));
+
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnCode);
+    if (mapResponse != TakReturnCode.success &&
+        mapResponse != TakReturnCode.bufferTooSmall) {
+      throw TakException(mapResponse);
+    }
+    return response.length;
+  }
+
+  // Worker threads cannot use Dart memory, which may move while they run
+  void _copyInput(Arena arena, AsyncCall call, Uint8List data) {
+    final input = arena<Uint8>(data.length);
+    input.asTypedList(data.length).setAll(0, data);
+    call
+      ..data = input
+      ..dataLength = data.length;
+  }
+
+  Uint8List _takeBuffer(AsyncCall call) {
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(call.returnCode);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+    return call.takeBuffer();
+  }
+
   /// Converts a Uint8List to a Pointer<Uint8>.
   ///
   /// This function allocates memory on the native heap using calloc,
   /// copies the bytes from the Uint8List to the allocated memory,
   /// and returns a Pointer to the allocated memory.
+  /// The caller owns the memory and must release it with `calloc.free`.
   /// Parameters: - list: The Uint8List to convert to a Pointer.
   /// Returns:  A Pointer<Uint8> pointing to the memory allocated on the native heap.
+  @Deprecated('Copy with nativeCopyOf into an Arena, released with the arena')
   Pointer<Uint8> uint8ListToPointer(Uint8List list) {
     final ptr = calloc<Uint8>(list.length);
-    for (var i = 0; i < list.length; i++) {
-      ptr[i] = list[i];
-    }
+    ptr.asTypedList(list.length).setAll(0, list);
     return ptr;
   }
 }
@@ -0,0 +1,32 @@
+import 'dart:ffi';
+
+/// Usage counters of the native cache of decrypted assets.
+final class AssetCacheStats extends Struct {
+  /// Maximum number of decrypted bytes the cache may hold.
+  @Uint64()
+  external int capacity;
+
+  /// Number of decrypted bytes held.
+  @Uint64()
+  external int bytesInUse;
+
+  /// Number of assets held.
+  @Uint64()
+  external int entries;
+
+  /// Number of requests served from the cache.
+  @Uint64()
+  external int hits;
+
+  /// Number of requests that decrypted the asset.
+  @Uint64()
+  external int misses;
+
+  /// Number of assets dropped to stay within the capacity.
+  @Uint64()
+  external int evictions;
+
+  /// Number of assets decrypted by a prefetch.
+  @Uint64()
+  external int prefetched;
+}
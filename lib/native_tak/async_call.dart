@@ -0,0 +1,99 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:tak/native_tak/tak.dart';
+import 'package:tak/native_tak/tak_byte_buffer.dart';
+import 'package:tak/tak_priority.dart';
+
+/// Blocking native calls that can run on the worker pool, mirrors `AsyncOperation` in native_tak.h.
+abstract final class AsyncOperation {
+  static const int register = 1;
+  static const int checkIntegrity = 2;
+  static const int updatePinnedCertificates = 3;
+  static const int tlsConnect = 4;
+  static const int tlsRead = 5;
+  static const int tlsReadInto = 6;
+  static const int tlsWritev = 7;
+  static const int tlsFlush = 8;
+  static const int storageRead = 9;
+  static const int storageWrite = 10;
+  static const int storageDeleteEntry = 11;
+  static const int fileProtectorEncrypt = 12;
+  static const int fileProtectorDecrypt = 13;
+  static const int fileProtectorDecryptFromFile = 14;
+}
+
+/// Priority of a call on the worker pool, mirrors `AsyncLane` in native_tak.h.
+abstract final class AsyncLane {
+  /// Lane chosen natively from the operation.
+  static const int defaultLane = 0;
+  static const int interactive = 1;
+  static const int normal = 2;
+  static const int background = 3;
+
+  static int of(TakPriority? priority) {
+    switch (priority) {
+      case null:
+        return defaultLane;
+      case TakPriority.interactive:
+        return interactive;
+      case TakPriority.normal:
+        return normal;
+      case TakPriority.background:
+        return background;
+    }
+  }
+}
+
+/// Arguments and results of a call run on the native worker pool.
+///
+/// Every pointer must stay valid until the call completes.
+final class AsyncCall extends Struct {
+  @Int32()
+  external int operation;
+
+  /// One of [AsyncLane].
+  @Int32()
+  external int lane;
+
+  @Int32()
+  external int returnCode;
+
+  /// Socket descriptor or storage handle.
+  @Int32()
+  external int handle;
+
+  /// Read size, capacity of [data], segment count or timeout.
+  @Int32()
+  external int size;
+
+  /// User hash, fqdn, storage key or file name.
+  external Pointer<Utf8> text;
+
+  /// Port or file extension.
+  external Pointer<Utf8> secondText;
+
+  /// Input data, read destination or segment vector.
+  external Pointer<Uint8> data;
+
+  @Uint32()
+  external int dataLength;
+
+  /// Socket descriptor of a connection, or number of bytes read.
+  @Int32()
+  external int result;
+
+  /// Output buffer, owned by the caller once the call completed.
+  external TakByteBuffer buffer;
+
+  /// Returns the output buffer without copying it. The returned list releases the native buffer
+  /// once it is garbage collected, so this method must be called at most once per call.
+  Uint8List takeBuffer() {
+    if (buffer.buffer == nullptr) {
+      return Uint8List(0);
+    }
+    return buffer.buffer.asTypedList(buffer.bufferLength,
+        finalizer: nativeFreeBufferFinalizer, token: buffer.buffer.cast());
+  }
+}
@@ -0,0 +1,32 @@
+import 'dart:ffi';
+
+/// Usage counters of the native pool backing response buffers.
+final class BufferPoolStats extends Struct {
+  /// Maximum number of bytes the pool may reserve.
+  @Uint64()
+  external int capacity;
+
+  /// Number of bytes already carved into pooled blocks.
+  @Uint64()
+  external int reservedBytes;
+
+  /// Number of pooled bytes currently owned by responses.
+  @Uint64()
+  external int bytesInUse;
+
+  /// Number of allocations requested to the pool.
+  @Uint64()
+  external int allocations;
+
+  /// Number of allocations served by the calling thread's cache.
+  @Uint64()
+  external int threadCacheHits;
+
+  /// Number of allocations the pool could not serve.
+  @Uint64()
+  external int misses;
+
+  /// Number of blocks returned to the pool.
+  @Uint64()
+  external int releases;
+}
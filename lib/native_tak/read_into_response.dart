@@ -0,0 +1,12 @@
+import 'dart:ffi';
+
+/// Result of a native read into a buffer provided by the caller.
+final class ReadIntoResponse extends Struct {
+  /// An integer field representing the return code or status of the operation.
+  @Int32()
+  external int returnCode;
+
+  /// Number of bytes written, or the size required when the buffer is too small.
+  @Uint32()
+  external int length;
+}
@@ -0,0 +1,54 @@
+import 'dart:ffi';
+
+/// Counters of the native scheduler of the runtime checks, see [TakPlugin.startRuntimeScheduler].
+///
+/// Runs are observed by sampling the runtime check thread every 100 ms, which bounds the precision
+/// of the jitter. When the thread cannot be observed, see [sampled], the run counters stay at 0.
+final class RuntimeSchedulerStats extends Struct {
+  /// 1 while the runtime check thread is running, 0 while the checks are deferred.
+  @Uint64()
+  external int active;
+
+  /// Number of check runs observed.
+  @Uint64()
+  external int runs;
+
+  /// Number of times the thread was started while busy or over budget, because the last run was
+  /// older than the maximum gap.
+  @Uint64()
+  external int forcedStarts;
+
+  /// Number of intervals that elapsed while the checks were deferred.
+  @Uint64()
+  external int skippedSlots;
+
+  /// CPU time of the last run in microseconds.
+  @Uint64()
+  external int lastRunMicros;
+
+  /// Longest CPU time of a run in microseconds.
+  @Uint64()
+  external int maxRunMicros;
+
+  /// CPU time of every run in microseconds.
+  @Uint64()
+  external int totalRunMicros;
+
+  /// CPU time of the runs in the current budget window in microseconds.
+  @Uint64()
+  external int windowRunMicros;
+
+  /// Distance from the interval between the starts of the last two runs, in microseconds.
+  @Uint64()
+  external int lastJitterMicros;
+
+  /// Largest jitter observed in microseconds.
+  @Uint64()
+  external int maxJitterMicros;
+
+  /// 1 while the runtime check thread is observed, 0 when it could not be identified, typically
+  /// because another thread started at the same time. The checks are then assumed to run every
+  /// interval and the CPU budget is not enforced.
+  @Uint64()
+  external int sampled;
+}
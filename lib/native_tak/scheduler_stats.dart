@@ -0,0 +1,45 @@
+import 'dart:ffi';
+
+/// Counters of the native scheduler running calls in the background.
+final class SchedulerStats extends Struct {
+  /// Number of interactive calls waiting to run.
+  @Uint64()
+  external int interactiveQueued;
+
+  /// Number of normal calls waiting to run.
+  @Uint64()
+  external int normalQueued;
+
+  /// Number of background calls waiting to run.
+  @Uint64()
+  external int backgroundQueued;
+
+  /// Highest number of calls waiting to run at once.
+  @Uint64()
+  external int peakQueued;
+
+  /// Number of calls currently running.
+  @Uint64()
+  external int running;
+
+  /// Number of native threads started.
+  @Uint64()
+  external int threads;
+
+  /// Number of calls started.
+  @Uint64()
+  external int dispatched;
+
+  /// Number of calls started before waiting calls of a higher priority, because they had waited
+  /// too long.
+  @Uint64()
+  external int agedDispatches;
+
+  /// Total time calls waited before starting, in microseconds.
+  @Uint64()
+  external int totalWaitMicros;
+
+  /// Longest time a call waited before starting, in microseconds.
+  @Uint64()
+  external int maxWaitMicros;
+}
@@ -0,0 +1,62 @@
+import 'dart:ffi';
+
+import 'package:ffi/ffi.dart';
+
+/// Steps of the native startup pipeline, mirrors `StartupStep` in native_tak.h.
+abstract final class StartupStep {
+  static const int initialize = 0;
+  static const int register = 1;
+  static const int checkIntegrity = 2;
+  static const int updatePinnedCertificates = 3;
+  static const int warmStorage = 4;
+  static const int preconnect = 5;
+  static const int count = 6;
+}
+
+/// Stages of the native startup pipeline, mirrors `StartupStage` in native_tak.h.
+abstract final class StartupStage {
+  /// Skips a step. Posted once the run no longer uses its plan.
+  static const int none = 0;
+  static const int interactive = 1;
+  static const int deferred = 2;
+}
+
+/// Arguments and results of a run of the native startup pipeline.
+///
+/// Every pointer must stay valid until [StartupStage.none] is posted.
+final class StartupPlan extends Struct {
+  /// One of [StartupStage] for each [StartupStep].
+  @Array(StartupStep.count)
+  external Array<Int32> stages;
+
+  @Array(StartupStep.count)
+  external Array<Int32> returnCodes;
+
+  /// Bit `1 << step` is set for the steps that failed, or were not run because a dependency failed.
+  @Uint32()
+  external int failedSteps;
+
+  external Pointer<Utf8> workingPath;
+
+  external Pointer<Utf8> license;
+
+  external Pointer<Utf8> userHash;
+
+  external Pointer<Pointer<Utf8>> storageNames;
+
+  @Int32()
+  external int storageCount;
+
+  external Pointer<Pointer<Utf8>> hosts;
+
+  external Pointer<Pointer<Utf8>> ports;
+
+  /// Socket descriptor of each connection, -1 if it failed.
+  external Pointer<Int32> sockets;
+
+  @Int32()
+  external int connectionCount;
+
+  @Int32()
+  external int connectTimeout;
+}
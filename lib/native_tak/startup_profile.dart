@@ -0,0 +1,49 @@
+import 'dart:ffi';
+
+/// Timed phases of the startup, mirrors `StartupPhase` in native_tak.h.
+abstract final class StartupPhase {
+  /// [TakPlugin.initialize], or [TakPlugin.start] until its interactive stage.
+  static const int pluginInitialize = 0;
+
+  /// Lookup of the working path through the platform channel.
+  static const int loadEnvironment = 1;
+
+  /// Native initialization, including the wait for the calls in progress.
+  static const int initialize = 2;
+
+  /// Initialization of the T.A.K lib alone, which loads and validates the license.
+  static const int license = 3;
+  static const int register = 4;
+  static const int checkIntegrity = 5;
+  static const int updatePinnedCertificates = 6;
+  static const int count = 7;
+}
+
+/// A run of a startup phase.
+final class StartupPhaseTiming extends Struct {
+  /// Start of the phase on the monotonic clock, in nanoseconds since the native library was loaded.
+  @Int64()
+  external int startNanos;
+
+  @Int64()
+  external int durationNanos;
+
+  /// Return code the phase ended with.
+  @Int32()
+  external int returnCode;
+}
+
+/// Timings of the startup phases, see [TakPlugin.getStartupProfile].
+final class StartupProfile extends Struct {
+  /// First run of each [StartupPhase] in the process, the cold start.
+  @Array(StartupPhase.count)
+  external Array<StartupPhaseTiming> first;
+
+  /// Latest run of each [StartupPhase], a warm start once the library was initialized again.
+  @Array(StartupPhase.count)
+  external Array<StartupPhaseTiming> last;
+
+  /// Runs of each [StartupPhase], [first] and [last] are not set when 0.
+  @Array(StartupPhase.count)
+  external Array<Uint32> counts;
+}
@@ -0,0 +1,32 @@
+import 'dart:ffi';
+
+/// Usage counters of the native cache of secure storage values.
+final class StorageCacheStats extends Struct {
+  /// Maximum number of bytes of values the cache may hold, 0 when it is disabled.
+  @Uint64()
+  external int capacity;
+
+  /// Number of bytes of values held.
+  @Uint64()
+  external int bytesInUse;
+
+  /// Number of values held.
+  @Uint64()
+  external int entries;
+
+  /// Number of reads served from the cache.
+  @Uint64()
+  external int hits;
+
+  /// Number of reads that went to the secure storage.
+  @Uint64()
+  external int misses;
+
+  /// Number of values dropped to stay within the capacity.
+  @Uint64()
+  external int evictions;
+
+  /// Number of values dropped because they were written or deleted.
+  @Uint64()
+  external int invalidations;
+}
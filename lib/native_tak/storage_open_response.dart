@@ -0,0 +1,11 @@
+import 'dart:ffi';
+
+final class StorageOpenResponse extends Struct {
+  /// Handle identifying the storage in subsequent native calls.
+  @Int32()
+  external int handle;
+
+  /// An integer field representing the return code or status of the operation.
+  @Int32()
+  external int returnCode;
+}
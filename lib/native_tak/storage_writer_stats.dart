@@ -0,0 +1,36 @@
+import 'dart:ffi';
+
+/// Usage counters of the native write-behind of secure storage writes.
+final class StorageWriterStats extends Struct {
+  /// Time writes are kept in memory before they are written, 0 when they are written right away.
+  @Uint64()
+  external int windowMillis;
+
+  /// Number of values waiting to be written.
+  @Uint64()
+  external int pending;
+
+  /// Number of bytes of values waiting to be written.
+  @Uint64()
+  external int pendingBytes;
+
+  /// Number of writes kept in memory.
+  @Uint64()
+  external int writes;
+
+  /// Number of writes that replaced a value still waiting to be written.
+  @Uint64()
+  external int coalesced;
+
+  /// Number of times the values waiting were written.
+  @Uint64()
+  external int flushes;
+
+  /// Number of values written to the secure storage.
+  @Uint64()
+  external int flushed;
+
+  /// Number of values that could not be written.
+  @Uint64()
+  external int failures;
+}
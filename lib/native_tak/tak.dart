@@ -3,7 +3,18 @@ import 'dart:io';
 
 import 'package:ffi/ffi.dart';
 
+import 'package:tak/native_tak/asset_cache_stats.dart';
+import 'package:tak/native_tak/async_call.dart';
+import 'package:tak/native_tak/buffer_pool_stats.dart';
 import 'package:tak/native_tak/is_registered_response.dart';
+import 'package:tak/native_tak/read_into_response.dart';
+import 'package:tak/native_tak/runtime_scheduler_stats.dart';
+import 'package:tak/native_tak/scheduler_stats.dart';
+import 'package:tak/native_tak/startup_plan.dart';
+import 'package:tak/native_tak/startup_profile.dart';
+import 'package:tak/native_tak/storage_cache_stats.dart';
+import 'package:tak/native_tak/storage_writer_stats.dart';
+import 'package:tak/native_tak/storage_open_response.dart';
 import 'package:tak/native_tak/tak_bindings_generated.dart';
 import 'package:tak/native_tak/tak_byte_array_response.dart';
 import 'package:tak/native_tak/tak_byte_buffer.dart';
@@ -23,7 +34,7 @@ Pointer<Utf8> nativeGetBuildVersion() => _bindings.native_getBuildVersion();
 
 Pointer<Utf8> nativeGetTakVersion() => _bindings.native_getTakVersion();
 
-void nativeRelease() => _bindings.native_release();
+int nativeRelease() => _bindings.native_release();
 
 bool nativeIsInitialized() => _bindings.native_isInitialized();
 
@@ -65,6 +76,12 @@ int nativeCreateSecureStorage(Pointer<Char> storageName) =>
 int nativeDeleteSecureStorage(Pointer<Char> storageName) =>
     _bindings.native_deleteSecureStorage(storageName);
 
+StorageOpenResponse nativeOpenSecureStorage(Pointer<Char> storageName) =>
+    _bindings.native_storageOpen(storageName);
+
+int nativeDeleteSecureStorageByHandle(int handle) =>
+    _bindings.native_storageDeleteByHandle(handle);
+
 int nativeWriteSecureStorage(Pointer<Char> storageName, Pointer<Char> key,
         Pointer<Char> value, int valueLength) =>
     _bindings.native_writeStorage(storageName, key, value, valueLength);
@@ -73,6 +90,10 @@ TakByteBufferResponse nativeReadSecureStorage(
         Pointer<Char> storageName, Pointer<Char> key) =>
     _bindings.native_storageRead(storageName, key);
 
+ReadIntoResponse nativeReadSecureStorageInto(Pointer<Char> storageName,
+        Pointer<Char> key, Pointer<Uint8> destination, int capacity) =>
+    _bindings.native_storageReadInto(storageName, key, destination, capacity);
+
 int nativeStorageDeleteEntry(Pointer<Char> storageName, Pointer<Char> key) =>
     _bindings.native_storageDeleteEntry(storageName, key);
 
@@ -86,9 +107,25 @@ TakByteBufferResponse nativeTlsReadAll(int socketDescriptor) =>
 TakByteBufferResponse nativeTlsRead(int socketDescriptor, int max) =>
     _bindings.native_tlsRead(socketDescriptor, max);
 
+ReadIntoResponse nativeTlsReadInto(
+        int socketDescriptor, Pointer<Uint8> destination, int capacity) =>
+    _bindings.native_tlsReadInto(socketDescriptor, destination, capacity);
+
 int nativeTlsWrite(int socketDescriptor, Pointer<Char> data) =>
     _bindings.native_tlsWrite(socketDescriptor, data);
 
+int nativeTlsWritev(
+        int socketDescriptor, Pointer<TakByteBuffer> segments, int count) =>
+    _bindings.native_tlsWritev(socketDescriptor, segments, count);
+
+int nativeTlsSetWriteBuffer(int socketDescriptor, int bufferSize,
+        int autoFlushThreshold, bool flushBeforeRead) =>
+    _bindings.native_tlsSetWriteBuffer(
+        socketDescriptor, bufferSize, autoFlushThreshold, flushBeforeRead);
+
+int nativeTlsFlush(int socketDescriptor) =>
+    _bindings.native_tlsFlush(socketDescriptor);
+
 bool nativeTlsIsClosed(int socketDescriptor) =>
     _bindings.native_tlsIsClosed(socketDescriptor);
 
@@ -101,6 +138,214 @@ TakByteBufferResponse nativeGetPinnedCertificates(Pointer<Char> hostName) =>
 int nativeUpdatePinnedCertificates() =>
     _bindings.native_updatePinnedCertificates();
 
+int nativeConfigurePinnedCertificates(int refreshIntervalMillis) =>
+    _bindings.native_configurePinnedCertificates(refreshIntervalMillis);
+
+void nativeFreeBuffer(Pointer<Void> buffer) =>
+    _bindings.native_freeBuffer(buffer);
+
+/// Native finalizer releasing a buffer returned in a [TakByteBufferResponse].
+Pointer<NativeFinalizerFunction> get nativeFreeBufferFinalizer =>
+    _bindings.native_freeBufferPtr.cast();
+
+int nativeConfigureBufferPool(int capacity) =>
+    _bindings.native_configureBufferPool(capacity);
+
+BufferPoolStats nativeGetBufferPoolStats() =>
+    _bindings.native_getBufferPoolStats();
+
+void nativeInitializeAsync(Pointer<Void> postCObject) =>
+    _bindings.native_initializeAsync(postCObject);
+
+int nativeConfigureWorkerPool(int maxThreads) =>
+    _bindings.native_configureWorkerPool(maxThreads);
+
+int nativeSubmitAsync(Pointer<AsyncCall> call, int port) =>
+    _bindings.native_submitAsync(call, port);
+
+SchedulerStats nativeGetSchedulerStats() =>
+    _bindings.native_getSchedulerStats();
+
+int nativeConfigurePostureCache(int check, int ttlMillis) =>
+    _bindings.native_configurePostureCache(check, ttlMillis);
+
+int nativeInvalidatePostureCache(int check) =>
+    _bindings.native_invalidatePostureCache(check);
+
+int nativeGetPostureEvaluatedAt(int check) =>
+    _bindings.native_getPostureEvaluatedAt(check);
+
+int nativeStartRuntimeScheduler(int intervalSeconds, int budgetMicros,
+        int windowMillis, int maxGapMillis) =>
+    _bindings.native_startRuntimeScheduler(
+        intervalSeconds, budgetMicros, windowMillis, maxGapMillis);
+
+int nativeStopRuntimeScheduler() => _bindings.native_stopRuntimeScheduler();
+
+void nativeSetRuntimeBusy(bool busy) => _bindings.native_setRuntimeBusy(busy);
+
+RuntimeSchedulerStats nativeGetRuntimeSchedulerStats() =>
+    _bindings.native_getRuntimeSchedulerStats();
+
+int nativeStartStartup(Pointer<StartupPlan> plan, int port) =>
+    _bindings.native_startStartup(plan, port);
+
+int nativeStartupClockNanos() => _bindings.native_startupClockNanos();
+
+int nativeRecordStartupPhase(int phase, int startNanos, int returnCode) =>
+    _bindings.native_recordStartupPhase(phase, startNanos, returnCode);
+
+StartupProfile nativeGetStartupProfile() =>
+    _bindings.native_getStartupProfile();
+
+int nativeWriteStartupProfile(Pointer<Utf8> path) =>
+    _bindings.native_writeStartupProfile(path);
+
+Pointer<Utf8> nativeGetWorkingPath() => _bindings.native_getWorkingPath();
+
+int nativeAssetPackOpen(Pointer<Char> path, Pointer<Int32> handle) =>
+    _bindings.native_assetPackOpen(path, handle);
+
+int nativeAssetPackClose(int handle) => _bindings.native_assetPackClose(handle);
+
+int nativeAssetPackEntryCount(int handle) =>
+    _bindings.native_assetPackEntryCount(handle);
+
+TakByteBufferResponse nativeAssetPackRead(int handle, Pointer<Char> name) =>
+    _bindings.native_assetPackRead(handle, name);
+
+int nativeConfigureAssetCache(int budgetBytes) =>
+    _bindings.native_configureAssetCache(budgetBytes);
+
+int nativePrefetchAssets(Pointer<Pointer<Char>> fileNames, int count,
+        Pointer<Char> extension) =>
+    _bindings.native_prefetchAssets(fileNames, count, extension);
+
+AssetCacheStats nativeGetAssetCacheStats() =>
+    _bindings.native_getAssetCacheStats();
+
+TakByteBufferResponse nativeFileProtectorDecryptMapped(
+        Pointer<Char> fileName, Pointer<Char> extension) =>
+    _bindings.native_fileProtectorDecryptMapped(fileName, extension);
+
+ReadIntoResponse nativeFileProtectorDecryptMappedInto(Pointer<Char> fileName,
+        Pointer<Char> extension, Pointer<Uint8> destination, int capacity) =>
+    _bindings.native_fileProtectorDecryptMappedInto(
+        fileName, extension, destination, capacity);
+
+int nativeConfigureStorageCache(int budgetBytes, bool mask) =>
+    _bindings.native_configureStorageCache(budgetBytes, mask);
+
+StorageCacheStats nativeGetStorageCacheStats() =>
+    _bindings.native_getStorageCacheStats();
+
+int nativeConfigureStorageWriter(int windowMillis) =>
+    _bindings.native_configureStorageWriter(windowMillis);
+
+int nativeFlushStorageWriter() => _bindings.native_flushStorageWriter();
+
+StorageWriterStats nativeGetStorageWriterStats() =>
+    _bindings.native_getStorageWriterStats();
+
+/// Copies [bytes] to native memory from [allocator].
+///
+/// Calls running T.A.K operations are not leaf calls, so they cannot take Dart memory, which the
+/// garbage collector may move while they run.
+Pointer<Uint8> nativeCopyOf(Allocator allocator, List<int> bytes) {
+  final copy = allocator<Uint8>(bytes.isNotEmpty ? bytes.length : 1);
+  copy.asTypedList(bytes.length).setAll(0, bytes);
+  return copy;
+}
+
+TakByteBufferResponse nativeFileProtectorEncryptData(
+        Pointer<Uint8> data, int length) =>
+    _bindings.native_fileProtectorEncryptData(data, length);
+
+TakByteBufferResponse nativeFileProtectorDecryptData(
+        Pointer<Uint8> data, int length) =>
+    _bindings.native_fileProtectorDecryptData(data, length);
+
+ReadIntoResponse nativeFileProtectorDecryptInto(
+        Pointer<Uint8> data,
+        int length,
+        Pointer<Uint8> destination,
+        int capacity) =>
+    _bindings.native_fileProtectorDecryptInto(
+        data, length, destination, capacity);
+
+int nativeWriteSecureStorageByHandle(
+        int handle,
+        Pointer<Uint8> key,
+        int keyLength,
+        Pointer<Uint8> value,
+        int valueLength) =>
+    _bindings.native_storageWriteByHandle(
+        handle, key, keyLength, value, valueLength);
+
+TakByteBufferResponse nativeReadSecureStorageByHandle(
+        int handle, Pointer<Uint8> key, int keyLength) =>
+    _bindings.native_storageReadByHandle(handle, key, keyLength);
+
+ReadIntoResponse nativeReadSecureStorageIntoByHandle(
+        int handle,
+        Pointer<Uint8> key,
+        int keyLength,
+        Pointer<Uint8> destination,
+        int capacity) =>
+    _bindings.native_storageReadIntoByHandle(
+        handle, key, keyLength, destination, capacity);
+
+int nativeStorageDeleteEntryByHandle(
+        int handle, Pointer<Uint8> key, int keyLength) =>
+    _bindings.native_storageDeleteEntryByHandle(handle, key, keyLength);
+
+TakByteBufferResponse nativeStorageReadBatch(
+        int handle,
+        Pointer<Uint8> keys,
+        Pointer<Int32> keyLengths,
+        int count) =>
+    _bindings.native_storageReadBatch(handle, keys, keyLengths, count);
+
+int nativeStorageWriteBatch(
+        int handle,
+        Pointer<Uint8> keys,
+        Pointer<Int32> keyLengths,
+        Pointer<Uint8> values,
+        Pointer<Int32> valueLengths,
+        int count,
+        Pointer<Int32> results) =>
+    _bindings.native_storageWriteBatch(
+        handle, keys, keyLengths, values, valueLengths, count, results);
+
+int nativeStorageDeleteBatch(
+        int handle,
+        Pointer<Uint8> keys,
+        Pointer<Int32> keyLengths,
+        int count,
+        Pointer<Int32> results) =>
+    _bindings.native_storageDeleteBatch(
+        handle, keys, keyLengths, count, results);
+
+TakByteBufferResponse nativeStorageListKeys(
+        int handle,
+        Pointer<Uint8> start,
+        int startLength,
+        Pointer<Uint8> end,
+        int endLength,
+        int limit) =>
+    _bindings.native_storageListKeys(
+        handle, start, startLength, end, endLength, limit);
+
+TakByteBufferResponse nativeStorageScanPrefix(
+        int handle, Pointer<Uint8> prefix, int prefixLength, int limit) =>
+    _bindings.native_storageScanPrefix(handle, prefix, prefixLength, limit);
+
+bool nativeStorageHasCompleteKeyIndex(int handle) =>
+    _bindings.native_storageHasCompleteKeyIndex(handle);
+
+int nativeStorageContains(int handle, Pointer<Uint8> key, int keyLength) =>
+    _bindings.native_storageContains(handle, key, keyLength);
+
 const String _libName = 'tak_flutter_wrapper';
 
 /// The dynamic library in which the symbols for [TakBindings] can be found.
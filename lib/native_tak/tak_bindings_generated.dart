@@ -9,7 +9,18 @@ import 'dart:ffi' as ffi;
 
 import 'package:ffi/ffi.dart';
 
+import 'package:tak/native_tak/asset_cache_stats.dart';
+import 'package:tak/native_tak/async_call.dart';
+import 'package:tak/native_tak/buffer_pool_stats.dart';
 import 'package:tak/native_tak/is_registered_response.dart';
+import 'package:tak/native_tak/read_into_response.dart';
+import 'package:tak/native_tak/runtime_scheduler_stats.dart';
+import 'package:tak/native_tak/scheduler_stats.dart';
+import 'package:tak/native_tak/startup_plan.dart';
+import 'package:tak/native_tak/startup_profile.dart';
+import 'package:tak/native_tak/storage_cache_stats.dart';
+import 'package:tak/native_tak/storage_writer_stats.dart';
+import 'package:tak/native_tak/storage_open_response.dart';
 import 'package:tak/native_tak/tak_byte_array_response.dart';
 import 'package:tak/native_tak/tak_byte_buffer.dart';
 import 'package:tak/native_tak/tak_id_response.dart';
@@ -51,13 +62,13 @@ class TakBindings {
   late final _native_initialize = _native_initializePtr
       .asFunction<int Function(ffi.Pointer<Utf8>, ffi.Pointer<Utf8>)>();
 
-  void native_release() {
+  int native_release() {
     return _native_release();
   }
 
   late final _native_releasePtr =
-      _lookup<ffi.NativeFunction<ffi.Void Function()>>('native_release');
-  late final _native_release = _native_releasePtr.asFunction<void Function()>();
+      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>('native_release');
+  late final _native_release = _native_releasePtr.asFunction<int Function()>();
 
   int native_reset() {
     return _native_reset();
@@ -238,6 +249,27 @@ class TakBindings {
   late final _native_deleteSecureStorage = _native_deleteSecureStoragePtr
       .asFunction<int Function(ffi.Pointer<ffi.Char>)>();
 
+  StorageOpenResponse native_storageOpen(ffi.Pointer<ffi.Char> storageName) {
+    return _native_storageOpen(storageName);
+  }
+
+  late final _native_storageOpenPtr = _lookup<
+      ffi.NativeFunction<
+          StorageOpenResponse Function(
+              ffi.Pointer<ffi.Char>)>>('native_storageOpen');
+  late final _native_storageOpen = _native_storageOpenPtr
+      .asFunction<StorageOpenResponse Function(ffi.Pointer<ffi.Char>)>();
+
+  int native_storageDeleteByHandle(int handle) {
+    return _native_storageDeleteByHandle(handle);
+  }
+
+  late final _native_storageDeleteByHandlePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int32)>>(
+          'native_storageDeleteByHandle');
+  late final _native_storageDeleteByHandle =
+      _native_storageDeleteByHandlePtr.asFunction<int Function(int)>();
+
   int native_writeStorage(ffi.Pointer<ffi.Char> storageName,
       ffi.Pointer<ffi.Char> key, ffi.Pointer<ffi.Char> value, int valueLength) {
     return _native_writeSecureStorage(storageName, key, value, valueLength);
@@ -265,6 +297,25 @@ class TakBindings {
       TakByteBufferResponse Function(
           ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
 
+  ReadIntoResponse native_storageReadInto(
+      ffi.Pointer<ffi.Char> storageName,
+      ffi.Pointer<ffi.Char> key,
+      ffi.Pointer<ffi.Uint8> destination,
+      int capacity) {
+    return _native_storageReadInto(storageName, key, destination, capacity);
+  }
+
+  late final _native_storageReadIntoPtr = _lookup<
+      ffi.NativeFunction<
+          ReadIntoResponse Function(
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_storageReadInto');
+  late final _native_storageReadInto = _native_storageReadIntoPtr.asFunction<
+      ReadIntoResponse Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Uint8>, int)>();
+
   int native_storageDeleteEntry(
       ffi.Pointer<ffi.Char> storageName, ffi.Pointer<ffi.Char> key) {
     return _native_storageDeleteEntry(storageName, key);
@@ -314,6 +365,18 @@ class TakBindings {
   late final _native_tlsRead =
       _native_tlsReadPtr.asFunction<TakByteBufferResponse Function(int, int)>();
 
+  ReadIntoResponse native_tlsReadInto(
+      int socketDescriptor, ffi.Pointer<ffi.Uint8> destination, int capacity) {
+    return _native_tlsReadInto(socketDescriptor, destination, capacity);
+  }
+
+  late final _native_tlsReadIntoPtr = _lookup<
+      ffi.NativeFunction<
+          ReadIntoResponse Function(ffi.Int32, ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_tlsReadInto');
+  late final _native_tlsReadInto = _native_tlsReadIntoPtr.asFunction<
+      ReadIntoResponse Function(int, ffi.Pointer<ffi.Uint8>, int)>();
+
   int native_tlsWrite(int socketDescriptor, ffi.Pointer<ffi.Char> data) {
     return _native_tlsWrite(socketDescriptor, data);
   }
@@ -325,6 +388,41 @@ class TakBindings {
   late final _native_tlsWrite = _native_tlsWritePtr
       .asFunction<int Function(int, ffi.Pointer<ffi.Char>)>();
 
+  int native_tlsWritev(int socketDescriptor,
+      ffi.Pointer<TakByteBuffer> segments, int count) {
+    return _native_tlsWritev(socketDescriptor, segments, count);
+  }
+
+  late final _native_tlsWritevPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(ffi.Int32, ffi.Pointer<TakByteBuffer>,
+              ffi.Int32)>>('native_tlsWritev');
+  late final _native_tlsWritev = _native_tlsWritevPtr
+      .asFunction<int Function(int, ffi.Pointer<TakByteBuffer>, int)>();
+
+  int native_tlsSetWriteBuffer(int socketDescriptor, int bufferSize,
+      int autoFlushThreshold, bool flushBeforeRead) {
+    return _native_tlsSetWriteBuffer(
+        socketDescriptor, bufferSize, autoFlushThreshold, flushBeforeRead);
+  }
+
+  late final _native_tlsSetWriteBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(ffi.Int32, ffi.Int32, ffi.Int32,
+              ffi.Bool)>>('native_tlsSetWriteBuffer');
+  late final _native_tlsSetWriteBuffer = _native_tlsSetWriteBufferPtr
+      .asFunction<int Function(int, int, int, bool)>();
+
+  int native_tlsFlush(int socketDescriptor) {
+    return _native_tlsFlush(socketDescriptor);
+  }
+
+  late final _native_tlsFlushPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int32)>>(
+          'native_tlsFlush');
+  late final _native_tlsFlush =
+      _native_tlsFlushPtr.asFunction<int Function(int)>();
+
   int native_tlsClose(int socketDescriptor) {
     return _native_tlsClose(socketDescriptor);
   }
@@ -345,6 +443,382 @@ class TakBindings {
   late final _native_tlsIsClosed =
       _native_tlsIsClosedPtr.asFunction<bool Function(int)>();
 
+  void native_freeBuffer(ffi.Pointer<ffi.Void> buffer) {
+    return _native_freeBuffer(buffer);
+  }
+
+  late final native_freeBufferPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'native_freeBuffer');
+  late final _native_freeBuffer = native_freeBufferPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  void native_initializeAsync(ffi.Pointer<ffi.Void> postCObject) {
+    return _native_initializeAsync(postCObject);
+  }
+
+  late final _native_initializeAsyncPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'native_initializeAsync');
+  late final _native_initializeAsync = _native_initializeAsyncPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  int native_configureWorkerPool(int maxThreads) {
+    return _native_configureWorkerPool(maxThreads);
+  }
+
+  late final _native_configureWorkerPoolPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int)>>(
+          'native_configureWorkerPool');
+  late final _native_configureWorkerPool =
+      _native_configureWorkerPoolPtr.asFunction<int Function(int)>();
+
+  int native_submitAsync(ffi.Pointer<AsyncCall> call, int port) {
+    return _native_submitAsync(call, port);
+  }
+
+  late final _native_submitAsyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<AsyncCall>, ffi.Int64)>>('native_submitAsync');
+  late final _native_submitAsync = _native_submitAsyncPtr
+      .asFunction<int Function(ffi.Pointer<AsyncCall>, int)>();
+
+  SchedulerStats native_getSchedulerStats() {
+    return _native_getSchedulerStats();
+  }
+
+  late final _native_getSchedulerStatsPtr =
+      _lookup<ffi.NativeFunction<SchedulerStats Function()>>(
+          'native_getSchedulerStats');
+  late final _native_getSchedulerStats =
+      _native_getSchedulerStatsPtr.asFunction<SchedulerStats Function()>();
+
+  int native_configurePostureCache(int check, int ttlMillis) {
+    return _native_configurePostureCache(check, ttlMillis);
+  }
+
+  late final _native_configurePostureCachePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int, ffi.Int64)>>(
+          'native_configurePostureCache');
+  late final _native_configurePostureCache = _native_configurePostureCachePtr
+      .asFunction<int Function(int, int)>();
+
+  int native_invalidatePostureCache(int check) {
+    return _native_invalidatePostureCache(check);
+  }
+
+  late final _native_invalidatePostureCachePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int)>>(
+          'native_invalidatePostureCache');
+  late final _native_invalidatePostureCache =
+      _native_invalidatePostureCachePtr.asFunction<int Function(int)>();
+
+  int native_getPostureEvaluatedAt(int check) {
+    return _native_getPostureEvaluatedAt(check);
+  }
+
+  late final _native_getPostureEvaluatedAtPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function(ffi.Int)>>(
+          'native_getPostureEvaluatedAt');
+  late final _native_getPostureEvaluatedAt =
+      _native_getPostureEvaluatedAtPtr.asFunction<int Function(int)>();
+
+  int native_startRuntimeScheduler(
+    int intervalSeconds,
+    int budgetMicros,
+    int windowMillis,
+    int maxGapMillis,
+  ) {
+    return _native_startRuntimeScheduler(
+      intervalSeconds,
+      budgetMicros,
+      windowMillis,
+      maxGapMillis,
+    );
+  }
+
+  late final _native_startRuntimeSchedulerPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(ffi.Int, ffi.Int64, ffi.Int64,
+              ffi.Int64)>>('native_startRuntimeScheduler');
+  late final _native_startRuntimeScheduler = _native_startRuntimeSchedulerPtr
+      .asFunction<int Function(int, int, int, int)>();
+
+  int native_stopRuntimeScheduler() {
+    return _native_stopRuntimeScheduler();
+  }
+
+  late final _native_stopRuntimeSchedulerPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
+          'native_stopRuntimeScheduler');
+  late final _native_stopRuntimeScheduler =
+      _native_stopRuntimeSchedulerPtr.asFunction<int Function()>();
+
+  void native_setRuntimeBusy(bool busy) {
+    return _native_setRuntimeBusy(busy);
+  }
+
+  late final _native_setRuntimeBusyPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Bool)>>(
+          'native_setRuntimeBusy');
+  late final _native_setRuntimeBusy =
+      _native_setRuntimeBusyPtr.asFunction<void Function(bool)>();
+
+  RuntimeSchedulerStats native_getRuntimeSchedulerStats() {
+    return _native_getRuntimeSchedulerStats();
+  }
+
+  late final _native_getRuntimeSchedulerStatsPtr =
+      _lookup<ffi.NativeFunction<RuntimeSchedulerStats Function()>>(
+          'native_getRuntimeSchedulerStats');
+  late final _native_getRuntimeSchedulerStats =
+      _native_getRuntimeSchedulerStatsPtr
+          .asFunction<RuntimeSchedulerStats Function()>();
+
+  int native_startStartup(ffi.Pointer<StartupPlan> plan, int port) {
+    return _native_startStartup(plan, port);
+  }
+
+  late final _native_startStartupPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Pointer<StartupPlan>, ffi.Int64)>>('native_startStartup');
+  late final _native_startStartup = _native_startStartupPtr
+      .asFunction<int Function(ffi.Pointer<StartupPlan>, int)>();
+
+  int native_startupClockNanos() {
+    return _native_startupClockNanos();
+  }
+
+  late final _native_startupClockNanosPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function()>>(
+          'native_startupClockNanos');
+  late final _native_startupClockNanos =
+      _native_startupClockNanosPtr.asFunction<int Function()>();
+
+  int native_recordStartupPhase(int phase, int startNanos, int returnCode) {
+    return _native_recordStartupPhase(phase, startNanos, returnCode);
+  }
+
+  late final _native_recordStartupPhasePtr = _lookup<
+          ffi.NativeFunction<ffi.Int32 Function(ffi.Int, ffi.Int64, ffi.Int32)>>(
+      'native_recordStartupPhase');
+  late final _native_recordStartupPhase = _native_recordStartupPhasePtr
+      .asFunction<int Function(int, int, int)>();
+
+  StartupProfile native_getStartupProfile() {
+    return _native_getStartupProfile();
+  }
+
+  late final _native_getStartupProfilePtr =
+      _lookup<ffi.NativeFunction<StartupProfile Function()>>(
+          'native_getStartupProfile');
+  late final _native_getStartupProfile =
+      _native_getStartupProfilePtr.asFunction<StartupProfile Function()>();
+
+  int native_writeStartupProfile(ffi.Pointer<Utf8> path) {
+    return _native_writeStartupProfile(path);
+  }
+
+  late final _native_writeStartupProfilePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Pointer<Utf8>)>>(
+          'native_writeStartupProfile');
+  late final _native_writeStartupProfile = _native_writeStartupProfilePtr
+      .asFunction<int Function(ffi.Pointer<Utf8>)>();
+
+  ffi.Pointer<Utf8> native_getWorkingPath() {
+    return _native_getWorkingPath();
+  }
+
+  late final _native_getWorkingPathPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<Utf8> Function()>>(
+          'native_getWorkingPath');
+  late final _native_getWorkingPath =
+      _native_getWorkingPathPtr.asFunction<ffi.Pointer<Utf8> Function()>();
+
+  int native_assetPackOpen(
+      ffi.Pointer<ffi.Char> path, ffi.Pointer<ffi.Int32> handle) {
+    return _native_assetPackOpen(path, handle);
+  }
+
+  late final _native_assetPackOpenPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Int32>)>>('native_assetPackOpen');
+  late final _native_assetPackOpen = _native_assetPackOpenPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Int32>)>();
+
+  int native_assetPackClose(int handle) {
+    return _native_assetPackClose(handle);
+  }
+
+  late final _native_assetPackClosePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int32)>>(
+          'native_assetPackClose');
+  late final _native_assetPackClose =
+      _native_assetPackClosePtr.asFunction<int Function(int)>();
+
+  int native_assetPackEntryCount(int handle) {
+    return _native_assetPackEntryCount(handle);
+  }
+
+  late final _native_assetPackEntryCountPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int32)>>(
+          'native_assetPackEntryCount');
+  late final _native_assetPackEntryCount =
+      _native_assetPackEntryCountPtr.asFunction<int Function(int)>();
+
+  TakByteBufferResponse native_assetPackRead(
+      int handle, ffi.Pointer<ffi.Char> name) {
+    return _native_assetPackRead(handle, name);
+  }
+
+  late final _native_assetPackReadPtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(
+              ffi.Int32, ffi.Pointer<ffi.Char>)>>('native_assetPackRead');
+  late final _native_assetPackRead = _native_assetPackReadPtr.asFunction<
+      TakByteBufferResponse Function(int, ffi.Pointer<ffi.Char>)>();
+
+  int native_configureAssetCache(int budgetBytes) {
+    return _native_configureAssetCache(budgetBytes);
+  }
+
+  late final _native_configureAssetCachePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int64)>>(
+          'native_configureAssetCache');
+  late final _native_configureAssetCache =
+      _native_configureAssetCachePtr.asFunction<int Function(int)>();
+
+  int native_prefetchAssets(ffi.Pointer<ffi.Pointer<ffi.Char>> fileNames,
+      int count, ffi.Pointer<ffi.Char> extension) {
+    return _native_prefetchAssets(fileNames, count, extension);
+  }
+
+  late final _native_prefetchAssetsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(ffi.Pointer<ffi.Pointer<ffi.Char>>, ffi.Int,
+              ffi.Pointer<ffi.Char>)>>('native_prefetchAssets');
+  late final _native_prefetchAssets = _native_prefetchAssetsPtr.asFunction<
+      int Function(
+          ffi.Pointer<ffi.Pointer<ffi.Char>>, int, ffi.Pointer<ffi.Char>)>();
+
+  AssetCacheStats native_getAssetCacheStats() {
+    return _native_getAssetCacheStats();
+  }
+
+  late final _native_getAssetCacheStatsPtr =
+      _lookup<ffi.NativeFunction<AssetCacheStats Function()>>(
+          'native_getAssetCacheStats');
+  late final _native_getAssetCacheStats =
+      _native_getAssetCacheStatsPtr.asFunction<AssetCacheStats Function()>();
+
+  TakByteBufferResponse native_fileProtectorDecryptMapped(
+      ffi.Pointer<ffi.Char> fileName, ffi.Pointer<ffi.Char> extension) {
+    return _native_fileProtectorDecryptMapped(fileName, extension);
+  }
+
+  late final _native_fileProtectorDecryptMappedPtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Char>)>>('native_fileProtectorDecryptMapped');
+  late final _native_fileProtectorDecryptMapped =
+      _native_fileProtectorDecryptMappedPtr.asFunction<
+          TakByteBufferResponse Function(
+              ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
+
+  ReadIntoResponse native_fileProtectorDecryptMappedInto(
+      ffi.Pointer<ffi.Char> fileName,
+      ffi.Pointer<ffi.Char> extension,
+      ffi.Pointer<ffi.Uint8> destination,
+      int capacity) {
+    return _native_fileProtectorDecryptMappedInto(
+        fileName, extension, destination, capacity);
+  }
+
+  late final _native_fileProtectorDecryptMappedIntoPtr = _lookup<
+      ffi.NativeFunction<
+          ReadIntoResponse Function(
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_fileProtectorDecryptMappedInto');
+  late final _native_fileProtectorDecryptMappedInto =
+      _native_fileProtectorDecryptMappedIntoPtr.asFunction<
+          ReadIntoResponse Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Uint8>, int)>();
+
+  int native_configureStorageCache(int budgetBytes, bool mask) {
+    return _native_configureStorageCache(budgetBytes, mask);
+  }
+
+  late final _native_configureStorageCachePtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int64, ffi.Bool)>>(
+          'native_configureStorageCache');
+  late final _native_configureStorageCache = _native_configureStorageCachePtr
+      .asFunction<int Function(int, bool)>();
+
+  StorageCacheStats native_getStorageCacheStats() {
+    return _native_getStorageCacheStats();
+  }
+
+  late final _native_getStorageCacheStatsPtr =
+      _lookup<ffi.NativeFunction<StorageCacheStats Function()>>(
+          'native_getStorageCacheStats');
+  late final _native_getStorageCacheStats = _native_getStorageCacheStatsPtr
+      .asFunction<StorageCacheStats Function()>();
+
+  int native_configureStorageWriter(int windowMillis) {
+    return _native_configureStorageWriter(windowMillis);
+  }
+
+  late final _native_configureStorageWriterPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int64)>>(
+          'native_configureStorageWriter');
+  late final _native_configureStorageWriter =
+      _native_configureStorageWriterPtr.asFunction<int Function(int)>();
+
+  int native_flushStorageWriter() {
+    return _native_flushStorageWriter();
+  }
+
+  late final _native_flushStorageWriterPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function()>>(
+          'native_flushStorageWriter');
+  late final _native_flushStorageWriter =
+      _native_flushStorageWriterPtr.asFunction<int Function()>();
+
+  StorageWriterStats native_getStorageWriterStats() {
+    return _native_getStorageWriterStats();
+  }
+
+  late final _native_getStorageWriterStatsPtr =
+      _lookup<ffi.NativeFunction<StorageWriterStats Function()>>(
+          'native_getStorageWriterStats');
+  late final _native_getStorageWriterStats = _native_getStorageWriterStatsPtr
+      .asFunction<StorageWriterStats Function()>();
+
+  int native_configureBufferPool(int capacity) {
+    return _native_configureBufferPool(capacity);
+  }
+
+  late final _native_configureBufferPoolPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int64)>>(
+          'native_configureBufferPool');
+  late final _native_configureBufferPool =
+      _native_configureBufferPoolPtr.asFunction<int Function(int)>();
+
+  BufferPoolStats native_getBufferPoolStats() {
+    return _native_getBufferPoolStats();
+  }
+
+  late final _native_getBufferPoolStatsPtr =
+      _lookup<ffi.NativeFunction<BufferPoolStats Function()>>(
+          'native_getBufferPoolStats');
+  late final _native_getBufferPoolStats =
+      _native_getBufferPoolStatsPtr.asFunction<BufferPoolStats Function()>();
+
   TakByteBufferResponse native_getPinnedCertificates(
       ffi.Pointer<ffi.Char> hostName) {
     return _native_getPinnedCertificate(hostName);
@@ -366,4 +840,287 @@ class TakBindings {
           'native_updatePinnedCertificates');
   late final _native_updatePinnedCertificates =
       _native_updatePinnedCertificatesPtr.asFunction<int Function()>();
+
+  int native_configurePinnedCertificates(int refreshIntervalMillis) {
+    return _native_configurePinnedCertificates(refreshIntervalMillis);
+  }
+
+  late final _native_configurePinnedCertificatesPtr =
+      _lookup<ffi.NativeFunction<ffi.Int32 Function(ffi.Int64)>>(
+          'native_configurePinnedCertificates');
+  late final _native_configurePinnedCertificates =
+      _native_configurePinnedCertificatesPtr.asFunction<int Function(int)>();
+
+  TakByteBufferResponse native_fileProtectorEncryptData(
+      ffi.Pointer<ffi.Uint8> data, int length) {
+    return _native_fileProtectorEncryptData(data, length);
+  }
+
+  late final _native_fileProtectorEncryptDataPtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_fileProtectorEncryptData');
+  late final _native_fileProtectorEncryptData =
+      _native_fileProtectorEncryptDataPtr.asFunction<
+          TakByteBufferResponse Function(ffi.Pointer<ffi.Uint8>, int)>();
+
+  TakByteBufferResponse native_fileProtectorDecryptData(
+      ffi.Pointer<ffi.Uint8> data, int length) {
+    return _native_fileProtectorDecryptData(data, length);
+  }
+
+  late final _native_fileProtectorDecryptDataPtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_fileProtectorDecryptData');
+  late final _native_fileProtectorDecryptData =
+      _native_fileProtectorDecryptDataPtr.asFunction<
+          TakByteBufferResponse Function(ffi.Pointer<ffi.Uint8>, int)>();
+
+  ReadIntoResponse native_fileProtectorDecryptInto(
+      ffi.Pointer<ffi.Uint8> data,
+      int length,
+      ffi.Pointer<ffi.Uint8> destination,
+      int capacity) {
+    return _native_fileProtectorDecryptInto(
+        data, length, destination, capacity);
+  }
+
+  late final _native_fileProtectorDecryptIntoPtr = _lookup<
+      ffi.NativeFunction<
+          ReadIntoResponse Function(
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_fileProtectorDecryptInto');
+  late final _native_fileProtectorDecryptInto =
+      _native_fileProtectorDecryptIntoPtr.asFunction<
+          ReadIntoResponse Function(
+              ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<ffi.Uint8>, int)>();
+
+  int native_storageWriteByHandle(
+      int handle,
+      ffi.Pointer<ffi.Uint8> key,
+      int keyLength,
+      ffi.Pointer<ffi.Uint8> value,
+      int valueLength) {
+    return _native_storageWriteByHandle(
+        handle, key, keyLength, value, valueLength);
+  }
+
+  late final _native_storageWriteByHandlePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_storageWriteByHandle');
+  late final _native_storageWriteByHandle =
+      _native_storageWriteByHandlePtr.asFunction<
+          int Function(
+              int, ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<ffi.Uint8>, int)>();
+
+  TakByteBufferResponse native_storageReadByHandle(
+      int handle, ffi.Pointer<ffi.Uint8> key, int keyLength) {
+    return _native_storageReadByHandle(handle, key, keyLength);
+  }
+
+  late final _native_storageReadByHandlePtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_storageReadByHandle');
+  late final _native_storageReadByHandle =
+      _native_storageReadByHandlePtr.asFunction<
+          TakByteBufferResponse Function(int, ffi.Pointer<ffi.Uint8>, int)>();
+
+  ReadIntoResponse native_storageReadIntoByHandle(
+      int handle,
+      ffi.Pointer<ffi.Uint8> key,
+      int keyLength,
+      ffi.Pointer<ffi.Uint8> destination,
+      int capacity) {
+    return _native_storageReadIntoByHandle(
+        handle, key, keyLength, destination, capacity);
+  }
+
+  late final _native_storageReadIntoByHandlePtr = _lookup<
+      ffi.NativeFunction<
+          ReadIntoResponse Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_storageReadIntoByHandle');
+  late final _native_storageReadIntoByHandle =
+      _native_storageReadIntoByHandlePtr.asFunction<
+          ReadIntoResponse Function(
+              int, ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<ffi.Uint8>, int)>();
+
+  int native_storageDeleteEntryByHandle(
+      int handle, ffi.Pointer<ffi.Uint8> key, int keyLength) {
+    return _native_storageDeleteEntryByHandle(handle, key, keyLength);
+  }
+
+  late final _native_storageDeleteEntryByHandlePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_storageDeleteEntryByHandle');
+  late final _native_storageDeleteEntryByHandle =
+      _native_storageDeleteEntryByHandlePtr.asFunction<
+          int Function(int, ffi.Pointer<ffi.Uint8>, int)>();
+
+  TakByteBufferResponse native_storageReadBatch(
+      int handle,
+      ffi.Pointer<ffi.Uint8> keys,
+      ffi.Pointer<ffi.Int32> keyLengths,
+      int count) {
+    return _native_storageReadBatch(handle, keys, keyLengths, count);
+  }
+
+  late final _native_storageReadBatchPtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Int32>,
+              ffi.Int32)>>('native_storageReadBatch');
+  late final _native_storageReadBatch = _native_storageReadBatchPtr.asFunction<
+      TakByteBufferResponse Function(
+          int, ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Int32>, int)>();
+
+  int native_storageWriteBatch(
+      int handle,
+      ffi.Pointer<ffi.Uint8> keys,
+      ffi.Pointer<ffi.Int32> keyLengths,
+      ffi.Pointer<ffi.Uint8> values,
+      ffi.Pointer<ffi.Int32> valueLengths,
+      int count,
+      ffi.Pointer<ffi.Int32> results) {
+    return _native_storageWriteBatch(
+        handle, keys, keyLengths, values, valueLengths, count, results);
+  }
+
+  late final _native_storageWriteBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Int32>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Int32>,
+              ffi.Int32,
+              ffi.Pointer<ffi.Int32>)>>('native_storageWriteBatch');
+  late final _native_storageWriteBatch =
+      _native_storageWriteBatchPtr.asFunction<
+          int Function(
+              int,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Int32>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Int32>,
+              int,
+              ffi.Pointer<ffi.Int32>)>();
+
+  int native_storageDeleteBatch(
+      int handle,
+      ffi.Pointer<ffi.Uint8> keys,
+      ffi.Pointer<ffi.Int32> keyLengths,
+      int count,
+      ffi.Pointer<ffi.Int32> results) {
+    return _native_storageDeleteBatch(handle, keys, keyLengths, count, results);
+  }
+
+  late final _native_storageDeleteBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Int32>,
+              ffi.Int32,
+              ffi.Pointer<ffi.Int32>)>>('native_storageDeleteBatch');
+  late final _native_storageDeleteBatch =
+      _native_storageDeleteBatchPtr.asFunction<
+          int Function(
+              int,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Int32>,
+              int,
+              ffi.Pointer<ffi.Int32>)>();
+
+  TakByteBufferResponse native_storageListKeys(
+      int handle,
+      ffi.Pointer<ffi.Uint8> start,
+      int startLength,
+      ffi.Pointer<ffi.Uint8> end,
+      int endLength,
+      int limit) {
+    return _native_storageListKeys(
+        handle, start, startLength, end, endLength, limit);
+  }
+
+  late final _native_storageListKeysPtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32,
+              ffi.Int32)>>('native_storageListKeys');
+  late final _native_storageListKeys = _native_storageListKeysPtr.asFunction<
+      TakByteBufferResponse Function(
+          int,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          int)>();
+
+  TakByteBufferResponse native_storageScanPrefix(
+      int handle, ffi.Pointer<ffi.Uint8> prefix, int prefixLength, int limit) {
+    return _native_storageScanPrefix(handle, prefix, prefixLength, limit);
+  }
+
+  late final _native_storageScanPrefixPtr = _lookup<
+      ffi.NativeFunction<
+          TakByteBufferResponse Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32,
+              ffi.Int32)>>('native_storageScanPrefix');
+  late final _native_storageScanPrefix =
+      _native_storageScanPrefixPtr.asFunction<
+          TakByteBufferResponse Function(
+              int, ffi.Pointer<ffi.Uint8>, int, int)>();
+
+  bool native_storageHasCompleteKeyIndex(int handle) {
+    return _native_storageHasCompleteKeyIndex(handle);
+  }
+
+  late final _native_storageHasCompleteKeyIndexPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(ffi.Int32)>>('native_storageHasCompleteKeyIndex');
+  late final _native_storageHasCompleteKeyIndex =
+      _native_storageHasCompleteKeyIndexPtr.asFunction<bool Function(int)>();
+
+  int native_storageContains(
+      int handle, ffi.Pointer<ffi.Uint8> key, int keyLength) {
+    return _native_storageContains(handle, key, keyLength);
+  }
+
+  late final _native_storageContainsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int32 Function(
+              ffi.Int32,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int32)>>('native_storageContains');
+  late final _native_storageContains = _native_storageContainsPtr.asFunction<
+      int Function(int, ffi.Pointer<ffi.Uint8>, int)>();
 }
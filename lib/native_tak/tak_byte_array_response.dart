@@ -1,6 +1,7 @@
 import 'dart:ffi';
 import 'dart:typed_data';
 
+import 'package:tak/native_tak/tak.dart';
 import 'package:tak/native_tak/tak_byte_buffer.dart';
 
 // final class named TakByteBufferResponse, which extends Struct
@@ -13,9 +14,17 @@ final class TakByteBufferResponse extends Struct {
   // Defining a pointer field named buffer to hold a pointer and length to unsigned 8-bit integers (Uint8)
   external TakByteBuffer takByteBuffer;
 
-  // A method named getValue() which returns a Uint8List from the buffer
+  // A method named getValue() which returns a Uint8List from the buffer.
+  // The native buffer is not copied: the returned list takes its ownership and
+  // releases it through native_freeBuffer once it is garbage collected, so this
+  // method must be called at most once per response.
   Uint8List getValue() {
+    if (takByteBuffer.buffer == nullptr) {
+      return Uint8List(0);
+    }
     // Converting the buffer pointer to a Uint8List of given length
-    return takByteBuffer.buffer.asTypedList(takByteBuffer.bufferLength);
+    return takByteBuffer.buffer.asTypedList(takByteBuffer.bufferLength,
+        finalizer: nativeFreeBufferFinalizer,
+        token: takByteBuffer.buffer.cast());
   }
 }
@@ -0,0 +1,71 @@
+import 'dart:async';
+import 'dart:ffi';
+import 'dart:isolate';
+
+import 'package:ffi/ffi.dart';
+import 'package:tak/native_tak/async_call.dart';
+import 'package:tak/native_tak/tak.dart';
+import 'package:tak/tak_return_codes.dart';
+
+/// Runs blocking native calls on the native worker pool.
+///
+/// The calling isolate is never blocked: the call runs on a native thread, which posts the
+/// address of the [AsyncCall] back to this isolate once done.
+class TakExecutor {
+  /// The executor of the current isolate.
+  static final TakExecutor instance = TakExecutor._();
+
+  late final RawReceivePort _port;
+  final Map<int, Completer<void>> _pending = {};
+
+  TakExecutor._() {
+    nativeInitializeAsync(NativeApi.postCObject.cast());
+    _port = RawReceivePort(_complete, 'TakExecutor');
+    _port.keepIsolateAlive = false;
+  }
+
+  /// Runs [call] on a native worker thread.
+  ///
+  /// [call] and all the memory it points to must stay allocated until the returned future
+  /// completes.
+  ///
+  /// Throws:
+  ///   - [TakException] with the relevant [TakReturnCode] if the call could not be queued.
+  Future<void> run(Pointer<AsyncCall> call) {
+    final completer = Completer<void>();
+    _pending[call.address] = completer;
+    _port.keepIsolateAlive = true;
+
+    int response = nativeSubmitAsync(call, _port.sendPort.nativePort);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      _pending.remove(call.address);
+      _port.keepIsolateAlive = _pending.isNotEmpty;
+      return Future.error(TakException(mapResponse));
+    }
+    return completer.future;
+  }
+
+  /// Runs the native [operation] and returns what [onComplete] makes of its results.
+  ///
+  /// [setUp] fills in the arguments of the call. Memory allocated from its arena is released
+  /// once [onComplete] returned. [lane] is one of [AsyncLane].
+  Future<T> call<T>(int operation, T Function(AsyncCall call) onComplete,
+      [void Function(Arena arena, AsyncCall call)? setUp,
+      int lane = AsyncLane.defaultLane]) {
+    return using((Arena arena) async {
+      final call = arena<AsyncCall>();
+      call.ref
+        ..operation = operation
+        ..lane = lane;
+      setUp?.call(arena, call.ref);
+      await run(call);
+      return onComplete(call.ref);
+    });
+  }
+
+  void _complete(dynamic message) {
+    _pending.remove(message as int)?.complete();
+    _port.keepIsolateAlive = _pending.isNotEmpty;
+  }
+}
@@ -0,0 +1,14 @@
+/// Security checks whose results are cached natively, see [TakPlugin.configurePostureCache].
+enum PostureCheck {
+  /// [TakPlugin.isRooted].
+  rootStatus,
+
+  /// [TakPlugin.getAdvancedRootStatus].
+  advancedRootStatus,
+
+  /// [TakPlugin.checkIntegrity].
+  integrity,
+
+  /// [TakPlugin.isRegistered].
+  registration,
+}
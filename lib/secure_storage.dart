@@ -3,9 +3,13 @@ import 'dart:ffi';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
+import 'package:tak/native_tak/async_call.dart';
+import 'package:tak/native_tak/read_into_response.dart';
 import 'package:tak/native_tak/tak.dart';
 import 'package:tak/native_tak/tak_byte_array_response.dart';
+import 'package:tak/native_tak/tak_executor.dart';
 import 'package:tak/tak_plugin.dart';
+import 'package:tak/tak_priority.dart';
 import 'package:tak/tak_return_codes.dart';
 
 // Use this class to interact with T.A.K's Secure Storage.
@@ -14,6 +18,9 @@ class SecureStorage {
   final TakPlugin takPlugin;
   final String storageName;
 
+  // Native handle of this storage, resolved once when it is created.
+  late final int _handle;
+
   // Creates a new instance of the `SecureStorage` class
   SecureStorage(this.storageName, this.takPlugin) {
     _create();
@@ -29,13 +36,16 @@ class SecureStorage {
     if (storageName.isEmpty) {
       throw TakException(TakReturnCode.invalidParameter);
     }
-    final response =
-        nativeCreateSecureStorage(storageName.toNativeUtf8().cast<Char>());
-    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    final nativeStorageName = storageName.toNativeUtf8();
+    final response = nativeOpenSecureStorage(nativeStorageName.cast<Char>());
+    malloc.free(nativeStorageName);
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnCode);
     if (mapResponse != TakReturnCode.success &&
         mapResponse != TakReturnCode.storageAlreadyExists) {
       throw TakException(mapResponse);
     }
+    _handle = response.handle;
   }
 
   // Deletes this Secure Storage.
@@ -52,8 +62,7 @@ class SecureStorage {
     if (storageName.isEmpty) {
       throw TakException(TakReturnCode.invalidParameter);
     }
-    final response =
-        nativeDeleteSecureStorage(storageName.toNativeUtf8().cast<Char>());
+    final response = nativeDeleteSecureStorageByHandle(_handle);
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
     if (mapResponse != TakReturnCode.success) {
       throw TakException(mapResponse);
@@ -63,6 +72,7 @@ class SecureStorage {
   // Writes a key-value pair to the Secure Storage.
   //
   // If the key already exists, the value will be overwritten.
+  // The value is written on the calling isolate, before the returned future is created.
   //
   // Throws TakException
   //   - [TakReturnCode.apiNotInitialized]          when library is not initialized.
@@ -74,32 +84,148 @@ class SecureStorage {
     if (storageName.isEmpty || key.isEmpty) {
       throw TakException(TakReturnCode.invalidParameter);
     }
-    Uint8List byteArray;
-    if (value is int) {
-      byteArray = _intToUint8List(value);
-    } else if (value is String) {
-      byteArray = Uint8List.fromList(utf8.encode(value));
-    } else if (value is bool) {
-      byteArray = Uint8List(1)..[0] = value ? 1 : 0;
-    } else if (value is Uint8List) {
-      byteArray = value;
-    } else {
+    Uint8List byteArray = _toUint8List(value);
+    final keyBytes = utf8.encode(key);
+    final response = using((Arena arena) => nativeWriteSecureStorageByHandle(
+        _handle,
+        nativeCopyOf(arena, keyBytes),
+        keyBytes.length,
+        nativeCopyOf(arena, byteArray),
+        byteArray.length));
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  // Writes a key-value pair to the Secure Storage without blocking the calling isolate.
+  //
+  // Works as [write], but the value is copied and written on a native worker thread with the given
+  // [priority], normal by default. Reads and deletes of the key made before the returned future
+  // completes may run before the write.
+  Future<void> writeAsync(String key, dynamic value,
+      {TakPriority? priority}) async {
+    if (storageName.isEmpty || key.isEmpty) {
       throw TakException(TakReturnCode.invalidParameter);
     }
-    final Pointer<Uint8> frameData = calloc.allocate<Uint8>(byteArray.length);
-    final pointerList = frameData.asTypedList(byteArray.length);
-    pointerList.setAll(0, byteArray);
-    final response = nativeWriteSecureStorage(
-        storageName.toNativeUtf8().cast<Char>(),
-        key.toNativeUtf8().cast<Char>(),
-        frameData.cast(),
-        byteArray.length);
+    Uint8List byteArray = _toUint8List(value);
+    // The write runs on a worker thread, on copies of the key and value
+    final response = await TakExecutor.instance.call(
+        AsyncOperation.storageWrite, (call) => call.returnCode, (arena, call) {
+      call
+        ..handle = _handle
+        ..text = key.toNativeUtf8(allocator: arena)
+        ..data = nativeCopyOf(arena, byteArray)
+        ..dataLength = byteArray.length;
+    }, AsyncLane.of(priority));
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
     if (mapResponse != TakReturnCode.success) {
       throw TakException(mapResponse);
     }
   }
 
+  // Writes several key-value pairs to the Secure Storage in one native call.
+  //
+  // Values are converted as in [write], and written on the calling isolate in the order of
+  // [entries]. Every entry is written even when some of them fail.
+  //
+  // Throws TakException with the error of the first entry that failed
+  //   - [TakReturnCode.apiNotInitialized]          when library is not initialized.
+  //   - [TakReturnCode.invalidParameter]       when a key or a value is invalid.
+  //   - [TakReturnCode.storageDeviceMismatch] when app is found to be running on a different device. In that case, storage is deleted for security reasons.
+  //   - [TakReturnCode.generalError]            when an unexpected error happens.
+  void writeMany(Map<String, dynamic> entries) {
+    if (storageName.isEmpty) {
+      throw TakException(TakReturnCode.invalidParameter);
+    }
+    final keys = <Uint8List>[];
+    final values = <Uint8List>[];
+    entries.forEach((key, value) {
+      if (key.isEmpty) {
+        throw TakException(TakReturnCode.invalidParameter);
+      }
+      keys.add(utf8.encode(key));
+      values.add(_toUint8List(value));
+    });
+    using((Arena arena) {
+      final results = arena<Int32>(keys.isNotEmpty ? keys.length : 1);
+      int response = nativeStorageWriteBatch(
+          _handle,
+          _pack(arena, keys),
+          _packLengths(arena, keys),
+          _pack(arena, values),
+          _packLengths(arena, values),
+          keys.length,
+          results);
+      _throwFirstError(response, results.asTypedList(keys.length));
+    });
+  }
+
+  // Reads several values from the Secure Storage in one native call.
+  //
+  // Returns the values of the keys that exist, keys that are not found are left out.
+  //
+  // Throws TakException with the error of the first key that failed otherwise
+  //   - [TakReturnCode.apiNotInitialized]          when library is not initialized.
+  //   - [TakReturnCode.invalidParameter]       when a key is invalid.
+  //   - [TakReturnCode.storageDeviceMismatch] when app is found to be running on a different device. In that case, storage is deleted for security reasons.
+  //   - [TakReturnCode.generalError]            when an unexpected error happens.
+  Map<String, Uint8List> readMany(List<String> keys) {
+    if (storageName.isEmpty) {
+      throw TakException(TakReturnCode.invalidParameter);
+    }
+    final keyBytes = keys.map(utf8.encode).toList();
+    TakByteBufferResponse response = using((Arena arena) =>
+        nativeStorageReadBatch(_handle, _pack(arena, keyBytes),
+            _packLengths(arena, keyBytes), keys.length));
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnValue);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+
+    // Each value is a view of the packed buffer, which is released once none of them is used
+    final packed = response.getValue();
+    final header = ByteData.sublistView(packed);
+    final values = <String, Uint8List>{};
+    int offset = 0;
+    for (final key in keys) {
+      final returnCode = header.getInt32(offset, Endian.host);
+      final length = header.getUint32(offset + 4, Endian.host);
+      offset += 8;
+      mapResponse = TakReturnCodeMapper.mapErrorCode(returnCode);
+      if (mapResponse == TakReturnCode.success) {
+        values[key] = Uint8List.sublistView(packed, offset, offset + length);
+      } else if (mapResponse != TakReturnCode.storageKeyNotFound) {
+        throw TakException(mapResponse);
+      }
+      offset += length;
+    }
+    return values;
+  }
+
+  // Deletes several key-value pairs from the Secure Storage in one native call.
+  //
+  // Every key is deleted even when some of them fail.
+  //
+  // Throws TakException with the error of the first key that failed
+  //   - [TakReturnCode.apiNotInitialized]          when library is not initialized.
+  //   - [TakReturnCode.storageKeyNotFound]    when a key does not exist.
+  //   - [TakReturnCode.storageDeviceMismatch] when app is found to be running on a different device. In that case, storage is deleted for security reasons.
+  //   - [TakReturnCode.generalError]            when an unexpected error happens.
+  void deleteMany(List<String> keys) {
+    if (storageName.isEmpty) {
+      throw TakException(TakReturnCode.invalidParameter);
+    }
+    final keyBytes = keys.map(utf8.encode).toList();
+    using((Arena arena) {
+      final results = arena<Int32>(keys.isNotEmpty ? keys.length : 1);
+      int response = nativeStorageDeleteBatch(_handle, _pack(arena, keyBytes),
+          _packLengths(arena, keyBytes), keys.length, results);
+      _throwFirstError(response, results.asTypedList(keys.length));
+    });
+  }
+
   // Reads a value from the Secure Storage.
   //
   // Parameters:
@@ -115,9 +241,10 @@ class SecureStorage {
     if (storageName.isEmpty) {
       throw TakException(TakReturnCode.invalidParameter);
     }
-    TakByteBufferResponse response = nativeReadSecureStorage(
-        storageName.toNativeUtf8().cast<Char>(),
-        key.toNativeUtf8().cast<Char>());
+    final keyBytes = utf8.encode(key);
+    TakByteBufferResponse response = using((Arena arena) =>
+        nativeReadSecureStorageByHandle(
+            _handle, nativeCopyOf(arena, keyBytes), keyBytes.length));
     TakReturnCode mapResponse =
         TakReturnCodeMapper.mapErrorCode(response.returnValue);
     if (mapResponse != TakReturnCode.success) {
@@ -128,6 +255,67 @@ class SecureStorage {
     return byteArray;
   }
 
+  // Reads a value from the Secure Storage without blocking the calling isolate.
+  //
+  // Works as [read], but the value is read on a native worker thread with the given [priority],
+  // interactive by default.
+  Future<Uint8List> readAsync(String key, {TakPriority? priority}) {
+    if (storageName.isEmpty) {
+      throw TakException(TakReturnCode.invalidParameter);
+    }
+    return TakExecutor.instance.call(AsyncOperation.storageRead, (call) {
+      TakReturnCode mapResponse =
+          TakReturnCodeMapper.mapErrorCode(call.returnCode);
+      if (mapResponse != TakReturnCode.success) {
+        throw TakException(mapResponse);
+      }
+      return call.takeBuffer();
+    }, (arena, call) {
+      call
+        ..handle = _handle
+        ..text = key.toNativeUtf8(allocator: arena);
+    }, AsyncLane.of(priority));
+  }
+
+  // Reads a value from the Secure Storage into memory provided by the caller.
+  //
+  // Parameters:
+  // - key: The key under which the value was stored in the Secure Storage.
+  // - destination: Native memory the value is written to.
+  // - capacity: Size of destination.
+  //
+  // Returns the number of bytes written. If the value does not fit in destination nothing is
+  // written and the required size, greater than capacity, is returned instead.
+  //
+  // Throws TakException
+  //   - [TakReturnCode.apiNotInitialized]          when library is not initialized.
+  //   - [TakReturnCode.invalidParameter]       when an input parameter is invalid.
+  //   - [TakReturnCode.storageNotFound]       when storage object by the name provided does not exist.
+  //   - [TakReturnCode.storageKeyNotFound]    when storage object by this name does not exist.
+  //   - [TakReturnCode.storageDeviceMismatch] when app is found to be running on a different device. In that case, storage is deleted for security reasons.
+  //   - [TakReturnCode.generalError]            when an unexpected error happens.
+  int readInto(String key, Pointer<Uint8> destination, int capacity) {
+    if (storageName.isEmpty) {
+      throw TakException(TakReturnCode.invalidParameter);
+    }
+    final keyBytes = utf8.encode(key);
+    return using((Arena arena) {
+      ReadIntoResponse response = nativeReadSecureStorageIntoByHandle(
+          _handle,
+          nativeCopyOf(arena, keyBytes),
+          keyBytes.length,
+          destination,
+          capacity);
+      TakReturnCode mapResponse =
+          TakReturnCodeMapper.mapErrorCode(response.returnCode);
+      if (mapResponse != TakReturnCode.success &&
+          mapResponse != TakReturnCode.bufferTooSmall) {
+        throw TakException(mapResponse);
+      }
+      return response.length;
+    });
+  }
+
   // Reads a string from the Secure Storage.
   //
   // Parameters:
@@ -196,13 +384,169 @@ class SecureStorage {
     if (storageName.isEmpty) {
       throw TakException(TakReturnCode.invalidParameter);
     }
-    final response = nativeStorageDeleteEntry(
-        storageName.toNativeUtf8().cast<Char>(),
-        key.toNativeUtf8().cast<Char>());
+    final keyBytes = utf8.encode(key);
+    final response = using((Arena arena) => nativeStorageDeleteEntryByHandle(
+        _handle, nativeCopyOf(arena, keyBytes), keyBytes.length));
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  // Whether [listKeys] and the other key listings return every key of this Secure Storage.
+  //
+  // Keys are indexed natively as they are written and deleted. A storage created by an earlier
+  // version of this plugin may hold keys written before, which are only listed once they are
+  // written again.
+  bool get hasCompleteKeyIndex => nativeStorageHasCompleteKeyIndex(_handle);
+
+  // Whether this Secure Storage holds [key]. When the key index is complete, keys it does not hold
+  // are answered without decrypting anything, most of them rejected by a native Bloom filter. Keys
+  // it holds are confirmed by reading their value, as the index may list keys whose write failed.
+  //
+  // Throws TakException
+  //   - [TakReturnCode.apiNotInitialized]          when library is not initialized.
+  //   - [TakReturnCode.storageDeviceMismatch] when app is found to be running on a different device. In that case, storage is deleted for security reasons.
+  //   - [TakReturnCode.generalError]            when an unexpected error happens.
+  bool containsKey(String key) {
+    final keyBytes = utf8.encode(key);
+    final mapResponse = TakReturnCodeMapper.mapErrorCode(using((Arena arena) =>
+        nativeStorageContains(
+            _handle, nativeCopyOf(arena, keyBytes), keyBytes.length)));
+    if (mapResponse == TakReturnCode.success) {
+      return true;
+    }
+    if (mapResponse == TakReturnCode.storageKeyNotFound) {
+      return false;
+    }
+    throw TakException(mapResponse);
+  }
+
+  // Lists the keys of this Secure Storage, sorted by their UTF-8 bytes, without reading any value.
+  //
+  // Throws TakException
+  //   - [TakReturnCode.apiNotInitialized]          when library is not initialized.
+  //   - [TakReturnCode.storageDeviceMismatch] when app is found to be running on a different device. In that case, storage is deleted for security reasons.
+  //   - [TakReturnCode.generalError]            when an unexpected error happens.
+  List<String> listKeys() => keysInRange();
+
+  // Lists the keys starting with [prefix], at most [limit] of them when given.
+  //
+  // Throws TakException as [listKeys].
+  List<String> keysWithPrefix(String prefix, {int? limit}) {
+    final prefixBytes = utf8.encode(prefix);
+    return _takeKeys(using((Arena arena) => nativeStorageScanPrefix(_handle,
+        nativeCopyOf(arena, prefixBytes), prefixBytes.length, limit ?? 0)));
+  }
+
+  // Lists the keys from [start] included to [end] excluded, at most [limit] of them when given.
+  //
+  // Throws TakException as [listKeys].
+  List<String> keysInRange({String? start, String? end, int? limit}) {
+    final startBytes = utf8.encode(start ?? '');
+    final endBytes = utf8.encode(end ?? '');
+    return _takeKeys(using((Arena arena) => nativeStorageListKeys(
+        _handle,
+        nativeCopyOf(arena, startBytes),
+        startBytes.length,
+        nativeCopyOf(arena, endBytes),
+        endBytes.length,
+        limit ?? 0)));
+  }
+
+  // Iterates over the keys from [start] included to [end] excluded, listing [pageSize] of them at
+  // a time.
+  //
+  // Throws TakException as [listKeys].
+  Iterable<String> iterateKeys(
+      {String? start, String? end, int pageSize = 256}) sync* {
+    String? from = start;
+    bool skipFirst = false;
+    while (true) {
+      final page = keysInRange(start: from, end: end, limit: pageSize + 1);
+      final keys = skipFirst && page.isNotEmpty && page.first == from
+          ? page.skip(1)
+          : page;
+      yield* keys;
+      if (page.length <= pageSize) {
+        return;
+      }
+      // The next page starts from the last key listed, which is skipped
+      from = page.last;
+      skipFirst = true;
+    }
+  }
+
+  List<String> _takeKeys(TakByteBufferResponse response) {
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnValue);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+    final packed = response.getValue();
+    final sizes = ByteData.sublistView(packed);
+    final keys = <String>[];
+    int offset = 0;
+    while (offset < packed.length) {
+      final size = sizes.getUint32(offset, Endian.host);
+      keys.add(utf8.decode(
+          Uint8List.sublistView(packed, offset + 4, offset + 4 + size)));
+      offset += 4 + size;
+    }
+    return keys;
+  }
+
+  // Converts a value accepted by [write] to its stored bytes.
+  //
+  // Throws TakException
+  //   - [TakReturnCode.invalidParameter]       when the value is of another type.
+  Uint8List _toUint8List(dynamic value) {
+    if (value is int) {
+      return _intToUint8List(value);
+    } else if (value is String) {
+      return Uint8List.fromList(utf8.encode(value));
+    } else if (value is bool) {
+      return Uint8List(1)..[0] = value ? 1 : 0;
+    } else if (value is Uint8List) {
+      return value;
+    }
+    throw TakException(TakReturnCode.invalidParameter);
+  }
+
+  // Copies [parts] one after another to native memory of [arena], for a batch.
+  Pointer<Uint8> _pack(Arena arena, List<Uint8List> parts) {
+    final total = parts.fold<int>(0, (total, part) => total + part.length);
+    final packed = arena<Uint8>(total > 0 ? total : 1);
+    final view = packed.asTypedList(total);
+    int offset = 0;
+    for (final part in parts) {
+      view.setAll(offset, part);
+      offset += part.length;
+    }
+    return packed;
+  }
+
+  // Copies the sizes of [parts] to native memory of [arena], for a batch.
+  Pointer<Int32> _packLengths(Arena arena, List<Uint8List> parts) {
+    final lengths = arena<Int32>(parts.isNotEmpty ? parts.length : 1);
+    for (int i = 0; i < parts.length; i++) {
+      lengths[i] = parts[i].length;
+    }
+    return lengths;
+  }
+
+  // Throws the error of a batch, or of its first entry that failed.
+  void _throwFirstError(int response, Int32List results) {
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
     if (mapResponse != TakReturnCode.success) {
       throw TakException(mapResponse);
     }
+    for (final result in results) {
+      mapResponse = TakReturnCodeMapper.mapErrorCode(result);
+      if (mapResponse != TakReturnCode.success) {
+        throw TakException(mapResponse);
+      }
+    }
   }
 
   // Converts an integer to a Uint8List.
@@ -1,17 +1,33 @@
+import 'dart:async';
 import 'dart:ffi';
+import 'dart:isolate';
 import 'package:ffi/ffi.dart';
 import 'package:flutter/services.dart';
 
 import 'package:tak/check_integrity_response.dart';
 import 'package:tak/file_protector.dart';
+import 'package:tak/native_tak/asset_cache_stats.dart';
+import 'package:tak/native_tak/async_call.dart';
+import 'package:tak/native_tak/buffer_pool_stats.dart';
 import 'package:tak/native_tak/is_registered_response.dart';
+import 'package:tak/native_tak/runtime_scheduler_stats.dart';
+import 'package:tak/native_tak/scheduler_stats.dart';
+import 'package:tak/native_tak/startup_plan.dart';
+import 'package:tak/native_tak/startup_profile.dart';
+import 'package:tak/native_tak/storage_cache_stats.dart';
+import 'package:tak/native_tak/storage_writer_stats.dart';
+import 'package:tak/native_tak/tak_executor.dart';
 import 'package:tak/native_tak/tak_id_response.dart';
+import 'package:tak/posture_check.dart';
 import 'package:tak/register_response.dart';
 import 'package:tak/native_tak/tak.dart';
 import 'package:tak/root_status_response.dart';
 import 'package:tak/secure_storage.dart';
 import 'package:tak/tak_return_codes.dart';
+import 'package:tak/tak_startup.dart';
+import 'package:tak/tak_worker_isolate.dart';
 import 'package:tak/tls/tak_client_http.dart';
+import 'package:tak/tls/tls_connection.dart';
 
 /// A class representing the T.A.K Plugin for interacting with the SDK.
 ///
@@ -28,12 +44,14 @@ class TakPlugin {
   /// Parameter license: Name (without the ".tak" extension) of the license file to be used for initializing the lib.
   ///
   static Future<TakPlugin> initialize(String license) async {
-    const platform = MethodChannel('tak');
-    String workingPath = await platform.invokeMethod('loadEnvironment');
+    int startedAt = nativeStartupClockNanos();
+    String workingPath = await _loadEnvironment();
     String licenseDirectory = "flutter_assets/assets/$license";
     Pointer<Utf8> workingDir = workingPath.toNativeUtf8();
     int response =
         nativeInitialize(workingDir, licenseDirectory.toNativeUtf8());
+    nativeRecordStartupPhase(
+        StartupPhase.pluginInitialize, startedAt, response);
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
     if (mapResponse == TakReturnCode.success) {
       // If initialization is successful: do nothing.
@@ -51,6 +69,204 @@ class TakPlugin {
     return TakPlugin._();
   }
 
+  /// Initializes the T.A.K Plugin and runs the startup [steps] natively, in parallel where possible.
+  ///
+  /// Each step starts as soon as the step it depends on succeeded: registration waits for
+  /// initialization, the integrity check and the pinned certificates update wait for registration,
+  /// preconnecting waits for the pinned certificates, and the storage warm-up only waits for
+  /// initialization. Steps of different subsystems (lifecycle, storage, TLS) run at the same time,
+  /// lifecycle steps still run one after the other.
+  ///
+  /// Initialization and the [steps] not listed in [deferred] make the interactive stage, awaited by
+  /// [TakStartup.interactive]. The [deferred] steps run in the background and are awaited by
+  /// [TakStartup.deferred]. When a step fails, the steps depending on it are not run.
+  ///
+  /// [userHash] is passed to the registration. [storages] are the secure storages created by
+  /// [TakStartupStep.warmStorage]. [preconnect] lists the servers [TakStartupStep.preconnect]
+  /// connects to, their connections serve the first [TlsConnection.connect] to the same host and
+  /// port, and so the first request of a [TakHttpClient].
+  static TakStartup start(String license,
+      {Set<TakStartupStep> steps = const {},
+      Set<TakStartupStep> deferred = const {},
+      String? userHash,
+      List<String> storages = const [],
+      List<Uri> preconnect = const [],
+      int connectTimeout = TakHttpClient.DEFAULT_TIMEOUT}) {
+    final interactiveStage = Completer<TakPlugin>();
+    final deferredStage = Completer<void>();
+    deferredStage.future.ignore();
+
+    int stageOf(TakStartupStep step) {
+      if (!steps.contains(step)) {
+        return StartupStage.none;
+      }
+      return deferred.contains(step)
+          ? StartupStage.deferred
+          : StartupStage.interactive;
+    }
+
+    _startPipeline(
+      license,
+      [
+        StartupStage.interactive,
+        stageOf(TakStartupStep.register),
+        stageOf(TakStartupStep.checkIntegrity),
+        stageOf(TakStartupStep.updatePinnedCertificates),
+        stageOf(TakStartupStep.warmStorage),
+        stageOf(TakStartupStep.preconnect),
+      ],
+      userHash,
+      storages,
+      preconnect,
+      connectTimeout,
+      (int stage, TakException? error) {
+        if (stage == StartupStage.interactive) {
+          error != null
+              ? interactiveStage.completeError(error)
+              : interactiveStage.complete(TakPlugin._());
+        } else {
+          error != null
+              ? deferredStage.completeError(error)
+              : deferredStage.complete();
+        }
+      },
+    ).catchError((Object error, StackTrace stackTrace) {
+      // The pipeline could not be started, no stage is completed
+      interactiveStage.completeError(error, stackTrace);
+      deferredStage.completeError(error, stackTrace);
+    });
+    return TakStartup(interactiveStage.future, deferredStage.future);
+  }
+
+  static Future<void> _startPipeline(
+      String license,
+      List<int> stages,
+      String? userHash,
+      List<String> storages,
+      List<Uri> preconnect,
+      int connectTimeout,
+      void Function(int stage, TakException? error) onStage) async {
+    int startedAt = nativeStartupClockNanos();
+    String workingPath = await _loadEnvironment();
+    nativeInitializeAsync(NativeApi.postCObject.cast());
+
+    final plan = calloc<StartupPlan>();
+    final hosts = [for (final uri in preconnect) uri.host];
+    final ports = [for (final uri in preconnect) uri.port.toString()];
+    plan.ref
+      ..workingPath = workingPath.toNativeUtf8(allocator: calloc)
+      ..license =
+          "flutter_assets/assets/$license".toNativeUtf8(allocator: calloc)
+      ..userHash = userHash?.toNativeUtf8(allocator: calloc) ?? nullptr
+      ..storageNames = _toNativeStrings(storages)
+      ..storageCount = storages.length
+      ..hosts = _toNativeStrings(hosts)
+      ..ports = _toNativeStrings(ports)
+      ..sockets = preconnect.isEmpty ? nullptr : calloc<Int32>(preconnect.length)
+      ..connectionCount = preconnect.length
+      ..connectTimeout = connectTimeout;
+    for (int step = 0; step < StartupStep.count; step++) {
+      plan.ref.stages[step] = stages[step];
+    }
+
+    void freePlan() {
+      calloc.free(plan.ref.workingPath);
+      calloc.free(plan.ref.license);
+      if (plan.ref.userHash != nullptr) {
+        calloc.free(plan.ref.userHash);
+      }
+      _freeNativeStrings(plan.ref.storageNames, storages.length);
+      _freeNativeStrings(plan.ref.hosts, hosts.length);
+      _freeNativeStrings(plan.ref.ports, ports.length);
+      if (plan.ref.sockets != nullptr) {
+        calloc.free(plan.ref.sockets);
+      }
+      calloc.free(plan);
+    }
+
+    final port = RawReceivePort(null, 'TakStartup');
+    port.handler = (dynamic message) {
+      final stage = message as int;
+      if (stage == StartupStage.none) {
+        port.close();
+        freePlan();
+        return;
+      }
+      if (plan.ref.stages[StartupStep.preconnect] == stage) {
+        for (int i = 0; i < preconnect.length; i++) {
+          if (plan.ref.sockets[i] >= 0) {
+            TlsConnection.addPreconnected(
+                hosts[i], ports[i], connectTimeout, plan.ref.sockets[i]);
+          }
+        }
+      }
+      int? failedCode;
+      for (int step = 0; step < StartupStep.count; step++) {
+        if (plan.ref.stages[step] == stage &&
+            plan.ref.failedSteps & (1 << step) != 0) {
+          failedCode = plan.ref.returnCodes[step];
+          break;
+        }
+      }
+      if (stage == StartupStage.interactive) {
+        nativeRecordStartupPhase(StartupPhase.pluginInitialize, startedAt,
+            failedCode ?? plan.ref.returnCodes[StartupStep.initialize]);
+      }
+      onStage(
+          stage,
+          failedCode != null
+              ? TakException(TakReturnCodeMapper.mapErrorCode(failedCode))
+              : null);
+    };
+
+    int response = nativeStartStartup(plan, port.sendPort.nativePort);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      port.close();
+      freePlan();
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Returns the working path. On Android it is read synchronously from the native library, where
+  /// the plugin left it when attaching; the platform channel is only used when it is not there yet
+  /// and on the other platforms.
+  static Future<String> _loadEnvironment() async {
+    int startedAt = nativeStartupClockNanos();
+    Pointer<Utf8> nativeWorkingPath = nativeGetWorkingPath();
+    String workingPath;
+    if (nativeWorkingPath != nullptr) {
+      workingPath = nativeWorkingPath.toDartString();
+    } else {
+      const platform = MethodChannel('tak');
+      workingPath = await platform.invokeMethod('loadEnvironment');
+    }
+    // The platform channel throws when the environment cannot be loaded
+    nativeRecordStartupPhase(StartupPhase.loadEnvironment, startedAt, 0);
+    return workingPath;
+  }
+
+  static Pointer<Pointer<Utf8>> _toNativeStrings(List<String> strings) {
+    if (strings.isEmpty) {
+      return nullptr;
+    }
+    final natives = calloc<Pointer<Utf8>>(strings.length);
+    for (int i = 0; i < strings.length; i++) {
+      natives[i] = strings[i].toNativeUtf8(allocator: calloc);
+    }
+    return natives;
+  }
+
+  static void _freeNativeStrings(Pointer<Pointer<Utf8>> natives, int count) {
+    if (natives == nullptr) {
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      calloc.free(natives[i]);
+    }
+    calloc.free(natives);
+  }
+
   /// Returns the build version of the T.A.K-Client library.
   /// This is the version number transmitted to the T.A.K server on "register" and "validate" calls. Due to the design of
   /// T.A.K, this number changes for every T.A.K-Client build, even if there are no code changes.
@@ -68,14 +284,205 @@ class TakPlugin {
     return nativeGetTakVersion().toDartString();
   }
 
+  /// Sets the maximum number of bytes the native response buffer pool may reserve.
+  ///
+  /// Buffers built natively (gathered TLS writes, pinned certificates) are served from this pool
+  /// and return to it once released. Buffers allocated by the T.A.K library are handed over as is.
+  /// A [capacity] of 0 disables pooling. The capacity can be grown or shrunk at any time.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.invalidParameter] when [capacity] is negative, or
+  /// when it was already grown too many times to reserve more memory.
+  static void configureBufferPool(int capacity) {
+    int response = nativeConfigureBufferPool(capacity);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Sets the maximum number of decrypted bytes kept by the cache of [FileProtector.decryptFromFile].
+  ///
+  /// Assets are cached by file name and the least recently used ones are dropped, their memory
+  /// zeroed, to stay within [capacity]. Larger assets are not cached. The cache keeps decrypted
+  /// data in memory, so it is disabled until a [capacity] above 0 is set. A [capacity] of 0
+  /// disables it again. The cache is emptied when the library is initialized, reset or released.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.invalidParameter] when [capacity] is negative.
+  static void configureAssetCache(int capacity) {
+    int response = nativeConfigureAssetCache(capacity);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Returns the usage counters of the native cache of decrypted assets.
+  static AssetCacheStats getAssetCacheStats() {
+    return nativeGetAssetCacheStats();
+  }
+
+  /// Enables the cache of [SecureStorage] values, holding at most [capacity] bytes of values.
+  ///
+  /// Values are cached by storage and key when they are read, and the least recently used ones are
+  /// dropped, their memory zeroed, to stay within [capacity]. Writes and deletes drop the values
+  /// they change. With [maskValues], cached values are kept XOR-masked with a random key stream
+  /// instead of in plain. A [capacity] of 0, the default, disables the cache. The cache is emptied
+  /// when the library is initialized, reset or released.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.invalidParameter] when [capacity] is negative.
+  static void configureStorageCache(int capacity, {bool maskValues = false}) {
+    int response = nativeConfigureStorageCache(capacity, maskValues);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Returns the usage counters of the native cache of secure storage values.
+  static StorageCacheStats getStorageCacheStats() {
+    return nativeGetStorageCacheStats();
+  }
+
+  /// Defers [SecureStorage] writes by up to [window].
+  ///
+  /// Writes are then kept in memory and written by a native background thread once the oldest of
+  /// them has waited for [window]. A key written again meanwhile is written once, with its last
+  /// value. Reads and deletes see the values waiting to be written. Values waiting are also written
+  /// by [flushStorageWrites] and by [dispose]. A [window] of zero, the default, writes right away
+  /// and first writes what is waiting.
+  ///
+  /// Errors of deferred writes are not reported by [SecureStorage.write], but by the next
+  /// [flushStorageWrites]. The first deferred write to a storage checks that it exists, so a
+  /// missing storage is still reported by [SecureStorage.write].
+  ///
+  /// Throws a [TakException] with [TakReturnCode.invalidParameter] when [window] is negative.
+  static void configureStorageWriteBehind(Duration window) {
+    int response = nativeConfigureStorageWriter(window.inMilliseconds);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Writes the [SecureStorage] writes deferred by [configureStorageWriteBehind].
+  ///
+  /// Throws a [TakException] with the first error of the deferred writes since the last call,
+  /// including the ones written in the background.
+  static void flushStorageWrites() {
+    int response = nativeFlushStorageWriter();
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Returns the usage counters of the native write-behind of secure storage writes.
+  static StorageWriterStats getStorageWriterStats() {
+    return nativeGetStorageWriterStats();
+  }
+
+  /// Returns the usage counters of the native response buffer pool.
+  static BufferPoolStats getBufferPoolStats() {
+    return nativeGetBufferPoolStats();
+  }
+
+  /// Sets the maximum number of native threads running blocking calls in the background.
+  ///
+  /// Network and I/O bound calls (registration, integrity checks, TLS connections and reads,
+  /// storage and file protection) run on these threads, so they never block the calling isolate.
+  /// Threads are started on demand and are kept once started. Defaults to 7: one each for storage,
+  /// file protection and lifecycle, whose calls run one at a time, and 4 for TLS, whose calls only
+  /// wait for the calls on the same connection.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.invalidParameter] when [maxThreads] is not positive.
+  static void configureWorkerPool(int maxThreads) {
+    int response = nativeConfigureWorkerPool(maxThreads);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Returns the queue depths and wait times of the calls run in the background.
+  static SchedulerStats getSchedulerStats() {
+    return nativeGetSchedulerStats();
+  }
+
+  /// Sets how long the result of a security [check] is reused.
+  ///
+  /// Root detection and integrity checks are expensive, so their results are cached natively and
+  /// concurrent callers share a single evaluation. Once 80% of [ttl] has elapsed the cached result
+  /// is still returned while it is refreshed in the background. Only successful evaluations are
+  /// cached: failures and warnings such as [TakReturnCode.reRegisterSuccess] or
+  /// [TakReturnCode.licenseAboutToExpire] are evaluated again on the next call.
+  /// A [ttl] of zero disables caching, which is the default.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.invalidParameter] when [ttl] is negative.
+  static void configurePostureCache(PostureCheck check, Duration ttl) {
+    int response = nativeConfigurePostureCache(check.index, ttl.inMilliseconds);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Discards the cached result of [check], or of every check when null.
+  ///
+  /// Registration, reset, initialization and release already invalidate the cache.
+  static void invalidatePostureCache([PostureCheck? check]) {
+    nativeInvalidatePostureCache(check?.index ?? -1);
+  }
+
+  /// Returns when [check] was last evaluated, or null if it never was.
+  static DateTime? getLastPostureEvaluation(PostureCheck check) {
+    int evaluatedAt = nativeGetPostureEvaluatedAt(check.index);
+    return evaluatedAt == 0
+        ? null
+        : DateTime.fromMillisecondsSinceEpoch(evaluatedAt);
+  }
+
+  /// Sets how often the pinned certificates are updated in the background.
+  ///
+  /// Once the cached certificates are older than [refreshInterval], the next lookup starts an
+  /// update in the background and is served from the cache meanwhile. A [refreshInterval] of zero
+  /// disables background updates. Defaults to 12 hours.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.invalidParameter] when [refreshInterval] is negative.
+  static void configurePinnedCertificates(Duration refreshInterval) {
+    int response =
+        nativeConfigurePinnedCertificates(refreshInterval.inMilliseconds);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  static Future<TakWorkerIsolate>? _workerIsolate;
+
+  /// Returns the worker isolate running T.A.K calls on large payloads, starting it on first use.
+  ///
+  /// Payloads are moved to and from the worker as [TransferableTypedData], so encrypting,
+  /// decrypting or storing large buffers neither blocks nor copies on the calling isolate.
+  static Future<TakWorkerIsolate> getWorkerIsolate() {
+    return _workerIsolate ??= TakWorkerIsolate.spawn();
+  }
+
   /// Releases and disposes of the current SDK instance.
   /// Releases all the memory used by the T.A.K library.
   ///
   /// Remarks:
   ///   - This method needs to be called when the instance will no longer be used.
   ///   - Any threads still running in the background will be stopped.
+  ///   - Storage writes deferred by [configureStorageWriteBehind] are written first.
+  ///
+  /// Throws a [TakException] with the first error of the deferred storage writes, as
+  /// [flushStorageWrites] would. The library is released regardless.
   void dispose() {
-    nativeRelease();
+    int response = nativeRelease();
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
   }
 
   /// Verifies whether the SDK is initialized or not.
@@ -107,16 +514,16 @@ class TakPlugin {
   /// - [TakReturnCode.networkError] when a network error occurs. Try again later.
   /// - [TakReturnCode.generalError] when an unexpected error has happened.
   Future<RegisterResponse> register(String? userHash) async {
-    Pointer<Char> userHashConvert = nullptr;
     if (userHash != null && userHash.isEmpty) {
       throw TakException(TakReturnCode.invalidParameter);
     }
-    // Convert userHash to native UTF-8
-    if (userHash != null) {
-      userHashConvert = userHash.toNativeUtf8().cast<Char>();
-    }
-    // Call register function with converted userHash
-    final response = nativeRegister(userHashConvert);
+    // Call register function on a worker thread with userHash converted to native UTF-8
+    final response = await TakExecutor.instance.call(
+        AsyncOperation.register, (call) => call.returnCode, (arena, call) {
+      if (userHash != null) {
+        call.text = userHash.toNativeUtf8(allocator: arena);
+      }
+    });
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
     if (mapResponse != TakReturnCode.success &&
         mapResponse != TakReturnCode.licenseAboutToExpire) {
@@ -178,7 +585,8 @@ class TakPlugin {
   /// - [TakReturnCode.instanceLocked] this is a warning, the application has been remotely locked.
   ///   Some of the functionalities will not be available until the instance is unlocked.
   Future<CheckIntegrityResponse> checkIntegrity() async {
-    final response = nativeCheckIntegrity();
+    final response = await TakExecutor.instance
+        .call(AsyncOperation.checkIntegrity, (call) => call.returnCode);
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
     if (mapResponse != TakReturnCode.success &&
         mapResponse != TakReturnCode.licenseAboutToExpire &&
@@ -305,6 +713,77 @@ class TakPlugin {
     }
   }
 
+  /// Runs the runtime checks around the activity of the application.
+  ///
+  /// Like [createRuntimeCheckThread], the checks run every [interval] seconds, but the runtime check
+  /// thread is stopped while [setRuntimeBusy] reports the application as busy, and once the checks
+  /// used more than [cpuBudget] of CPU time within [budgetWindow]. A run in progress is never
+  /// interrupted, and once the last run is older than [maxGap] (four intervals by default) the
+  /// checks run again whatever the hint and the budget. A [cpuBudget] of zero disables the budget.
+  ///
+  /// [createRuntimeCheckThread] and [stopRuntimeThread] stop the scheduler.
+  ///
+  /// Throws a [TakException] in the same cases as [createRuntimeCheckThread], and with
+  /// [TakReturnCode.invalidParameter] when a duration is negative.
+  void startRuntimeScheduler(int interval,
+      {Duration cpuBudget = Duration.zero,
+      Duration budgetWindow = const Duration(minutes: 1),
+      Duration maxGap = Duration.zero}) {
+    int response = nativeStartRuntimeScheduler(interval, cpuBudget.inMicroseconds,
+        budgetWindow.inMilliseconds, maxGap.inMilliseconds);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Stops the scheduler started by [startRuntimeScheduler] and its runtime check thread.
+  ///
+  /// Throws a [TakException] in the same cases as [stopRuntimeThread].
+  void stopRuntimeScheduler() {
+    int response = nativeStopRuntimeScheduler();
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Hints that the application is [busy] (scrolling, animating), so runtime checks are deferred.
+  ///
+  /// Only applies to the checks run by [startRuntimeScheduler]. The hint is cheap to set, it can
+  /// follow every scroll start and end.
+  static void setRuntimeBusy(bool busy) {
+    nativeSetRuntimeBusy(busy);
+  }
+
+  /// Returns the run durations, jitter and skipped intervals of the scheduled runtime checks.
+  static RuntimeSchedulerStats getRuntimeSchedulerStats() {
+    return nativeGetRuntimeSchedulerStats();
+  }
+
+  /// Returns the timings of the startup phases of this process, on the monotonic clock.
+  ///
+  /// Each [StartupPhase] keeps its first run, the cold start, and its latest run, so starts that
+  /// initialize the library again can be compared to it. The checks and updates run after the
+  /// startup are counted as runs of their phase too.
+  static StartupProfile getStartupProfile() {
+    return nativeGetStartupProfile();
+  }
+
+  /// Appends the startup profile to the file at [path], as a line of JSON with the versions of the
+  /// T.A.K lib, to compare starts across runs and SDK versions.
+  ///
+  /// Throws a [TakException] with [TakReturnCode.generalError] when the file cannot be written.
+  static void writeStartupProfile(String path) {
+    Pointer<Utf8> nativePath = path.toNativeUtf8();
+    int response = nativeWriteStartupProfile(nativePath);
+    malloc.free(nativePath);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
   /// Returns an instance of the [FileProtector] class.
   /// The `FileProtector` class can be used to protect (encrypt/decrypt) files or large data.
   /// Throws a [TakException] with [TakReturnCode.apiNotInitialized] if the T.A.K API is not initialized.
@@ -356,13 +835,16 @@ class TakPlugin {
     return TakHttpClient();
   }
 
+  /// Returns the pinned certificate of [hostName] in PEM format.
+  ///
+  /// Certificates are cached natively, only the first lookup of a host name reaches T.A.K.
   Uint8List getPinnedCertificates(String hostName) {
     if (!isInitialized()) {
       throw TakException(TakReturnCode.apiNotInitialized);
     }
-    final response = nativeGetPinnedCertificates(
-      hostName.toNativeUtf8().cast<Char>(),
-    );
+    final nativeHostName = hostName.toNativeUtf8();
+    final response = nativeGetPinnedCertificates(nativeHostName.cast<Char>());
+    malloc.free(nativeHostName);
     TakReturnCode mapResponse =
         TakReturnCodeMapper.mapErrorCode(response.returnValue);
     if (mapResponse != TakReturnCode.success) {
@@ -372,6 +854,9 @@ class TakPlugin {
     return response.getValue();
   }
 
+  /// Downloads the pinned certificates again and replaces the cached ones.
+  ///
+  /// Concurrent calls share a single download.
   void updatePinnedCertificates() {
     if (!isInitialized()) {
       throw TakException(TakReturnCode.apiNotInitialized);
@@ -383,4 +868,20 @@ class TakPlugin {
       throw TakException(mapResponse);
     }
   }
+
+  /// Downloads the pinned certificates again without blocking the calling isolate.
+  ///
+  /// Works as [updatePinnedCertificates], but the download runs on a native worker thread.
+  Future<void> updatePinnedCertificatesAsync() async {
+    if (!isInitialized()) {
+      throw TakException(TakReturnCode.apiNotInitialized);
+    }
+    int response = await TakExecutor.instance.call(
+        AsyncOperation.updatePinnedCertificates, (call) => call.returnCode);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
 }
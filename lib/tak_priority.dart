@@ -0,0 +1,15 @@
+/// Priority of a call run in the background.
+///
+/// Calls of a T.A.K subsystem (storage, TLS, file protection, lifecycle) run one at a time. Higher
+/// priority calls overtake waiting lower priority ones, which still run once they have waited long
+/// enough.
+enum TakPriority {
+  /// Calls the user is waiting for.
+  interactive,
+
+  /// Regular calls.
+  normal,
+
+  /// Bulk or maintenance work.
+  background,
+}
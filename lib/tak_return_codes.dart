@@ -27,7 +27,8 @@ enum TakReturnCode {
   networkTimeout,
   networkError,
   instanceWiped,
-  instanceLocked
+  instanceLocked,
+  bufferTooSmall
 }
 
 ///
@@ -60,6 +61,8 @@ class TakReturnCodeMapper {
   static const int _networkError = 0x00030009;
   static const int _instanceWiped = 0x0002000B;
   static const int _instanceLocked = 0x0002000C;
+  // Returned by the plugin, not T.A.K, when a value does not fit in the memory of the caller
+  static const int _bufferTooSmall = 0x00FF0001;
 
   static TakReturnCode mapErrorCode(int value) {
     switch (value) {
@@ -113,6 +116,8 @@ class TakReturnCodeMapper {
         return TakReturnCode.instanceWiped;
       case _invalidExecutionThread:
         return TakReturnCode.invalidExecutionThread;
+      case _bufferTooSmall:
+        return TakReturnCode.bufferTooSmall;
       case _generalError:
       default:
         return TakReturnCode.generalError;
@@ -0,0 +1,35 @@
+import 'package:tak/tak_plugin.dart';
+
+/// Optional steps of [TakPlugin.start].
+enum TakStartupStep {
+  /// Registers with the T.A.K server, unless already registered. See [TakPlugin.register].
+  register,
+
+  /// See [TakPlugin.checkIntegrity].
+  checkIntegrity,
+
+  /// See [TakPlugin.updatePinnedCertificates].
+  updatePinnedCertificates,
+
+  /// Creates the secure storages the application is about to use.
+  warmStorage,
+
+  /// Opens TLS connections ahead of the first requests.
+  preconnect,
+}
+
+/// Readiness of the stages of a startup started with [TakPlugin.start].
+class TakStartup {
+  /// Completes with the plugin once initialization and the interactive steps are done.
+  ///
+  /// Throws a [TakException] with the [TakReturnCode] of the first interactive step that failed.
+  final Future<TakPlugin> interactive;
+
+  /// Completes once the deferred steps are done.
+  ///
+  /// Throws a [TakException] with the [TakReturnCode] of the first deferred step that failed.
+  /// Its errors are not reported as uncaught when nobody waits for it.
+  final Future<void> deferred;
+
+  TakStartup(this.interactive, this.deferred);
+}
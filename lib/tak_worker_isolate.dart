@@ -0,0 +1,282 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:tak/native_tak/tak.dart';
+import 'package:tak/native_tak/tak_byte_array_response.dart';
+import 'package:tak/tak_return_codes.dart';
+
+/// A long-lived isolate running T.A.K calls on large payloads away from the calling isolate.
+///
+/// The isolate opens the native bindings once and then serves commands over a port. Payloads are
+/// moved to the worker as [TransferableTypedData], and results stay in the native buffer TakLib
+/// returned, handed over to the calling isolate by address, so neither is copied between isolates.
+/// Use [TakPlugin.getWorkerIsolate] to get the instance of the application.
+class TakWorkerIsolate {
+  static const int _encrypt = 0;
+  static const int _decrypt = 1;
+  static const int _decryptFromFile = 2;
+  static const int _storageRead = 3;
+  static const int _storageWrite = 4;
+  static const int _storageDeleteEntry = 5;
+  // TAK_GENERAL_ERROR, replied for commands that threw in the worker
+  static const int _generalErrorCode = 0x000F0001;
+
+  final ReceivePort _replies = ReceivePort('TakWorkerIsolate');
+  // Gets the uncaught errors and the exit of the worker
+  final ReceivePort _exits = ReceivePort('TakWorkerIsolateExit');
+  final Completer<SendPort> _commands = Completer<SendPort>();
+  final Map<int, Completer<List<dynamic>>> _pending = {};
+  late final Isolate _isolate;
+  int _nextId = 0;
+  bool _closed = false;
+
+  TakWorkerIsolate._();
+
+  /// Starts a new worker isolate.
+  static Future<TakWorkerIsolate> spawn() async {
+    final worker = TakWorkerIsolate._();
+    // The first message of the worker is the port taking its commands, replies follow
+    worker._replies.listen(worker._complete);
+    worker._exits.listen((_) => worker._exited());
+    try {
+      worker._isolate = await Isolate.spawn(_main, worker._replies.sendPort,
+          onError: worker._exits.sendPort,
+          onExit: worker._exits.sendPort,
+          debugName: 'TakWorkerIsolate');
+    } catch (_) {
+      worker._replies.close();
+      worker._exits.close();
+      rethrow;
+    }
+    await worker._commands.future;
+    return worker;
+  }
+
+  /// Encrypts [data] in the worker isolate, see [FileProtector.encrypt].
+  ///
+  /// [data] is moved to the worker, it cannot be materialized again by the caller.
+  ///
+  /// Throws a [TakException] with the relevant [TakReturnCode] if the encryption fails.
+  Future<Uint8List> encrypt(TransferableTypedData data) =>
+      _send(_encrypt, [data]);
+
+  /// Decrypts [data] in the worker isolate, see [FileProtector.decrypt].
+  ///
+  /// [data] is moved to the worker, it cannot be materialized again by the caller.
+  ///
+  /// Throws a [TakException] with the relevant [TakReturnCode] if the decryption fails.
+  Future<Uint8List> decrypt(TransferableTypedData data) =>
+      _send(_decrypt, [data]);
+
+  /// Decrypts an asset file in the worker isolate, see [FileProtector.decryptFromFile].
+  ///
+  /// Throws a [TakException] with the relevant [TakReturnCode] if the decryption fails.
+  Future<Uint8List> decryptFromFile(String fileName) =>
+      _send(_decryptFromFile, [fileName]);
+
+  /// Reads a value of a Secure Storage in the worker isolate, see [SecureStorage.read].
+  ///
+  /// Throws a [TakException] with the relevant [TakReturnCode] if the read fails.
+  Future<Uint8List> storageRead(String storageName, String key) =>
+      _send(_storageRead, [storageName, key]);
+
+  /// Writes a value to a Secure Storage in the worker isolate, see [SecureStorage.write].
+  ///
+  /// [value] is moved to the worker, it cannot be materialized again by the caller.
+  ///
+  /// Throws a [TakException] with the relevant [TakReturnCode] if the write fails.
+  Future<void> storageWrite(
+          String storageName, String key, TransferableTypedData value) =>
+      _send(_storageWrite, [storageName, key, value]);
+
+  /// Deletes a value of a Secure Storage in the worker isolate, see [SecureStorage.deleteEntry].
+  ///
+  /// Throws a [TakException] with the relevant [TakReturnCode] if the delete fails.
+  Future<void> storageDeleteEntry(String storageName, String key) =>
+      _send(_storageDeleteEntry, [storageName, key]);
+
+  /// Stops the worker isolate. Pending and later commands fail with [TakReturnCode.generalError].
+  ///
+  /// Results of the commands still running in the worker are not freed.
+  void close() {
+    if (_closed) {
+      return;
+    }
+    _isolate.kill(priority: Isolate.beforeNextEvent);
+    _fail();
+  }
+
+  Future<Uint8List> _send(int command, List<Object> arguments) async {
+    if (_closed) {
+      throw TakException(TakReturnCode.generalError);
+    }
+    final id = _nextId++;
+    final completer = Completer<List<dynamic>>();
+    _pending[id] = completer;
+    (await _commands.future).send([id, command, ...arguments]);
+
+    final [_, int returnCode, int address, int length] = await completer.future;
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(returnCode);
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+    if (address == 0) {
+      return Uint8List(0);
+    }
+    // The worker hands the buffer over, it is released once the list is garbage collected
+    return Pointer<Uint8>.fromAddress(address).asTypedList(length,
+        finalizer: nativeFreeBufferFinalizer,
+        token: Pointer<Void>.fromAddress(address));
+  }
+
+  void _complete(dynamic message) {
+    if (message is SendPort) {
+      _commands.complete(message);
+      return;
+    }
+    final reply = message as List<dynamic>;
+    final completer = _pending.remove(reply[0] as int);
+    if (completer != null) {
+      completer.complete(reply);
+    } else if (reply[2] != 0) {
+      nativeFreeBuffer(Pointer<Void>.fromAddress(reply[2] as int));
+    }
+  }
+
+  // The worker died, typically from an error it did not catch
+  void _exited() {
+    if (!_closed) {
+      _fail();
+    }
+  }
+
+  void _fail() {
+    _closed = true;
+    _replies.close();
+    _exits.close();
+    if (!_commands.isCompleted) {
+      _commands.completeError(TakException(TakReturnCode.generalError));
+    }
+    for (final completer in _pending.values) {
+      completer.completeError(TakException(TakReturnCode.generalError));
+    }
+    _pending.clear();
+  }
+
+  static void _main(SendPort replies) {
+    final commands = ReceivePort();
+    replies.send(commands.sendPort);
+
+    final storageHandles = <String, int>{};
+    commands.listen((message) {
+      final [int id, int command, ...arguments] = message as List<dynamic>;
+      List<Object?> reply;
+      try {
+        reply = _run(command, arguments, storageHandles);
+      } catch (_) {
+        reply = [_generalErrorCode, 0, 0];
+      }
+      replies.send([id, ...reply]);
+    });
+  }
+
+  // Returns the return code and the address and length of the result, 0 when there is none
+  static List<Object?> _run(
+      int command, List<dynamic> arguments, Map<String, int> storageHandles) {
+    switch (command) {
+      case _encrypt:
+        final data = (arguments[0] as TransferableTypedData)
+            .materialize()
+            .asUint8List();
+        return using((Arena arena) => _transfer(nativeFileProtectorEncryptData(
+            nativeCopyOf(arena, data), data.length)));
+      case _decrypt:
+        final data = (arguments[0] as TransferableTypedData)
+            .materialize()
+            .asUint8List();
+        return using((Arena arena) => _transfer(nativeFileProtectorDecryptData(
+            nativeCopyOf(arena, data), data.length)));
+      case _decryptFromFile:
+        return using((Arena arena) {
+          final file = 'flutter_assets/assets/${arguments[0] as String}';
+          return _transfer(nativeFileProtectorDecryptFromFile(
+              file.toNativeUtf8(allocator: arena).cast<Char>(),
+              'tak'.toNativeUtf8(allocator: arena).cast<Char>()));
+        });
+    }
+
+    final (returnCode, handle) =
+        _openStorage(arguments[0] as String, storageHandles);
+    if (returnCode != null) {
+      return [returnCode, 0, 0];
+    }
+    final key = utf8.encode(arguments[1] as String);
+    return using((Arena arena) {
+      final nativeKey = nativeCopyOf(arena, key);
+      switch (command) {
+        case _storageRead:
+          return _transfer(
+              nativeReadSecureStorageByHandle(handle, nativeKey, key.length));
+        case _storageWrite:
+          final value = (arguments[2] as TransferableTypedData)
+              .materialize()
+              .asUint8List();
+          return [
+            nativeWriteSecureStorageByHandle(handle, nativeKey, key.length,
+                nativeCopyOf(arena, value), value.length),
+            0,
+            0
+          ];
+        case _storageDeleteEntry:
+          return [
+            nativeStorageDeleteEntryByHandle(handle, nativeKey, key.length),
+            0,
+            0
+          ];
+      }
+      throw StateError('Unknown command $command');
+    });
+  }
+
+  // Returns the handle of the storage, or the return code when it could not be opened
+  static (int?, int) _openStorage(
+      String storageName, Map<String, int> storageHandles) {
+    final known = storageHandles[storageName];
+    if (known != null) {
+      return (null, known);
+    }
+    final nativeStorageName = storageName.toNativeUtf8();
+    final response = nativeOpenSecureStorage(nativeStorageName.cast<Char>());
+    malloc.free(nativeStorageName);
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnCode);
+    if (mapResponse != TakReturnCode.success &&
+        mapResponse != TakReturnCode.storageAlreadyExists) {
+      return (response.returnCode, 0);
+    }
+    storageHandles[storageName] = response.handle;
+    return (null, response.handle);
+  }
+
+  // Hands the buffer of the response over to the calling isolate, which releases it
+  static List<Object?> _transfer(TakByteBufferResponse response) {
+    final buffer = response.takByteBuffer.buffer;
+    TakReturnCode mapResponse =
+        TakReturnCodeMapper.mapErrorCode(response.returnValue);
+    if (mapResponse != TakReturnCode.success) {
+      if (buffer != nullptr) {
+        nativeFreeBuffer(buffer.cast());
+      }
+      return [response.returnValue, 0, 0];
+    }
+    return [
+      response.returnValue,
+      buffer.address,
+      response.takByteBuffer.bufferLength
+    ];
+  }
+}
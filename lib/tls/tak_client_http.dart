@@ -1,8 +1,6 @@
 import 'dart:async';
 import 'dart:convert';
-import 'dart:ffi';
 import 'dart:typed_data';
-import 'package:ffi/ffi.dart';
 import 'package:http/http.dart' as http;
 import 'package:tak/tls/tls_connection.dart';
 
@@ -16,7 +14,11 @@ class TakHttpClient extends http.BaseClient {
   static const String TRANSFER_ENCODING_KEY = 'Transfer-Encoding';
   static const String CHUNKED_ENCODING = 'chunked';
 
+  static final Uint8List _bodyTerminator =
+      Uint8List.fromList(utf8.encode('$LINE_BREAK$LINE_BREAK'));
+
   final Map<String, TlsConnection> tlsConnections = {};
+  final Map<String, Future<TlsConnection>> _connecting = {};
   int? finalContentLength;
 
   @override
@@ -31,33 +33,41 @@ class TakHttpClient extends http.BaseClient {
 
     // Retrieve or create a TLS connection
     final connectionKey = '${uri.host}:${uri.port}';
-    tlsConnections.putIfAbsent(
-      connectionKey,
-      () => TlsConnection(
-        fqdn: uri.host,
-        port: uri.port.toString(),
-        timeout: DEFAULT_TIMEOUT,
-      ),
-    );
-    final tlsConnection = tlsConnections[connectionKey]!;
+    var tlsConnection = tlsConnections[connectionKey];
+    if (tlsConnection == null) {
+      // Requests sent while connecting share the same connection
+      tlsConnection = await _connecting.putIfAbsent(
+        connectionKey,
+        () => TlsConnection.connect(
+          fqdn: uri.host,
+          port: uri.port.toString(),
+          timeout: DEFAULT_TIMEOUT,
+        ).whenComplete(() => _connecting.remove(connectionKey)),
+      );
+      tlsConnections[connectionKey] = tlsConnection;
+    }
 
-    // Add the request body string, if any and add Content-length to the headers
-    String body = "";
-    if (request is http.Request && request.body.isNotEmpty) {
+    // Add the request body bytes, if any and add Content-length to the headers
+    Uint8List? body;
+    if (request is http.Request && request.bodyBytes.isNotEmpty) {
       // Add content-lenght size
-      request.headers.addAll({'Content-Length': '${request.body.length}'});
-      body += '${request.body}${LINE_BREAK}$LINE_BREAK';
+      body = request.bodyBytes;
+      request.headers.addAll({'Content-Length': '${body.length}'});
     }
 
     // Prepare headers
     final headersBuffer = _buildHeadersBuffer(request.headers);
 
-    // Combine request components
-    String httpRequest =
-        '$requestLine${LINE_BREAK}$hostHeader${LINE_BREAK}$headersBuffer${LINE_BREAK}$body';
+    // Request line and headers, the body is sent as its own segment
+    String httpHead =
+        '$requestLine${LINE_BREAK}$hostHeader${LINE_BREAK}$headersBuffer${LINE_BREAK}';
 
     // Send request
-    await tlsConnection.write(httpRequest.toNativeUtf8().cast<Char>());
+    await tlsConnection.writev([
+      utf8.encode(httpHead),
+      if (body != null) body,
+      if (body != null) _bodyTerminator,
+    ]);
 
     // Read and process response
     final responseBytes = await _readResponse(tlsConnection);
@@ -108,7 +118,7 @@ class TakHttpClient extends http.BaseClient {
 
     // Read until the complete headers are found
     while (headersEndIndex == null) {
-      List<int> readBytes = await tlsConnection.read(DEFAULT_READ_SIZE);
+      List<int> readBytes = await tlsConnection.readView(DEFAULT_READ_SIZE);
       if (readBytes.isEmpty) {
         throw Exception(
             "HttpClient: Connection closed before headers were complete.");
@@ -187,7 +197,7 @@ class TakHttpClient extends http.BaseClient {
         if (bytesAlreadyObtained <= chunkSize) {
           // Read more data from the connection
           final readBytes = await tlsConnection
-              .read(DEFAULT_READ_SIZE)
+              .readView(DEFAULT_READ_SIZE)
               .timeout(Duration(seconds: 10));
           // Append the newly read data to readData
           readData.addAll(readBytes);
@@ -203,11 +213,12 @@ class TakHttpClient extends http.BaseClient {
       } else {
         // More data is needed
         final readBytes = await tlsConnection
-            .read(DEFAULT_READ_SIZE)
+            .readView(DEFAULT_READ_SIZE)
             .timeout(Duration(seconds: 10));
         if (chunkEndIndex == 0x0) {
-          // In this case, we are at the end of a chunk
-          readData = readBytes;
+          // In this case, we are at the end of a chunk. The read bytes are a view on the
+          // connection's receive buffer, keep a copy of them.
+          readData = List<int>.from(readBytes);
         } else {
           // If it is null, more data is still missing
           readData.addAll(readBytes);
@@ -226,7 +237,7 @@ class TakHttpClient extends http.BaseClient {
     while (true) {
       try {
         final readBytes = await tlsConnection
-            .read(DEFAULT_READ_SIZE)
+            .readView(DEFAULT_READ_SIZE)
             .timeout(Duration(seconds: 10));
 
         if (readBytes.isEmpty) {
@@ -310,7 +321,8 @@ class TakHttpClient extends http.BaseClient {
     int totalRead = contentBytes.length;
 
     while (totalRead < contentLength) {
-      List<int> chunk = await tlsConnection.read(contentLength - totalRead);
+      List<int> chunk =
+          await tlsConnection.readView(contentLength - totalRead);
       if (chunk.isEmpty) {
         throw Exception("HttpClient: Connection closed prematurely.");
       }
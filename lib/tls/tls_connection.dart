@@ -2,8 +2,10 @@ import 'dart:ffi';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
+import 'package:tak/native_tak/async_call.dart';
 import 'package:tak/native_tak/tak.dart';
-import 'package:tak/native_tak/tak_byte_array_response.dart';
+import 'package:tak/native_tak/tak_byte_buffer.dart';
+import 'package:tak/native_tak/tak_executor.dart';
 import 'package:tak/tak_return_codes.dart';
 import 'package:tak/tls/tls_connection_response.dart';
 
@@ -13,10 +15,20 @@ import 'package:tak/tls/tls_connection_response.dart';
 /// check if the connection is closed, and close the connection.
 ///
 class TlsConnection {
+  /// Size of the receive buffer reused by [readView].
+  static const int receiveBufferSize = 16384;
+
+  // Connections opened ahead of time by "fqdn:port", each is taken by the next connect
+  static final Map<String, TlsConnection> _preconnected = {};
+
   final String fqdn;
   final String port;
   final int timeout;
   late final int socketDescriptor;
+  Pointer<Uint8>? _receiveBuffer;
+  // Native read into _receiveBuffer that has not completed yet, possibly abandoned by its caller
+  Future<int>? _pendingRead;
+  bool _closed = false;
 
   /// Creates a new instance of [TlsConnection].
   ///
@@ -31,6 +43,51 @@ class TlsConnection {
     _connect();
   }
 
+  TlsConnection._connected(
+      this.fqdn, this.port, this.timeout, this.socketDescriptor);
+
+  /// Establishes a TLS connection without blocking the calling isolate.
+  ///
+  /// Works as the [TlsConnection] constructor, but the handshake runs on a native worker thread.
+  /// A connection opened ahead of time to the same host and port by [TakPlugin.start] is returned
+  /// right away instead.
+  ///
+  /// Throws:
+  ///   - [TakException] with the relevant [TakReturnCode] if the connection fails.
+  static Future<TlsConnection> connect(
+      {required String fqdn,
+      required String port,
+      required int timeout}) async {
+    final preconnected = _preconnected.remove('$fqdn:$port');
+    if (preconnected != null) {
+      return preconnected;
+    }
+    final socketDescriptor = await TakExecutor.instance.call(
+        AsyncOperation.tlsConnect, (call) {
+      TakReturnCode mapResponse =
+          TakReturnCodeMapper.mapErrorCode(call.returnCode);
+      if (mapResponse != TakReturnCode.success) {
+        throw TakException(mapResponse);
+      }
+      return call.result;
+    }, (arena, call) {
+      call
+        ..text = fqdn.toNativeUtf8(allocator: arena)
+        ..secondText = port.toNativeUtf8(allocator: arena)
+        ..size = timeout;
+    });
+    return TlsConnection._connected(fqdn, port, timeout, socketDescriptor);
+  }
+
+  /// Hands over a connection opened natively ahead of time, for the next [connect] to take.
+  static void addPreconnected(
+      String fqdn, String port, int timeout, int socketDescriptor) {
+    final replaced = _preconnected['$fqdn:$port'];
+    _preconnected['$fqdn:$port'] =
+        TlsConnection._connected(fqdn, port, timeout, socketDescriptor);
+    replaced?.close();
+  }
+
   void _connect() {
     TlsConnectionResponse response = nativeTlsConnectSecurePinning(
         fqdn.toNativeUtf8().cast<Char>(),
@@ -53,7 +110,101 @@ class TlsConnection {
   /// Throws:
   ///   - [TakException] with the relevant [TakReturnCode] if the write operation fails.
   Future<void> write(Pointer<Char> data) async {
-    int response = nativeTlsWrite(socketDescriptor, data);
+    int response = await TakExecutor.instance.call(
+        AsyncOperation.tlsWritev, (call) => call.returnCode, (arena, call) {
+      final segment = arena<TakByteBuffer>()
+        ..ref.buffer = data.cast()
+        ..ref.bufferLength = data.cast<Utf8>().length;
+      call
+        ..handle = socketDescriptor
+        ..data = segment.cast()
+        ..size = 1;
+    });
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Writes binary data to the TLS connection.
+  ///
+  /// All [segments] are sent in a single native call with their explicit lengths, so they may
+  /// contain zero bytes and do not need to be concatenated first. Small segments are coalesced
+  /// natively into as few TLS writes as possible.
+  ///
+  /// [segments]: The data to write to the connection, in order.
+  ///
+  /// Throws:
+  ///   - [TakException] with the relevant [TakReturnCode] if the write operation fails.
+  Future<void> writev(List<Uint8List> segments) async {
+    if (segments.isEmpty) {
+      return;
+    }
+    int response = await TakExecutor.instance.call(
+        AsyncOperation.tlsWritev, (call) => call.returnCode, (arena, call) {
+      final vector = arena<TakByteBuffer>(segments.length);
+      for (var i = 0; i < segments.length; i++) {
+        final segment = segments[i];
+        Pointer<Uint8> data = nullptr;
+        if (segment.isNotEmpty) {
+          data = arena<Uint8>(segment.length);
+          data.asTypedList(segment.length).setAll(0, segment);
+        }
+        vector[i]
+          ..buffer = data
+          ..bufferLength = segment.length;
+      }
+      call
+        ..handle = socketDescriptor
+        ..data = vector.cast()
+        ..size = segments.length;
+    });
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Enables write combining on the TLS connection.
+  ///
+  /// Subsequent writes are buffered natively and sent together, so several small writes leave as
+  /// full-size TLS records instead of one record each. Pending data is sent when the buffer cannot
+  /// take the next write, when [autoFlushThreshold] bytes are pending (if greater than 0), on
+  /// [flush], on [close] and, if [flushBeforeRead] is `true`, before the next read.
+  ///
+  /// If sending pending data fails, part of it may already have been sent, so it is not sent again.
+  /// The connection is then unusable: later writes, flushes and reads throw the same error,
+  /// [isClosed] returns `true`, and the connection must be closed and a new one opened.
+  ///
+  /// [bufferSize]: Size of the write buffer in bytes. 0 disables write combining.
+  ///
+  /// Throws:
+  ///   - [TakException] with the relevant [TakReturnCode] if pending data could not be sent.
+  void setWriteBuffer(
+      {int bufferSize = 16384,
+      int autoFlushThreshold = 0,
+      bool flushBeforeRead = true}) {
+    int response = nativeTlsSetWriteBuffer(
+        socketDescriptor, bufferSize, autoFlushThreshold, flushBeforeRead);
+    TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
+
+    if (mapResponse != TakReturnCode.success) {
+      throw TakException(mapResponse);
+    }
+  }
+
+  /// Sends the data pending in the write buffer, if any.
+  ///
+  /// Throws:
+  ///   - [TakException] with the relevant [TakReturnCode] if the write operation fails. The pending
+  ///     data is then lost and the connection must be closed, see [setWriteBuffer].
+  Future<void> flush() async {
+    int response = await TakExecutor.instance.call(
+        AsyncOperation.tlsFlush, (call) => call.returnCode, (arena, call) {
+      call.handle = socketDescriptor;
+    });
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
 
     if (mapResponse != TakReturnCode.success) {
@@ -70,17 +221,87 @@ class TlsConnection {
   ///
   /// Throws:
   ///   - [TakException] with the relevant [TakReturnCode] if the read operation fails.
-  Future<Uint8List> read(int max) async {
-    TakByteBufferResponse response = nativeTlsRead(socketDescriptor, max);
+  Future<Uint8List> read(int max) {
+    return TakExecutor.instance.call(AsyncOperation.tlsRead, (call) {
+      TakReturnCode mapResponse =
+          TakReturnCodeMapper.mapErrorCode(call.returnCode);
 
-    TakReturnCode mapResponse =
-        TakReturnCodeMapper.mapErrorCode(response.returnValue);
+      if (mapResponse != TakReturnCode.success) {
+        throw TakException(mapResponse);
+      }
 
-    if (mapResponse != TakReturnCode.success) {
-      throw TakException(mapResponse);
-    }
+      return call.takeBuffer();
+    }, (arena, call) {
+      call
+        ..handle = socketDescriptor
+        ..size = max;
+    });
+  }
+
+  /// Reads data from the TLS connection into memory provided by the caller.
+  ///
+  /// [destination]: Native memory the data is written to. It must stay allocated until the
+  ///   returned future completes.
+  /// [capacity]: Size of [destination], which is also the maximum amount of data to read.
+  ///
+  /// Returns:
+  ///   - The number of bytes written to [destination].
+  ///
+  /// Throws:
+  ///   - [TakException] with the relevant [TakReturnCode] if the read operation fails.
+  Future<int> readInto(Pointer<Uint8> destination, int capacity) {
+    return TakExecutor.instance.call(AsyncOperation.tlsReadInto, (call) {
+      TakReturnCode mapResponse =
+          TakReturnCodeMapper.mapErrorCode(call.returnCode);
 
-    return response.getValue();
+      if (mapResponse != TakReturnCode.success) {
+        throw TakException(mapResponse);
+      }
+
+      return call.result;
+    }, (arena, call) {
+      call
+        ..handle = socketDescriptor
+        ..data = destination
+        ..size = capacity;
+    });
+  }
+
+  /// Reads data from the TLS connection into a receive buffer owned by the connection.
+  ///
+  /// [max]: The maximum amount of data to read, capped to [receiveBufferSize].
+  ///
+  /// Returns:
+  ///   - A [Uint8List] view on the receive buffer. It is only valid until the next call to
+  ///     [readView] or [close], copy it to keep the data.
+  ///
+  /// A read whose future is abandoned, for example after a [Future.timeout], keeps running
+  /// natively. The next [readView] waits for it before reusing the receive buffer, and [close]
+  /// frees the buffer only once it has completed.
+  ///
+  /// Throws:
+  ///   - [TakException] with the relevant [TakReturnCode] if the read operation fails.
+  ///   - [StateError] if the connection has been closed.
+  Future<Uint8List> readView(int max) async {
+    final previous = _pendingRead;
+    if (previous != null) {
+      await previous.then<void>((_) {}, onError: (Object _) {});
+    }
+    if (_closed) {
+      throw StateError('The TLS connection is closed');
+    }
+    final buffer = _receiveBuffer ??= calloc<Uint8>(receiveBufferSize);
+    final read =
+        readInto(buffer, max < receiveBufferSize ? max : receiveBufferSize);
+    _pendingRead = read;
+    try {
+      final length = await read;
+      return buffer.asTypedList(length);
+    } finally {
+      if (identical(_pendingRead, read)) {
+        _pendingRead = null;
+      }
+    }
   }
 
   /// Checks if the TLS connection is closed.
@@ -94,10 +315,26 @@ class TlsConnection {
 
   /// Closes the TLS connection.
   ///
+  /// Must not be called while a write is still pending. A pending [readView] fails once the
+  /// connection is closed, and its receive buffer is freed when it completes.
+  ///
   /// Throws:
   ///   - [TakException] with the relevant [TakReturnCode] if the close operation fails.
 
   void close() {
+    _closed = true;
+    final buffer = _receiveBuffer;
+    _receiveBuffer = null;
+    if (buffer != null) {
+      final pending = _pendingRead;
+      if (pending == null) {
+        calloc.free(buffer);
+      } else {
+        pending
+            .then<void>((_) {}, onError: (Object _) {})
+            .whenComplete(() => calloc.free(buffer));
+      }
+    }
     int response = nativeTlsClose(socketDescriptor);
     TakReturnCode mapResponse = TakReturnCodeMapper.mapErrorCode(response);
     if (mapResponse != TakReturnCode.success) {
@@ -0,0 +1,247 @@
+#include "asset_cache.h"
+#include "subsystem_lock.h"
+#include "worker_pool.h"
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Opt-in, like the storage cache: decrypted assets would otherwise stay in memory in clear
+static const uint64_t kDefaultBudgetBytes = 0;
+
+struct CachedAsset {
+    unsigned char* data;
+    size_t size;
+    // Position in the recency list
+    std::list<std::string>::iterator position;
+};
+
+struct AssetCache {
+    std::mutex mutex;
+    std::condition_variable loaded;
+    uint64_t budgetBytes = kDefaultBudgetBytes;
+    std::unordered_map<std::string, CachedAsset> assets;
+    // Most recently used first
+    std::list<std::string> recency;
+    // Assets being decrypted
+    std::unordered_set<std::string> loading;
+    // Bumped when cleared, assets decrypted before are not cached
+    uint64_t generation = 0;
+    AssetCacheStats stats = {};
+};
+
+// Never destroyed: prefetches may still run while static destructors run at exit
+static AssetCache& cache() {
+    static AssetCache* instance = new AssetCache();
+    return *instance;
+}
+
+struct PrefetchJob {
+    std::string fileName;
+    std::string extension;
+};
+
+// The compiler may not drop the stores, unlike a memset before free
+static void zeroize(unsigned char* data, size_t size) {
+    volatile unsigned char* cursor = data;
+    while (size-- > 0) {
+        *cursor++ = 0;
+    }
+}
+
+// Must be called with the cache mutex held
+static void dropAsset(AssetCache& state, std::unordered_map<std::string, CachedAsset>::iterator found) {
+    zeroize(found->second.data, found->second.size);
+    free(found->second.data);
+    state.stats.bytesInUse -= found->second.size;
+    state.stats.entries--;
+    state.recency.erase(found->second.position);
+    state.assets.erase(found);
+}
+
+// Must be called with the cache mutex held
+static void evictToBudget(AssetCache& state, uint64_t budgetBytes) {
+    while (state.stats.bytesInUse > budgetBytes && !state.recency.empty()) {
+        dropAsset(state, state.assets.find(state.recency.back()));
+        state.stats.evictions++;
+    }
+}
+
+static std::string cacheKey(const char* fileName, const char* extension) {
+    std::string key(fileName);
+    key += '.';
+    key += extension;
+    return key;
+}
+
+// Must be called with the cache mutex held. Copies the asset into a buffer for the caller.
+static bool copyCached(AssetCache& state, const std::string& key, TAK_byte_buffer* output, int32_t* returnCode) {
+    auto found = state.assets.find(key);
+    if (found == state.assets.end()) {
+        return false;
+    }
+    CachedAsset& asset = found->second;
+    state.recency.splice(state.recency.begin(), state.recency, asset.position);
+    state.stats.hits++;
+    output->data = (unsigned char*) malloc(asset.size);
+    if (output->data == NULL) {
+        *returnCode = TAK_OUT_OF_MEMORY;
+        return true;
+    }
+    memcpy(output->data, asset.data, asset.size);
+    output->length = (unsigned int) asset.size;
+    *returnCode = TAK_SUCCESS;
+    return true;
+}
+
+// Decrypts the file, the cache mutex is released meanwhile. Must be called with `key` marked loading.
+static int32_t loadAsset(AssetCache& state, std::unique_lock<std::mutex>& lock, const std::string& key,
+                         const char* fileName, const char* extension, TAK_byte_buffer* output) {
+    uint64_t generation = state.generation;
+    state.stats.misses++;
+    lock.unlock();
+    int32_t returnCode;
+    {
+        SubsystemLock crypto(SUBSYSTEM_CRYPTO);
+        returnCode = TakLib_fileProtectorDecryptFromFile(fileName, extension, output);
+    }
+    // The copy is made before taking the lock, it is dropped if the asset cannot be cached
+    unsigned char* copy = NULL;
+    if (returnCode == TAK_SUCCESS && output->data != NULL && output->length > 0) {
+        copy = (unsigned char*) malloc(output->length);
+        if (copy != NULL) {
+            memcpy(copy, output->data, output->length);
+        }
+    }
+    lock.lock();
+
+    state.loading.erase(key);
+    state.loaded.notify_all();
+    if (copy == NULL) {
+        return returnCode;
+    }
+    if (generation != state.generation || output->length > state.budgetBytes) {
+        zeroize(copy, output->length);
+        free(copy);
+        return returnCode;
+    }
+    evictToBudget(state, state.budgetBytes - output->length);
+    state.recency.push_front(key);
+    state.assets.emplace(key, CachedAsset{copy, output->length, state.recency.begin()});
+    state.stats.bytesInUse += output->length;
+    state.stats.entries++;
+    return returnCode;
+}
+
+static void prefetchAsset(void* argument) {
+    PrefetchJob* job = (PrefetchJob*) argument;
+    AssetCache& state = cache();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    std::string key = cacheKey(job->fileName.c_str(), job->extension.c_str());
+    // Already cached or being decrypted by a caller
+    if (state.budgetBytes > 0 && state.assets.count(key) == 0 && state.loading.count(key) == 0) {
+        state.loading.insert(key);
+        TAK_byte_buffer output = {NULL, 0};
+        if (loadAsset(state, lock, key, job->fileName.c_str(), job->extension.c_str(), &output) == TAK_SUCCESS) {
+            state.stats.prefetched++;
+        }
+        if (output.data != NULL) {
+            zeroize(output.data, output.length);
+            free(output.data);
+        }
+    }
+    lock.unlock();
+    delete job;
+}
+
+extern "C" {
+
+    int32_t assetCacheDecryptFromFile(const char* fileName, const char* extension, TAK_byte_buffer* output) {
+        if (fileName == NULL || extension == NULL || output == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        output->data = NULL;
+        output->length = 0;
+        AssetCache& state = cache();
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (state.budgetBytes == 0) {
+            lock.unlock();
+            SubsystemLock crypto(SUBSYSTEM_CRYPTO);
+            return TakLib_fileProtectorDecryptFromFile(fileName, extension, output);
+        }
+
+        std::string key = cacheKey(fileName, extension);
+        int32_t returnCode;
+        while (true) {
+            if (copyCached(state, key, output, &returnCode)) {
+                return returnCode;
+            }
+            if (state.loading.count(key) == 0) {
+                break;
+            }
+            // When the decryption in flight fails or is not cached, this call decrypts it again
+            state.loaded.wait(lock, [&state, &key] { return state.loading.count(key) == 0; });
+        }
+        state.loading.insert(key);
+        return loadAsset(state, lock, key, fileName, extension, output);
+    }
+
+    int32_t assetCachePrefetch(const char* const* fileNames, int count, const char* extension) {
+        if (fileNames == NULL || count < 0 || extension == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        for (int i = 0; i < count; i++) {
+            if (fileNames[i] == NULL) {
+                return TAK_INVALID_PARAMETER;
+            }
+        }
+        int32_t returnCode = TAK_SUCCESS;
+        for (int i = 0; i < count; i++) {
+            PrefetchJob* job = new (std::nothrow) PrefetchJob();
+            if (job == NULL) {
+                return TAK_OUT_OF_MEMORY;
+            }
+            job->fileName = fileNames[i];
+            job->extension = extension;
+            if (!workerPoolSubmit(SUBSYSTEM_CRYPTO, LANE_BACKGROUND, prefetchAsset, job)) {
+                delete job;
+                returnCode = TAK_GENERAL_ERROR;
+            }
+        }
+        return returnCode;
+    }
+
+    int32_t assetCacheConfigure(int64_t budgetBytes) {
+        if (budgetBytes < 0) {
+            return TAK_INVALID_PARAMETER;
+        }
+        AssetCache& state = cache();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.budgetBytes = (uint64_t) budgetBytes;
+        evictToBudget(state, state.budgetBytes);
+        return TAK_SUCCESS;
+    }
+
+    void assetCacheClear(void) {
+        AssetCache& state = cache();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.generation++;
+        while (!state.assets.empty()) {
+            dropAsset(state, state.assets.begin());
+        }
+    }
+
+    AssetCacheStats assetCacheGetStats(void) {
+        AssetCache& state = cache();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        AssetCacheStats stats = state.stats;
+        stats.capacity = state.budgetBytes;
+        return stats;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef ASSET_CACHE_HEADER
+#define ASSET_CACHE_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Cache of the assets decrypted with TakLib_fileProtectorDecryptFromFile, by file name.
+//
+// The least recently used assets are evicted once the decrypted bytes exceed the budget, and
+// their memory is zeroed before it is released. Assets larger than the budget are not cached.
+// Concurrent requests for an asset share a single decryption, so a call for an asset that is
+// being prefetched waits for the prefetch instead of decrypting it again.
+extern "C" {
+    // Decrypts the file, or copies it from the cache, into `output` allocated with malloc.
+    int32_t assetCacheDecryptFromFile(const char* fileName, const char* extension, TAK_byte_buffer* output);
+    // Decrypts the files into the cache on the worker pool, in the background lane.
+    int32_t assetCachePrefetch(const char* const* fileNames, int count, const char* extension);
+    // Sets the budget in bytes of decrypted data, 0, the default, disables the cache. Evicts down to
+    // the budget.
+    int32_t assetCacheConfigure(int64_t budgetBytes);
+    // Zeroes and drops every asset, for when TakLib is initialized, reset or released.
+    void assetCacheClear(void);
+    AssetCacheStats assetCacheGetStats(void);
+}
+#endif // ASSET_CACHE_HEADER
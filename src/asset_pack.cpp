@@ -0,0 +1,205 @@
+#include "asset_pack.h"
+#include "asset_source.h"
+#include "subsystem_lock.h"
+
+#include <memory>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static const char kMagic[8] = {'T', 'A', 'K', 'P', 'A', 'C', 'K', '1'};
+static const uint32_t kHeaderSize = 16;
+// Smallest index entry: a one byte name
+static const uint32_t kMinIndexEntrySize = 2 + 1 + 8 + 8;
+
+struct PackEntry {
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct AssetPack {
+    AssetSource source;
+    // Serializes the reads through the asset manager
+    std::mutex readMutex;
+    std::unordered_map<std::string, PackEntry> entries;
+
+    ~AssetPack() {
+        assetSourceClose(&source);
+    }
+};
+
+struct PackRegistry {
+    std::mutex mutex;
+    // Slot of each handle, emptied when the pack is closed. Handles are not reused, so a stale
+    // handle fails instead of reading another pack.
+    std::vector<std::shared_ptr<AssetPack>> packs;
+};
+
+// Never destroyed: packs may still be read by worker threads while static destructors run at exit
+static PackRegistry& registry() {
+    static PackRegistry* instance = new PackRegistry();
+    return *instance;
+}
+
+static std::shared_ptr<AssetPack> findPack(int32_t handle) {
+    PackRegistry& state = registry();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (handle <= 0 || (size_t) handle > state.packs.size()) {
+        return nullptr;
+    }
+    return state.packs[handle - 1];
+}
+
+static bool readAt(AssetPack& pack, uint64_t offset, uint64_t length, unsigned char* destination) {
+    if (pack.source.fd >= 0) {
+        return assetSourceRead(&pack.source, offset, length, destination);
+    }
+    std::lock_guard<std::mutex> lock(pack.readMutex);
+    return assetSourceRead(&pack.source, offset, length, destination);
+}
+
+static uint64_t readLittleEndian(const unsigned char* data, int size) {
+    uint64_t value = 0;
+    for (int i = size - 1; i >= 0; i--) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+static int32_t readIndex(AssetPack* pack) {
+    unsigned char header[kHeaderSize];
+    if (!readAt(*pack, 0, kHeaderSize, header) || memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        return TAK_GENERAL_ERROR;
+    }
+    uint32_t count = (uint32_t) readLittleEndian(header + 8, 4);
+    uint32_t indexSize = (uint32_t) readLittleEndian(header + 12, 4);
+    if (indexSize > pack->source.size - kHeaderSize || count > indexSize / kMinIndexEntrySize) {
+        return TAK_GENERAL_ERROR;
+    }
+
+    std::vector<unsigned char> index(indexSize);
+    if (!readAt(*pack, kHeaderSize, indexSize, index.data())) {
+        return TAK_GENERAL_ERROR;
+    }
+    uint64_t dataStart = (uint64_t) kHeaderSize + indexSize;
+    size_t position = 0;
+    pack->entries.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (indexSize - position < 2) {
+            return TAK_GENERAL_ERROR;
+        }
+        size_t nameSize = (size_t) readLittleEndian(&index[position], 2);
+        position += 2;
+        if (nameSize == 0 || indexSize - position < nameSize + 16) {
+            return TAK_GENERAL_ERROR;
+        }
+        const char* name = (const char*) &index[position];
+        if (memchr(name, '\0', nameSize) != NULL) {
+            return TAK_GENERAL_ERROR;
+        }
+        PackEntry entry;
+        entry.offset = readLittleEndian(&index[position + nameSize], 8);
+        entry.size = readLittleEndian(&index[position + nameSize + 8], 8);
+        position += nameSize + 16;
+        if (entry.offset < dataStart || entry.offset > pack->source.size || entry.size > pack->source.size - entry.offset) {
+            return TAK_GENERAL_ERROR;
+        }
+        if (!pack->entries.emplace(std::string(name, nameSize), entry).second) {
+            return TAK_GENERAL_ERROR;
+        }
+    }
+    return position == indexSize ? TAK_SUCCESS : TAK_GENERAL_ERROR;
+}
+
+extern "C" {
+
+    int32_t assetPackOpen(const char* path, int32_t* handle) {
+        if (path == NULL || path[0] == '\0' || handle == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        *handle = 0;
+        std::shared_ptr<AssetPack> pack = std::make_shared<AssetPack>();
+        int32_t returnCode = assetSourceOpen(path, &pack->source);
+        if (returnCode == TAK_SUCCESS) {
+            returnCode = readIndex(pack.get());
+        }
+        if (returnCode != TAK_SUCCESS) {
+            return returnCode;
+        }
+
+        PackRegistry& state = registry();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.packs.push_back(pack);
+        // Handle 0 is never given out, so it can stand for "no pack" on the Dart side
+        *handle = (int32_t) state.packs.size();
+        return TAK_SUCCESS;
+    }
+
+    int32_t assetPackClose(int32_t handle) {
+        std::shared_ptr<AssetPack> pack;
+        {
+            PackRegistry& state = registry();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (handle <= 0 || (size_t) handle > state.packs.size() || state.packs[handle - 1] == nullptr) {
+                return TAK_INVALID_PARAMETER;
+            }
+            pack.swap(state.packs[handle - 1]);
+        }
+        // Reads in progress keep the pack open until they are done
+        return TAK_SUCCESS;
+    }
+
+    int32_t assetPackRead(int32_t handle, const char* name, TAK_byte_buffer* output) {
+        if (name == NULL || output == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        output->data = NULL;
+        output->length = 0;
+        std::shared_ptr<AssetPack> pack = findPack(handle);
+        if (pack == nullptr) {
+            return TAK_INVALID_PARAMETER;
+        }
+        auto found = pack->entries.find(name);
+        if (found == pack->entries.end()) {
+            return TAK_GENERAL_ERROR;
+        }
+        const PackEntry& entry = found->second;
+        if (entry.size == 0 || entry.size > UINT32_MAX) {
+            return TAK_INVALID_PARAMETER;
+        }
+
+        // Entries of a pack with a descriptor are decrypted from a mapping, without a copy on the heap
+        MappedRange range;
+        if (assetSourceMap(&pack->source, entry.offset, entry.size, &range)) {
+            TAK_byte_buffer input = {(unsigned char*) range.data, (unsigned int) entry.size};
+            int32_t returnCode;
+            {
+                SubsystemLock lock(SUBSYSTEM_CRYPTO);
+                returnCode = TakLib_fileProtectorDecrypt(input, output);
+            }
+            mappedRangeRelease(&range);
+            return returnCode;
+        }
+
+        unsigned char* encrypted = (unsigned char*) malloc(entry.size);
+        if (encrypted == NULL) {
+            return TAK_OUT_OF_MEMORY;
+        }
+        int32_t returnCode = TAK_GENERAL_ERROR;
+        if (readAt(*pack, entry.offset, entry.size, encrypted)) {
+            TAK_byte_buffer input = {encrypted, (unsigned int) entry.size};
+            SubsystemLock lock(SUBSYSTEM_CRYPTO);
+            returnCode = TakLib_fileProtectorDecrypt(input, output);
+        }
+        free(encrypted);
+        return returnCode;
+    }
+
+    int32_t assetPackEntryCount(int32_t handle) {
+        std::shared_ptr<AssetPack> pack = findPack(handle);
+        return pack != nullptr ? (int32_t) pack->entries.size() : -1;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef ASSET_PACK_HEADER
+#define ASSET_PACK_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Packs of protected assets, written by bin/tak_pack.dart.
+//
+// A pack holds many .tak files behind an index, so an application opens and indexes one asset
+// instead of looking up each file. All integers are little endian:
+//   header   magic "TAKPACK1", entry count (uint32), size of the index in bytes (uint32)
+//   index    for each entry: size of the name (uint16), name (UTF-8), offset (uint64), size (uint64)
+//   entries  the protected files as they are, offsets count from the start of the pack
+//
+// The index is read and checked once when the pack is opened. The pack stays open until it is
+// closed, entries are read from it by name and decrypted with TakLib_fileProtectorDecrypt.
+// On Android relative paths are read from the application assets, like TakLib does.
+extern "C" {
+    int32_t assetPackOpen(const char* path, int32_t* handle);
+    int32_t assetPackClose(int32_t handle);
+    // Decrypts the entry into `output`, allocated by TakLib. TAK_GENERAL_ERROR when there is no such entry.
+    int32_t assetPackRead(int32_t handle, const char* name, TAK_byte_buffer* output);
+    // Number of entries of the pack, or -1 for an unknown handle.
+    int32_t assetPackEntryCount(int32_t handle);
+}
+#endif // ASSET_PACK_HEADER
@@ -0,0 +1,155 @@
+#include "asset_source.h"
+#include "subsystem_lock.h"
+
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined TARGET_ANDROID
+#include "assetManagerProvider.h"
+#endif
+
+int32_t assetSourceOpen(const char* path, AssetSource* source) {
+    if (path == NULL || path[0] == '\0' || source == NULL) {
+        return TAK_INVALID_PARAMETER;
+    }
+#if defined TARGET_ANDROID
+    if (path[0] != '/') {
+        AAssetManager* assetManager = (AAssetManager*) getAssetManager();
+        if (assetManager == NULL) {
+            return TAK_GENERAL_ERROR;
+        }
+        AAsset* asset = AAssetManager_open(assetManager, path, AASSET_MODE_RANDOM);
+        if (asset == NULL) {
+            return TAK_GENERAL_ERROR;
+        }
+        off64_t start;
+        off64_t length;
+        int fd = AAsset_openFileDescriptor64(asset, &start, &length);
+        if (fd >= 0) {
+            AAsset_close(asset);
+            source->fd = fd;
+            source->base = (uint64_t) start;
+            source->size = (uint64_t) length;
+        } else {
+            source->asset = asset;
+            source->size = (uint64_t) AAsset_getLength64(asset);
+        }
+        return TAK_SUCCESS;
+    }
+#endif
+    source->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (source->fd < 0) {
+        return TAK_GENERAL_ERROR;
+    }
+    struct stat status;
+    if (fstat(source->fd, &status) != 0) {
+        assetSourceClose(source);
+        return TAK_GENERAL_ERROR;
+    }
+    source->size = (uint64_t) status.st_size;
+    return TAK_SUCCESS;
+}
+
+void assetSourceClose(AssetSource* source) {
+    if (source->fd >= 0) {
+        close(source->fd);
+        source->fd = -1;
+    }
+#if defined TARGET_ANDROID
+    if (source->asset != NULL) {
+        AAsset_close(source->asset);
+        source->asset = NULL;
+    }
+#endif
+}
+
+bool assetSourceRead(AssetSource* source, uint64_t offset, uint64_t length, unsigned char* destination) {
+    if (offset > source->size || length > source->size - offset) {
+        return false;
+    }
+    if (source->fd >= 0) {
+        while (length > 0) {
+            ssize_t count = pread(source->fd, destination, length, (off_t) (source->base + offset));
+            if (count <= 0) {
+                return false;
+            }
+            destination += count;
+            offset += count;
+            length -= count;
+        }
+        return true;
+    }
+#if defined TARGET_ANDROID
+    if (source->asset == NULL || AAsset_seek64(source->asset, (off64_t) offset, SEEK_SET) < 0) {
+        return false;
+    }
+    while (length > 0) {
+        int count = AAsset_read(source->asset, destination, length);
+        if (count <= 0) {
+            return false;
+        }
+        destination += count;
+        length -= count;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool assetSourceMap(const AssetSource* source, uint64_t offset, uint64_t length, MappedRange* range) {
+    if (source->fd < 0 || length == 0 || offset > source->size || length > source->size - offset) {
+        return false;
+    }
+    uint64_t start = source->base + offset;
+    uint64_t pageSize = (uint64_t) sysconf(_SC_PAGESIZE);
+    uint64_t alignedStart = start - start % pageSize;
+    size_t mappedLength = (size_t) (start - alignedStart + length);
+    void* address = mmap(NULL, mappedLength, PROT_READ, MAP_PRIVATE, source->fd, (off_t) alignedStart);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    // Pages are read once, ahead of the decryption, and can be dropped right after
+    madvise(address, mappedLength, MADV_SEQUENTIAL);
+    range->address = address;
+    range->length = mappedLength;
+    range->data = (const unsigned char*) address + (start - alignedStart);
+    return true;
+}
+
+void mappedRangeRelease(MappedRange* range) {
+    if (range->address != NULL) {
+        munmap(range->address, range->length);
+        range->address = NULL;
+        range->data = NULL;
+    }
+}
+
+int32_t assetSourceDecryptFile(const char* fileName, const char* extension, TAK_byte_buffer* output) {
+    if (fileName == NULL || extension == NULL || output == NULL) {
+        return TAK_INVALID_PARAMETER;
+    }
+    output->data = NULL;
+    output->length = 0;
+    std::string path(fileName);
+    path += '.';
+    path += extension;
+
+    AssetSource source;
+    MappedRange range;
+    bool mapped = assetSourceOpen(path.c_str(), &source) == TAK_SUCCESS && source.size <= UINT32_MAX &&
+                  assetSourceMap(&source, 0, source.size, &range);
+    // The mapping keeps the file readable
+    assetSourceClose(&source);
+
+    SubsystemLock lock(SUBSYSTEM_CRYPTO);
+    if (!mapped) {
+        return TakLib_fileProtectorDecryptFromFile(fileName, extension, output);
+    }
+    TAK_byte_buffer input = {(unsigned char*) range.data, (unsigned int) source.size};
+    int32_t returnCode = TakLib_fileProtectorDecrypt(input, output);
+    mappedRangeRelease(&range);
+    return returnCode;
+}
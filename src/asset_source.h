@@ -0,0 +1,45 @@
+#ifndef ASSET_SOURCE_HEADER
+#define ASSET_SOURCE_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+#include "native_tak.h"
+
+#if defined TARGET_ANDROID
+#include <android/asset_manager.h>
+#endif
+
+// Read-only view of a file, or on Android of an asset of the application when the path is relative,
+// like the paths TakLib resolves.
+//
+// Files and uncompressed assets are read through a descriptor, at `base` for an asset stored in the
+// package, and can be mapped. Compressed assets are only read through the asset manager, which is
+// not thread safe: reads of such a source must be serialized by the caller.
+struct AssetSource {
+    int fd = -1;
+    uint64_t base = 0;
+    uint64_t size = 0;
+#if defined TARGET_ANDROID
+    AAsset* asset = NULL;
+#endif
+};
+
+// Read-only mapping of part of a source.
+struct MappedRange {
+    void* address = NULL;
+    size_t length = 0;
+    // First byte of the range, inside the page aligned mapping
+    const unsigned char* data = NULL;
+};
+
+int32_t assetSourceOpen(const char* path, AssetSource* source);
+void assetSourceClose(AssetSource* source);
+bool assetSourceRead(AssetSource* source, uint64_t offset, uint64_t length, unsigned char* destination);
+// Maps `length` bytes at `offset`, read sequentially. Returns false when the source has no descriptor.
+bool assetSourceMap(const AssetSource* source, uint64_t offset, uint64_t length, MappedRange* range);
+void mappedRangeRelease(MappedRange* range);
+
+// Decrypts the protected file `fileName`.`extension` from a mapping of the file instead of a heap copy,
+// or with TakLib_fileProtectorDecryptFromFile when it cannot be mapped. `output` is allocated by TakLib.
+int32_t assetSourceDecryptFile(const char* fileName, const char* extension, TAK_byte_buffer* output);
+#endif // ASSET_SOURCE_HEADER
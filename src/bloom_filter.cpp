@@ -0,0 +1,70 @@
+#include "bloom_filter.h"
+
+// 10 counters and 7 hashes per key give about 1% of false positives
+static const size_t kCountersPerKey = 10;
+static const int kHashCount = 7;
+static const size_t kMinCapacity = 64;
+
+// Two halves of a 64-bit FNV-1a hash, combined into the positions of the key
+static void hashKey(const std::string& key, uint32_t* first, uint32_t* second) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char byte : key) {
+        hash ^= byte;
+        hash *= 0x100000001b3ULL;
+    }
+    *first = (uint32_t) hash;
+    // Odd, so the positions do not repeat before going through the filter
+    *second = (uint32_t) (hash >> 32) | 1;
+}
+
+void BloomFilter::reset(size_t expectedKeys) {
+    capacity = expectedKeys > kMinCapacity ? expectedKeys : kMinCapacity;
+    count = 0;
+    counters.assign(capacity * kCountersPerKey, 0);
+}
+
+void BloomFilter::add(const std::string& key) {
+    if (counters.empty()) {
+        reset(0);
+    }
+    uint32_t first, second;
+    hashKey(key, &first, &second);
+    for (int i = 0; i < kHashCount; i++) {
+        uint8_t& counter = counters[(first + (uint64_t) i * second) % counters.size()];
+        if (counter < UINT8_MAX) {
+            counter++;
+        }
+    }
+    count++;
+}
+
+void BloomFilter::remove(const std::string& key) {
+    if (counters.empty()) {
+        return;
+    }
+    uint32_t first, second;
+    hashKey(key, &first, &second);
+    for (int i = 0; i < kHashCount; i++) {
+        uint8_t& counter = counters[(first + (uint64_t) i * second) % counters.size()];
+        if (counter > 0 && counter < UINT8_MAX) {
+            counter--;
+        }
+    }
+    if (count > 0) {
+        count--;
+    }
+}
+
+bool BloomFilter::mightContain(const std::string& key) const {
+    if (counters.empty()) {
+        return false;
+    }
+    uint32_t first, second;
+    hashKey(key, &first, &second);
+    for (int i = 0; i < kHashCount; i++) {
+        if (counters[(first + (uint64_t) i * second) % counters.size()] == 0) {
+            return false;
+        }
+    }
+    return true;
+}
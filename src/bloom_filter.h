@@ -0,0 +1,29 @@
+#ifndef BLOOM_FILTER_HEADER
+#define BLOOM_FILTER_HEADER
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Counting Bloom filter of strings, so keys can be removed as well as added.
+//
+// mightContain never misses a key that was added and not removed. Counters that saturate are
+// never decremented again, which only keeps more false positives.
+class BloomFilter {
+public:
+    // Sizes the filter for `expectedKeys` and empties it.
+    void reset(size_t expectedKeys);
+    void add(const std::string& key);
+    void remove(const std::string& key);
+    bool mightContain(const std::string& key) const;
+    // Whether the filter holds more keys than it was sized for, and should be reset larger.
+    bool isOverloaded() const { return count > capacity; }
+
+private:
+    // Counters of the filter, one byte each
+    std::vector<uint8_t> counters;
+    size_t capacity = 0;
+    size_t count = 0;
+};
+#endif // BLOOM_FILTER_HEADER
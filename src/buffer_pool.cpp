@@ -0,0 +1,251 @@
+#include "buffer_pool.h"
+
+#include <atomic>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// The region is split in spans, every span holds blocks of a single size class
+static const size_t kSpanSize = 64 * 1024;
+static const size_t kClassSizes[] = {64, 256, 1024, 4096, 16384};
+static const int kClassCount = sizeof(kClassSizes) / sizeof(kClassSizes[0]);
+static const int kThreadCacheMax = 16;
+static const size_t kThreadCacheBytes = 64 * 1024;
+static const size_t kDefaultCapacity = 4 * 1024 * 1024;
+// Growing the capacity reserves another region, up to this many
+static const int kMaxRegions = 8;
+
+struct FreeList {
+    std::mutex mutex;
+    void* head = NULL;
+};
+
+// Regions are published once and never unmapped, so released blocks can be checked without locking
+struct Region {
+    unsigned char* base;
+    size_t size;
+    size_t nextSpan;
+    unsigned char* spanClass;
+};
+
+static std::mutex gRegionMutex;
+static Region gRegions[kMaxRegions];
+static std::atomic<int> gRegionCount(0);
+static size_t gCapacity = kDefaultCapacity;
+// Bytes of the regions reserved so far, and of the spans carved from them
+static size_t gRegionBytes = 0;
+static size_t gCarvedBytes = 0;
+static FreeList gFreeLists[kClassCount];
+
+static std::atomic<uint64_t> gReservedBytes(0);
+static std::atomic<uint64_t> gBytesInUse(0);
+static std::atomic<uint64_t> gAllocations(0);
+static std::atomic<uint64_t> gThreadCacheHits(0);
+static std::atomic<uint64_t> gMisses(0);
+static std::atomic<uint64_t> gReleases(0);
+
+static int classIndex(size_t size) {
+    for (int i = 0; i < kClassCount; i++) {
+        if (size <= kClassSizes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int threadCacheLimit(int sizeClass) {
+    size_t limit = kThreadCacheBytes / kClassSizes[sizeClass];
+    return limit < (size_t) kThreadCacheMax ? (int) limit : kThreadCacheMax;
+}
+
+// Blocks on the shared lists are linked through their first bytes
+static void pushBlocks(int sizeClass, void** blocks, int count) {
+    FreeList& list = gFreeLists[sizeClass];
+    std::lock_guard<std::mutex> lock(list.mutex);
+    for (int i = 0; i < count; i++) {
+        *(void**) blocks[i] = list.head;
+        list.head = blocks[i];
+    }
+}
+
+static int popBlocks(int sizeClass, void** blocks, int count) {
+    FreeList& list = gFreeLists[sizeClass];
+    std::lock_guard<std::mutex> lock(list.mutex);
+    int popped = 0;
+    while (popped < count && list.head != NULL) {
+        blocks[popped] = list.head;
+        list.head = *(void**) list.head;
+        popped++;
+    }
+    return popped;
+}
+
+struct ThreadCache {
+    void* blocks[kClassCount][kThreadCacheMax];
+    int count[kClassCount];
+
+    ThreadCache() {
+        memset(count, 0, sizeof(count));
+    }
+
+    ~ThreadCache() {
+        for (int i = 0; i < kClassCount; i++) {
+            pushBlocks(i, blocks[i], count[i]);
+            count[i] = 0;
+        }
+    }
+};
+
+static thread_local ThreadCache tCache;
+
+// Must be called with gRegionMutex held
+static Region* reserveRegion(size_t size) {
+    int count = gRegionCount.load(std::memory_order_relaxed);
+    size_t spans = (size + kSpanSize - 1) / kSpanSize;
+    if (count == kMaxRegions || spans == 0) {
+        return NULL;
+    }
+    // Pages are only committed once a span is carved and touched
+    void* base = mmap(NULL, spans * kSpanSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    unsigned char* spanClass = (unsigned char*) calloc(spans, sizeof(unsigned char));
+    if (spanClass == NULL) {
+        munmap(base, spans * kSpanSize);
+        return NULL;
+    }
+    Region& region = gRegions[count];
+    region.base = (unsigned char*) base;
+    region.size = spans * kSpanSize;
+    region.nextSpan = 0;
+    region.spanClass = spanClass;
+    gRegionBytes += region.size;
+    gRegionCount.store(count + 1, std::memory_order_release);
+    return &region;
+}
+
+static Region* findRegion(const unsigned char* block) {
+    int count = gRegionCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (block >= gRegions[i].base && block < gRegions[i].base + gRegions[i].size) {
+            return &gRegions[i];
+        }
+    }
+    return NULL;
+}
+
+static bool carveSpan(int sizeClass) {
+    unsigned char* span;
+    {
+        std::lock_guard<std::mutex> lock(gRegionMutex);
+        if (gCarvedBytes + kSpanSize > gCapacity) {
+            return false;
+        }
+        int count = gRegionCount.load(std::memory_order_relaxed);
+        Region* region = count > 0 ? &gRegions[count - 1] : NULL;
+        if (region == NULL || (region->nextSpan + 1) * kSpanSize > region->size) {
+            region = reserveRegion(gCapacity - gCarvedBytes);
+            if (region == NULL) {
+                return false;
+            }
+        }
+        region->spanClass[region->nextSpan] = (unsigned char) sizeClass;
+        span = region->base + region->nextSpan * kSpanSize;
+        region->nextSpan++;
+        gCarvedBytes += kSpanSize;
+    }
+    gReservedBytes.fetch_add(kSpanSize, std::memory_order_relaxed);
+
+    size_t blockSize = kClassSizes[sizeClass];
+    FreeList& list = gFreeLists[sizeClass];
+    std::lock_guard<std::mutex> lock(list.mutex);
+    for (size_t offset = kSpanSize; offset >= blockSize; offset -= blockSize) {
+        void* block = span + offset - blockSize;
+        *(void**) block = list.head;
+        list.head = block;
+    }
+    return true;
+}
+
+extern "C" {
+
+    unsigned char* bufferPoolAllocate(size_t size) {
+        int sizeClass = classIndex(size);
+        if (sizeClass < 0) {
+            gMisses.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        }
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        ThreadCache& cache = tCache;
+        if (cache.count[sizeClass] > 0) {
+            gThreadCacheHits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            int batch = threadCacheLimit(sizeClass) / 2 + 1;
+            int refilled = popBlocks(sizeClass, cache.blocks[sizeClass], batch);
+            if (refilled == 0 && carveSpan(sizeClass)) {
+                refilled = popBlocks(sizeClass, cache.blocks[sizeClass], batch);
+            }
+            if (refilled == 0) {
+                gMisses.fetch_add(1, std::memory_order_relaxed);
+                return NULL;
+            }
+            cache.count[sizeClass] = refilled;
+        }
+
+        gBytesInUse.fetch_add(kClassSizes[sizeClass], std::memory_order_relaxed);
+        return (unsigned char*) cache.blocks[sizeClass][--cache.count[sizeClass]];
+    }
+
+    bool bufferPoolRelease(void* buffer) {
+        unsigned char* block = (unsigned char*) buffer;
+        Region* region = findRegion(block);
+        if (region == NULL) {
+            return false;
+        }
+        int sizeClass = region->spanClass[(block - region->base) / kSpanSize];
+        size_t blockSize = kClassSizes[sizeClass];
+
+        // Response buffers may hold decrypted data, do not keep it around in idle blocks
+        memset(block, 0, blockSize);
+        gReleases.fetch_add(1, std::memory_order_relaxed);
+        gBytesInUse.fetch_sub(blockSize, std::memory_order_relaxed);
+
+        ThreadCache& cache = tCache;
+        int limit = threadCacheLimit(sizeClass);
+        if (cache.count[sizeClass] >= limit) {
+            int keep = limit / 2;
+            pushBlocks(sizeClass, cache.blocks[sizeClass] + keep, cache.count[sizeClass] - keep);
+            cache.count[sizeClass] = keep;
+        }
+        cache.blocks[sizeClass][cache.count[sizeClass]++] = block;
+        return true;
+    }
+
+    int32_t bufferPoolConfigure(size_t capacity) {
+        std::lock_guard<std::mutex> lock(gRegionMutex);
+        // Growing past the reserved regions needs one more region
+        if (capacity > gRegionBytes && gRegionCount.load(std::memory_order_relaxed) == kMaxRegions) {
+            return TAK_INVALID_PARAMETER;
+        }
+        gCapacity = capacity;
+        return TAK_SUCCESS;
+    }
+
+    BufferPoolStats bufferPoolGetStats(void) {
+        BufferPoolStats stats;
+        {
+            std::lock_guard<std::mutex> lock(gRegionMutex);
+            stats.capacity = gCapacity;
+        }
+        stats.reservedBytes = gReservedBytes.load(std::memory_order_relaxed);
+        stats.bytesInUse = gBytesInUse.load(std::memory_order_relaxed);
+        stats.allocations = gAllocations.load(std::memory_order_relaxed);
+        stats.threadCacheHits = gThreadCacheHits.load(std::memory_order_relaxed);
+        stats.misses = gMisses.load(std::memory_order_relaxed);
+        stats.releases = gReleases.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
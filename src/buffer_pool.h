@@ -0,0 +1,21 @@
+#ifndef BUFFER_POOL_HEADER
+#define BUFFER_POOL_HEADER
+
+#include <stddef.h>
+#include "native_tak.h"
+
+// Size-class pool for the buffers the wrapper builds itself and hands to Dart.
+//
+// Blocks are carved from a few reserved regions, so ownership of any pointer can be checked with
+// range tests. Each thread keeps a small cache per size class in front of the shared lists.
+extern "C" {
+    // Returns a block of at least `size` bytes, or NULL when the size is not pooled or the pool is exhausted.
+    unsigned char* bufferPoolAllocate(size_t size);
+    // Returns a block to the pool. Returns false if the buffer was not allocated by the pool.
+    bool bufferPoolRelease(void* buffer);
+    // Sets the pool capacity in bytes, 0 disables the pool. Growing it reserves another region when
+    // the carved spans reach the capacity; TAK_INVALID_PARAMETER when every region is taken.
+    int32_t bufferPoolConfigure(size_t capacity);
+    BufferPoolStats bufferPoolGetStats(void);
+}
+#endif // BUFFER_POOL_HEADER
@@ -0,0 +1,42 @@
+#include "dart_port.h"
+
+#include <atomic>
+#include <stddef.h>
+
+// Mirrors Dart_CObject from dart_native_api.h, only the members used here
+static const int32_t kDartCObjectInt64 = 3;
+
+struct DartCObject {
+    int32_t type;
+    union {
+        int64_t asInt64;
+        // Largest member of the union, as_external_typed_data
+        void* padding[5];
+    } value;
+};
+
+typedef bool (*DartPostCObjectFunction)(int64_t port, DartCObject* message);
+
+static std::atomic<DartPostCObjectFunction> gPostCObject(NULL);
+
+extern "C" {
+
+    void dartPortInitialize(void* postCObject) {
+        gPostCObject.store((DartPostCObjectFunction) postCObject, std::memory_order_release);
+    }
+
+    bool dartPortIsInitialized(void) {
+        return gPostCObject.load(std::memory_order_acquire) != NULL;
+    }
+
+    bool dartPortPostInt64(int64_t port, int64_t value) {
+        DartPostCObjectFunction postCObject = gPostCObject.load(std::memory_order_acquire);
+        if (postCObject == NULL) {
+            return false;
+        }
+        DartCObject message;
+        message.type = kDartCObjectInt64;
+        message.value.asInt64 = value;
+        return postCObject(port, &message);
+    }
+}
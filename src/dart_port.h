@@ -0,0 +1,17 @@
+#ifndef DART_PORT_HEADER
+#define DART_PORT_HEADER
+
+#include <stdint.h>
+
+// Posting messages to Dart ports from native threads.
+//
+// The Dart DL API is not part of this tree: Dart hands over NativeApi.postCObject at startup and
+// only integer messages are sent, whose Dart_CObject layout is part of the stable native API.
+extern "C" {
+    // `postCObject` is the Dart_PostCObject function, as exposed by NativeApi.postCObject.
+    void dartPortInitialize(void* postCObject);
+    bool dartPortIsInitialized(void);
+    // Returns false if the message could not be posted, e.g. the port is closed.
+    bool dartPortPostInt64(int64_t port, int64_t value);
+}
+#endif // DART_PORT_HEADER
@@ -2,6 +2,27 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "asset_cache.h"
+#include "asset_pack.h"
+#include "asset_source.h"
+#include "buffer_pool.h"
+#include "dart_port.h"
+#include "pinned_certificates.h"
+#include "posture_cache.h"
+#include "runtime_scheduler.h"
+#include "startup_pipeline.h"
+#include "startup_profile.h"
+#include "storage_cache.h"
+#include "storage_index.h"
+#include "storage_registry.h"
+#include "storage_writer.h"
+#include "subsystem_lock.h"
+#include "tls_writer.h"
+#include "worker_pool.h"
 
 #if defined TARGET_ANDROID
 #include "environmentProvider.h"
@@ -13,11 +34,65 @@ extern "C"
 #include <stdio.h>
 #include "native_tak.h"
 
+  // Hands a buffer allocated by TakLib over to the response without copying it.
+  // On success the caller (Dart) becomes the owner and must release it with native_freeBuffer,
+  // on failure anything TakLib may have allocated is released here.
+  static void transferBuffer(TakByteBufferResponse *response, TAK_byte_buffer *value)
+  {
+    if (response->returnCode == TAK_SUCCESS)
+    {
+      response->buffer.data = value->data;
+      response->buffer.length = value->data != NULL ? value->length : 0;
+    }
+    else if (value->data != NULL)
+    {
+      free(value->data);
+    }
+    value->data = NULL;
+    value->length = 0;
+  }
+
+  // Copies a buffer allocated by TakLib into memory provided by the caller and releases it.
+  // When the destination is too small nothing is copied, TAK_BUFFER_TOO_SMALL is returned and length
+  // holds the size needed to read the value.
+  static ReadIntoResponse copyIntoCaller(int32_t returnCode, TAK_byte_buffer *value, unsigned char *destination, int capacity)
+  {
+    ReadIntoResponse response;
+    response.returnCode = returnCode;
+    response.length = 0;
+
+    if (returnCode == TAK_SUCCESS && value->data != NULL)
+    {
+      response.length = value->length;
+      if (value->length > (unsigned int)capacity)
+      {
+        response.returnCode = TAK_BUFFER_TOO_SMALL;
+      }
+      else
+      {
+        memcpy(destination, value->data, value->length);
+      }
+    }
+    if (value->data != NULL)
+    {
+      free(value->data);
+    }
+    return response;
+  }
+
   // Public methods
+  // Calls into TakLib hold the lock of their subsystem. Version getters and native_isInitialized
+  // only read what TakLib set up when it was loaded or initialized, they do not wait for it.
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
   native_initialize(char *path, char *license)
   {
+    int64_t startedAt = startupProfileNow();
+    AllSubsystemsLock lock;
+    pinnedCertificatesClear();
+    assetCacheClear();
+    storageCacheClear();
+    storageIndexClear();
     JNIEnv *jniEnvironment = NULL;
     jobject context = NULL;
 #if defined TARGET_ANDROID
@@ -25,20 +100,47 @@ extern "C"
     getContext(&context);
 #endif
 
-    return TakLib_initialize(path, license, jniEnvironment, context);
+    postureCacheInvalidate(POSTURE_CHECK_ALL);
+    int64_t licenseStartedAt = startupProfileNow();
+    int32_t returnCode = TakLib_initialize(path, license, jniEnvironment, context);
+    startupProfileRecord(STARTUP_PHASE_LICENSE, licenseStartedAt, returnCode);
+    startupProfileRecord(STARTUP_PHASE_INITIALIZE, startedAt, returnCode);
+    return returnCode;
   }
 
-  __attribute__((visibility("default"))) __attribute__((used)) void native_release()
+  // Returns the first error of the deferred storage writes, TakLib is released regardless
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_release()
   {
+    // The scheduler takes the lifecycle lock to stop its thread
+    runtimeSchedulerStop();
+    AllSubsystemsLock lock;
+    // Deferred storage writes are persisted while TakLib can still write them
+    int32_t returnCode = storageWriterFlush();
+    pinnedCertificatesClear();
+    assetCacheClear();
+    storageCacheClear();
+    storageIndexClear();
+    postureCacheInvalidate(POSTURE_CHECK_ALL);
     TakLib_release();
     // TODO: Decide what to do with this
     // #if defined TARGET_ANDROID
     //     releaseEnvironment();
     // #endif
+    return returnCode;
   }
 
   __attribute__((visibility("default"))) __attribute__((used)) void native_reset()
   {
+    runtimeSchedulerStop();
+    AllSubsystemsLock lock;
+    pinnedCertificatesClear();
+    assetCacheClear();
+    storageWriterDiscard();
+    storageCacheClear();
+    storageIndexClear();
+    postureCacheInvalidate(POSTURE_CHECK_ALL);
     TakLib_reset();
   }
 
@@ -46,14 +148,57 @@ extern "C"
   int32_t
   native_register(char *user)
   {
-    return TakLib_register(user);
+    int64_t startedAt = startupProfileNow();
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+    int32_t returnCode = TakLib_register(user);
+    postureCacheInvalidate(POSTURE_CHECK_ALL);
+    startupProfileRecord(STARTUP_PHASE_REGISTER, startedAt, returnCode);
+    return returnCode;
+  }
+
+  // Posture checks are evaluated through the posture cache, they take the subsystem lock
+  // themselves so callers waiting for an evaluation in flight do not hold it.
+  static PostureResult evaluateIntegrity()
+  {
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+    PostureResult result = {0, TakLib_checkIntegrity(NULL)};
+    if (result.returnCode == TAK_RE_REGISTER_SUCCESS)
+    {
+      postureCacheInvalidate(POSTURE_REGISTRATION);
+    }
+    return result;
+  }
+
+  static PostureResult evaluateRegistration()
+  {
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+    PostureResult result = {0, TAK_SUCCESS};
+    result.value = TakLib_isRegistered(&(result.returnCode));
+    return result;
+  }
+
+  static PostureResult evaluateRootStatus()
+  {
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+    PostureResult result = {TakLib_getRootStatus(), TAK_SUCCESS};
+    return result;
+  }
+
+  static PostureResult evaluateAdvancedRootStatus()
+  {
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+    PostureResult result = {TakLib_getAdvancedRootStatus(), TAK_SUCCESS};
+    return result;
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
   native_checkIntegrity()
   {
-    return TakLib_checkIntegrity(NULL);
+    int64_t startedAt = startupProfileNow();
+    int32_t returnCode = postureCacheGet(POSTURE_INTEGRITY, evaluateIntegrity).returnCode;
+    startupProfileRecord(STARTUP_PHASE_CHECK_INTEGRITY, startedAt, returnCode);
+    return returnCode;
   }
 
   __attribute__((visibility("default"))) __attribute__((used)) char *native_getTakVersion()
@@ -74,9 +219,10 @@ extern "C"
   IsRegisteredResponse
   native_isRegistered()
   {
+    PostureResult result = postureCacheGet(POSTURE_REGISTRATION, evaluateRegistration);
     IsRegisteredResponse isRegisteredResponse;
-    isRegisteredResponse.returnCode = NULL;
-    isRegisteredResponse.isRegistered = TakLib_isRegistered(&(isRegisteredResponse.returnCode));
+    isRegisteredResponse.returnCode = result.returnCode;
+    isRegisteredResponse.isRegistered = result.value != 0;
 
     return isRegisteredResponse;
   }
@@ -90,6 +236,7 @@ extern "C"
   TakIdResponse
   native_getTakId()
   {
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
     TakIdResponse takIdResponse;
     takIdResponse.takId = NULL;
     takIdResponse.returnCode = TakLib_getTakIdentifier(&(takIdResponse.takId));
@@ -99,28 +246,34 @@ extern "C"
 
   __attribute__((visibility("default"))) __attribute__((used)) bool native_getRootStatus()
   {
-    return TakLib_getRootStatus();
+    return postureCacheGet(POSTURE_ROOT_STATUS, evaluateRootStatus).value != 0;
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   TAK_ROOT_STATUS
   native_getAdvancedRootStatus()
   {
-    return TakLib_getAdvancedRootStatus();
+    return (TAK_ROOT_STATUS)postureCacheGet(POSTURE_ADVANCED_ROOT_STATUS, evaluateAdvancedRootStatus).value;
   }
 
   __attribute__((visibility("default"))) __attribute__((used)) int native_createRuntimeCheckThread(int timeInterval)
   {
+    // The thread runs on its fixed interval from now on
+    runtimeSchedulerStop();
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
     return TakLib_createRuntimeCheckThread(timeInterval);
   }
 
   __attribute__((visibility("default"))) __attribute__((used)) int native_stopRuntimeThread()
   {
+    runtimeSchedulerStop();
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
     return TakLib_stopRuntimeThread();
   }
 
   __attribute__((visibility("default"))) __attribute__((used)) bool native_isRuntimeThreadActive(bool relaunch)
   {
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
     return TakLib_isRuntimeThreadActive(relaunch);
   }
 
@@ -128,19 +281,15 @@ extern "C"
   TakByteBufferResponse
   native_fileProtectorDecryptFromFile(char *fileName, char *extension)
   {
+    // The asset cache takes the crypto lock only to decrypt, a prefetch of the same file is waited for without it
     TakByteBufferResponse response;
     response.returnCode = TAK_GENERAL_ERROR;
     response.buffer.data = NULL;
     response.buffer.length = 0;
 
-    TAK_byte_buffer readValue;
-    response.returnCode = TakLib_fileProtectorDecryptFromFile(fileName, extension, &readValue);
-    if (response.returnCode == TAK_SUCCESS)
-    {
-      response.buffer.data = (unsigned char *)malloc(readValue.length * sizeof(unsigned char));
-      memcpy(response.buffer.data, readValue.data, readValue.length);
-      response.buffer.length = readValue.length;
-    }
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = assetCacheDecryptFromFile(fileName, extension, &readValue);
+    transferBuffer(&response, &readValue);
 
     return response;
   }
@@ -149,22 +298,15 @@ extern "C"
   TakByteBufferResponse
   native_fileProtectorEncrypt(TAK_byte_buffer input)
   {
+    SubsystemLock lock(SUBSYSTEM_CRYPTO);
     TakByteBufferResponse response;
     response.returnCode = TAK_GENERAL_ERROR;
     response.buffer.data = NULL;
     response.buffer.length = 0;
 
-    TAK_byte_buffer outputValue;
+    TAK_byte_buffer outputValue = {NULL, 0};
     response.returnCode = TakLib_fileProtectorEncrypt(input, &outputValue);
-    if (response.returnCode == TAK_SUCCESS)
-    {
-      response.buffer.data = (unsigned char *)malloc(outputValue.length * sizeof(unsigned char));
-      if (response.buffer.data != NULL)
-      {
-        memcpy(response.buffer.data, outputValue.data, outputValue.length);
-        response.buffer.length = outputValue.length;
-      }
-    }
+    transferBuffer(&response, &outputValue);
 
     return response;
   }
@@ -173,85 +315,242 @@ extern "C"
   TakByteBufferResponse
   native_fileProtectorDecrypt(TAK_byte_buffer input)
   {
+    SubsystemLock lock(SUBSYSTEM_CRYPTO);
     TakByteBufferResponse response;
     response.returnCode = TAK_GENERAL_ERROR;
     response.buffer.data = NULL;
     response.buffer.length = 0;
 
-    TAK_byte_buffer outputValue;
+    TAK_byte_buffer outputValue = {NULL, 0};
     response.returnCode = TakLib_fileProtectorDecrypt(input, &outputValue);
-    if (response.returnCode == TAK_SUCCESS)
+    transferBuffer(&response, &outputValue);
+
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_fileProtectorEncryptData(unsigned char *data, int length)
+  {
+    SubsystemLock lock(SUBSYSTEM_CRYPTO);
+    TAK_byte_buffer input;
+    input.data = data;
+    input.length = length > 0 ? length : 0;
+    return native_fileProtectorEncrypt(input);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_fileProtectorDecryptData(unsigned char *data, int length)
+  {
+    SubsystemLock lock(SUBSYSTEM_CRYPTO);
+    TAK_byte_buffer input;
+    input.data = data;
+    input.length = length > 0 ? length : 0;
+    return native_fileProtectorDecrypt(input);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  ReadIntoResponse
+  native_fileProtectorDecryptInto(unsigned char *data, int length, unsigned char *destination, int capacity)
+  {
+    SubsystemLock lock(SUBSYSTEM_CRYPTO);
+    if (destination == NULL || capacity < 0)
     {
-      response.buffer.data = (unsigned char *)malloc(outputValue.length * sizeof(unsigned char));
-      if (response.buffer.data != NULL)
-      {
-        memcpy(response.buffer.data, outputValue.data, outputValue.length);
-        response.buffer.length = outputValue.length;
-      }
+      ReadIntoResponse response = {TAK_INVALID_PARAMETER, 0};
+      return response;
     }
 
-    return response;
+    TAK_byte_buffer input;
+    input.data = data;
+    input.length = length > 0 ? length : 0;
+    TAK_byte_buffer outputValue = {NULL, 0};
+    int32_t returnCode = TakLib_fileProtectorDecrypt(input, &outputValue);
+    return copyIntoCaller(returnCode, &outputValue, destination, capacity);
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
   native_storageCreate(char *storageName)
   {
-    return TakLib_storageCreate(storageName);
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    int32_t returnCode = TakLib_storageCreate(storageName);
+    if (returnCode == TAK_SUCCESS)
+    {
+      storageIndexOpen(storageName, true);
+    }
+    return returnCode;
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
   native_storageDelete(char *storageName)
   {
-    return TakLib_storageDelete(storageName);
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    return storageIndexDeleteStorage(storageName);
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
   native_storageWrite(char *storageName, char *key, unsigned char *value, int valueLength)
   {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
     TAK_byte_buffer valueToStore;
     valueToStore.length = valueLength;
     valueToStore.data = value;
-    return TakLib_storageWrite(storageName, key, valueToStore);
+    return storageIndexWrite(storageName, key, valueToStore);
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   TakByteBufferResponse
   native_storageRead(char *storageName, char *key)
   {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
     TakByteBufferResponse response;
     response.returnCode = TAK_GENERAL_ERROR;
     response.buffer.data = NULL;
     response.buffer.length = 0;
 
-    TAK_byte_buffer readValue;
-    response.returnCode = TakLib_storageRead(storageName, key, &readValue);
-    if (response.returnCode == TAK_SUCCESS)
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = storageIndexRead(storageName, key, &readValue);
+    transferBuffer(&response, &readValue);
+
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  ReadIntoResponse
+  native_storageReadInto(char *storageName, char *key, unsigned char *destination, int capacity)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    if (destination == NULL || capacity < 0)
     {
-      response.buffer.data = (unsigned char *)malloc(readValue.length * sizeof(unsigned char));
-      if (response.buffer.data != NULL)
-      {
-        memcpy(response.buffer.data, readValue.data, readValue.length);
-        response.buffer.length = readValue.length;
-      }
+      ReadIntoResponse response = {TAK_INVALID_PARAMETER, 0};
+      return response;
     }
 
-    return response;
+    TAK_byte_buffer readValue = {NULL, 0};
+    int32_t returnCode = storageIndexRead(storageName, key, &readValue);
+    return copyIntoCaller(returnCode, &readValue, destination, capacity);
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
   native_storageDeleteEntry(char *storageName, char *key)
   {
-    return TakLib_storageDeleteEntry(storageName, key);
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    return storageIndexDeleteEntry(storageName, key);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  StorageOpenResponse
+  native_storageOpen(char *storageName)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    StorageOpenResponse response;
+    response.handle = 0;
+    response.returnCode = storageRegistryOpen(storageName, &(response.handle));
+    if (response.returnCode == TAK_SUCCESS || response.returnCode == TAK_STORAGE_ALREADY_EXISTS)
+    {
+      storageIndexOpen(storageName, response.returnCode == TAK_SUCCESS);
+    }
+
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_storageDeleteByHandle(int32_t handle)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    if (storage == nullptr)
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+    return storageIndexDeleteStorage(storage->name.c_str());
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_storageWriteByHandle(int32_t handle, const unsigned char *key, int keyLength, unsigned char *value, int valueLength)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    StorageKey storageKey(key, keyLength);
+    if (storage == nullptr || storageKey.get() == NULL || valueLength < 0)
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+
+    TAK_byte_buffer valueToStore;
+    valueToStore.length = valueLength;
+    valueToStore.data = value;
+    return storageIndexWrite(storage->name.c_str(), storageKey.get(), valueToStore);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_storageReadByHandle(int32_t handle, const unsigned char *key, int keyLength)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    TakByteBufferResponse response;
+    response.returnCode = TAK_INVALID_PARAMETER;
+    response.buffer.data = NULL;
+    response.buffer.length = 0;
+
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    StorageKey storageKey(key, keyLength);
+    if (storage == nullptr || storageKey.get() == NULL)
+    {
+      return response;
+    }
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = storageIndexRead(storage->name.c_str(), storageKey.get(), &readValue);
+    transferBuffer(&response, &readValue);
+
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  ReadIntoResponse
+  native_storageReadIntoByHandle(int32_t handle, const unsigned char *key, int keyLength, unsigned char *destination,
+                                 int capacity)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    StorageKey storageKey(key, keyLength);
+    if (storage == nullptr || storageKey.get() == NULL || destination == NULL || capacity < 0)
+    {
+      ReadIntoResponse response = {TAK_INVALID_PARAMETER, 0};
+      return response;
+    }
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    int32_t returnCode = storageIndexRead(storage->name.c_str(), storageKey.get(), &readValue);
+    return copyIntoCaller(returnCode, &readValue, destination, capacity);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_storageDeleteEntryByHandle(int32_t handle, const unsigned char *key, int keyLength)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    StorageKey storageKey(key, keyLength);
+    if (storage == nullptr || storageKey.get() == NULL)
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+    return storageIndexDeleteEntry(storage->name.c_str(), storageKey.get());
   }
 
   __attribute__((visibility("default"))) __attribute__((used))
   TlsConnectionResponse
   native_tlsConnectSecurePinning(const char *fqdn, const char *port, unsigned int timeout)
   {
+    TlsConnectionLock lock(TLS_NEW_CONNECTION);
     TlsConnectionResponse response;
     response.socketDescriptor = NULL;
     response.peerCertificate = NULL;
@@ -265,6 +564,9 @@ extern "C"
   int32_t
   native_tlsClose(int socketDescriptor)
   {
+    TlsConnectionLock lock(socketDescriptor);
+    // Pending buffered writes are sent before closing, the connection is closed regardless
+    tlsWriterClose(socketDescriptor);
     return TakLib_tlsClose(socketDescriptor);
   }
 
@@ -272,23 +574,21 @@ extern "C"
   TakByteBufferResponse
   native_tlsReadAll(int socketDescriptor)
   {
+    TlsConnectionLock lock(socketDescriptor);
     TakByteBufferResponse response;
     response.returnCode = TAK_GENERAL_ERROR;
     response.buffer.data = NULL;
     response.buffer.length = 0;
 
     // Read value
-    TAK_byte_buffer readValue;
-    response.returnCode = TakLib_tlsReadAll(socketDescriptor, &readValue);
-    if (response.returnCode == TAK_SUCCESS)
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = tlsWriterBeforeRead(socketDescriptor);
+    if (response.returnCode != TAK_SUCCESS)
     {
-      response.buffer.data = (unsigned char *)malloc(readValue.length * sizeof(unsigned char));
-      if (response.buffer.data != NULL)
-      {
-        memcpy(response.buffer.data, readValue.data, readValue.length);
-        response.buffer.length = readValue.length;
-      }
+      return response;
     }
+    response.returnCode = TakLib_tlsReadAll(socketDescriptor, &readValue);
+    transferBuffer(&response, &readValue);
     return response;
   }
 
@@ -296,6 +596,7 @@ extern "C"
   TakByteBufferResponse
   native_tlsRead(int socketDescriptor, int max)
   {
+    TlsConnectionLock lock(socketDescriptor);
 
     TakByteBufferResponse response;
     response.returnCode = TAK_GENERAL_ERROR;
@@ -303,36 +604,112 @@ extern "C"
     response.buffer.length = 0;
 
     // Read value
-    TAK_byte_buffer readValue;
-    response.returnCode = TakLib_tlsRead(socketDescriptor, &readValue, max);
-    if (response.returnCode == TAK_SUCCESS)
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = tlsWriterBeforeRead(socketDescriptor);
+    if (response.returnCode != TAK_SUCCESS)
     {
-      response.buffer.data = (unsigned char *)malloc(readValue.length * sizeof(unsigned char));
-      if (response.buffer.data != NULL)
-      {
-        memcpy(response.buffer.data, readValue.data, readValue.length);
-        response.buffer.length = readValue.length;
-      }
+      return response;
     }
+    response.returnCode = TakLib_tlsRead(socketDescriptor, &readValue, max);
+    transferBuffer(&response, &readValue);
     return response;
   }
 
+  __attribute__((visibility("default"))) __attribute__((used))
+  ReadIntoResponse
+  native_tlsReadInto(int socketDescriptor, unsigned char *destination, int capacity)
+  {
+    TlsConnectionLock lock(socketDescriptor);
+    // A max of 0 would make TakLib read everything available, which may not fit
+    if (destination == NULL || capacity <= 0)
+    {
+      ReadIntoResponse response = {TAK_INVALID_PARAMETER, 0};
+      return response;
+    }
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    int32_t returnCode = tlsWriterBeforeRead(socketDescriptor);
+    if (returnCode == TAK_SUCCESS)
+    {
+      returnCode = TakLib_tlsRead(socketDescriptor, &readValue, capacity);
+    }
+    return copyIntoCaller(returnCode, &readValue, destination, capacity);
+  }
+
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
   native_tlsWrite(int socketDescriptor, unsigned char *bufferData)
   {
+    TlsConnectionLock lock(socketDescriptor);
 
     // Prepare response
     TAK_byte_buffer valueToWrite;
     valueToWrite.data = bufferData;
     valueToWrite.length = strlen((const char *)bufferData);
 
-    return TakLib_tlsWrite(socketDescriptor, valueToWrite);
+    return tlsWriterWrite(socketDescriptor, &valueToWrite, 1);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_tlsWritev(int socketDescriptor, const TAK_byte_buffer *segments, int count)
+  {
+    TlsConnectionLock lock(socketDescriptor);
+    return tlsWriterWrite(socketDescriptor, segments, count);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_tlsSetWriteBuffer(int socketDescriptor, int bufferSize, int autoFlushThreshold, bool flushBeforeRead)
+  {
+    TlsConnectionLock lock(socketDescriptor);
+    if (bufferSize < 0 || autoFlushThreshold < 0)
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+    return tlsWriterConfigure(socketDescriptor, (size_t)bufferSize, (size_t)autoFlushThreshold, flushBeforeRead);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_tlsFlush(int socketDescriptor)
+  {
+    TlsConnectionLock lock(socketDescriptor);
+    return tlsWriterFlush(socketDescriptor);
   }
 
   __attribute__((visibility("default"))) __attribute__((used)) bool native_tlsIsClosed(int socketDescriptor)
   {
-    return TakLib_tlsIsClosed(socketDescriptor);
+    // Only reads the state of the connection, a pending read or write does not delay it
+    TlsConnectionLock lock(socketDescriptor, false);
+    return tlsWriterHasFailed(socketDescriptor) || TakLib_tlsIsClosed(socketDescriptor);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used)) void native_freeBuffer(void *buffer)
+  {
+    // Pooled blocks go back to the pool, everything else comes from TakLib, which requires free()
+    if (!bufferPoolRelease(buffer))
+    {
+      free(buffer);
+    }
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_configureBufferPool(int64_t capacity)
+  {
+    if (capacity < 0)
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+    return bufferPoolConfigure((size_t)capacity);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  BufferPoolStats
+  native_getBufferPoolStats()
+  {
+    return bufferPoolGetStats();
   }
 
 
@@ -341,33 +718,664 @@ extern "C"
   TakByteBufferResponse
   native_getPinnedCertificate(const char* hostName)
   {
+    TakByteBufferResponse response;
+    response.returnCode = pinnedCertificatesGet(hostName, &response.buffer);
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_updatePinnedCertificates()
+  {
+    int64_t startedAt = startupProfileNow();
+    int32_t returnCode = pinnedCertificatesUpdate();
+    startupProfileRecord(STARTUP_PHASE_UPDATE_PINNED_CERTIFICATES, startedAt, returnCode);
+    return returnCode;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_configurePinnedCertificates(int64_t refreshIntervalMillis)
+  {
+    return pinnedCertificatesConfigure(refreshIntervalMillis);
+  }
+
+  static void takeResponse(AsyncCall *call, TakByteBufferResponse response)
+  {
+    call->returnCode = response.returnCode;
+    call->buffer = response.buffer;
+  }
+
+  static void takeReadIntoResponse(AsyncCall *call, ReadIntoResponse response)
+  {
+    call->returnCode = response.returnCode;
+    call->result = response.length;
+  }
+
+  // Runs on a worker thread, then posts the address of the call to the port of the caller
+  static void runAsyncCall(AsyncCall *call, int64_t port)
+  {
+    switch (call->operation)
+    {
+    case ASYNC_REGISTER:
+      call->returnCode = native_register((char *)call->text);
+      break;
+    case ASYNC_CHECK_INTEGRITY:
+      call->returnCode = native_checkIntegrity();
+      break;
+    case ASYNC_UPDATE_PINNED_CERTIFICATES:
+      call->returnCode = native_updatePinnedCertificates();
+      break;
+    case ASYNC_TLS_CONNECT:
+    {
+      TlsConnectionResponse response = native_tlsConnectSecurePinning(call->text, call->secondText, call->size);
+      call->returnCode = response.returnCode;
+      call->result = response.socketDescriptor;
+      break;
+    }
+    case ASYNC_TLS_READ:
+      takeResponse(call, native_tlsRead(call->handle, call->size));
+      break;
+    case ASYNC_TLS_READ_INTO:
+      takeReadIntoResponse(call, native_tlsReadInto(call->handle, call->data, call->size));
+      break;
+    case ASYNC_TLS_WRITEV:
+      call->returnCode = native_tlsWritev(call->handle, (const TAK_byte_buffer *)call->data, call->size);
+      break;
+    case ASYNC_TLS_FLUSH:
+      call->returnCode = native_tlsFlush(call->handle);
+      break;
+    case ASYNC_STORAGE_READ:
+      takeResponse(call, native_storageReadByHandle(call->handle, (const unsigned char *)call->text,
+                                                    call->text != NULL ? strlen(call->text) : 0));
+      break;
+    case ASYNC_STORAGE_WRITE:
+      call->returnCode = native_storageWriteByHandle(call->handle, (const unsigned char *)call->text,
+                                                     call->text != NULL ? strlen(call->text) : 0,
+                                                     call->data, call->dataLength);
+      break;
+    case ASYNC_STORAGE_DELETE_ENTRY:
+      call->returnCode = native_storageDeleteEntryByHandle(call->handle, (const unsigned char *)call->text,
+                                                           call->text != NULL ? strlen(call->text) : 0);
+      break;
+    case ASYNC_FILE_PROTECTOR_ENCRYPT:
+      takeResponse(call, native_fileProtectorEncryptData(call->data, call->dataLength));
+      break;
+    case ASYNC_FILE_PROTECTOR_DECRYPT:
+      takeResponse(call, native_fileProtectorDecryptData(call->data, call->dataLength));
+      break;
+    case ASYNC_FILE_PROTECTOR_DECRYPT_FROM_FILE:
+      takeResponse(call, native_fileProtectorDecryptFromFile((char *)call->text, (char *)call->secondText));
+      break;
+    }
+
+    if (!dartPortPostInt64(port, (int64_t)(intptr_t)call))
+    {
+      // Nobody is left to take the result, typically the isolate has exited
+      native_freeBuffer(call->buffer.data);
+      call->buffer.data = NULL;
+      call->buffer.length = 0;
+    }
+  }
+
+  static TakSubsystem asyncSubsystem(int32_t operation)
+  {
+    switch (operation)
+    {
+    case ASYNC_TLS_CONNECT:
+    case ASYNC_TLS_READ:
+    case ASYNC_TLS_READ_INTO:
+    case ASYNC_TLS_WRITEV:
+    case ASYNC_TLS_FLUSH:
+      return SUBSYSTEM_TLS;
+    case ASYNC_STORAGE_READ:
+    case ASYNC_STORAGE_WRITE:
+    case ASYNC_STORAGE_DELETE_ENTRY:
+      return SUBSYSTEM_STORAGE;
+    case ASYNC_FILE_PROTECTOR_ENCRYPT:
+    case ASYNC_FILE_PROTECTOR_DECRYPT:
+    case ASYNC_FILE_PROTECTOR_DECRYPT_FROM_FILE:
+      return SUBSYSTEM_CRYPTO;
+    default:
+      return SUBSYSTEM_LIFECYCLE;
+    }
+  }
+
+  static int asyncDefaultLane(int32_t operation)
+  {
+    switch (operation)
+    {
+    case ASYNC_REGISTER:
+    case ASYNC_CHECK_INTEGRITY:
+    case ASYNC_UPDATE_PINNED_CERTIFICATES:
+      return LANE_BACKGROUND;
+    case ASYNC_STORAGE_READ:
+      return LANE_INTERACTIVE;
+    default:
+      return LANE_NORMAL;
+    }
+  }
+
+  struct AsyncJob
+  {
+    AsyncCall *call;
+    int64_t port;
+  };
+
+  static void runAsyncJob(void *argument)
+  {
+    AsyncJob *job = (AsyncJob *)argument;
+    runAsyncCall(job->call, job->port);
+    delete job;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  void
+  native_initializeAsync(void *postCObject)
+  {
+#if defined TARGET_ANDROID
+    // Pool threads attach to the JVM once when they start instead of on their first TakLib call
+    workerPoolSetThreadStartHook(attachCurrentThread);
+#endif
+    dartPortInitialize(postCObject);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_configureWorkerPool(int maxThreads)
+  {
+    return workerPoolConfigure(maxThreads);
+  }
+
+  // Runs the call on the worker pool. Once done, the address of the call is posted to `port`.
+  // Nothing is posted when the call could not be queued.
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_submitAsync(AsyncCall *call, int64_t port)
+  {
+    if (call == NULL || call->operation < ASYNC_REGISTER || call->operation > ASYNC_FILE_PROTECTOR_DECRYPT_FROM_FILE ||
+        call->lane < LANE_DEFAULT || call->lane > LANE_BACKGROUND)
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+    if (!dartPortIsInitialized())
+    {
+      return TAK_GENERAL_ERROR;
+    }
+
+    call->returnCode = TAK_GENERAL_ERROR;
+    call->result = 0;
+    call->buffer.data = NULL;
+    call->buffer.length = 0;
+
+    AsyncJob *job = new (std::nothrow) AsyncJob{call, port};
+    if (job == NULL)
+    {
+      return TAK_OUT_OF_MEMORY;
+    }
+    int lane = call->lane != LANE_DEFAULT ? call->lane : asyncDefaultLane(call->operation);
+    if (!workerPoolSubmit(asyncSubsystem(call->operation), lane, runAsyncJob, job))
+    {
+      delete job;
+      return TAK_GENERAL_ERROR;
+    }
+    return TAK_SUCCESS;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  SchedulerStats
+  native_getSchedulerStats()
+  {
+    return workerPoolGetStats();
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_configurePostureCache(int check, int64_t ttlMillis)
+  {
+    return postureCacheConfigure(check, ttlMillis);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_invalidatePostureCache(int check)
+  {
+    return postureCacheInvalidate(check);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int64_t
+  native_getPostureEvaluatedAt(int check)
+  {
+    return postureCacheEvaluatedAt(check);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_startRuntimeScheduler(int intervalSeconds, int64_t budgetMicros, int64_t windowMillis, int64_t maxGapMillis)
+  {
+    return runtimeSchedulerStart(intervalSeconds, budgetMicros, windowMillis, maxGapMillis);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_stopRuntimeScheduler()
+  {
+    return runtimeSchedulerStop();
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used)) void native_setRuntimeBusy(bool busy)
+  {
+    runtimeSchedulerSetBusy(busy);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  RuntimeSchedulerStats
+  native_getRuntimeSchedulerStats()
+  {
+    return runtimeSchedulerGetStats();
+  }
+
+  // Runs the startup steps of the plan on the worker pool, see startup_pipeline.h.
+  // Nothing is posted when the run could not be started.
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_startStartup(StartupPlan *plan, int64_t port)
+  {
+    return startupPipelineStart(plan, port);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int64_t
+  native_startupClockNanos()
+  {
+    return startupProfileNow();
+  }
+
+  // Records a phase measured outside of the library, from startNanos as read from native_startupClockNanos until now
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_recordStartupPhase(int phase, int64_t startNanos, int32_t returnCode)
+  {
+    return startupProfileRecord(phase, startNanos, returnCode);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  StartupProfile
+  native_getStartupProfile()
+  {
+    return startupProfileGet();
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_writeStartupProfile(const char *path)
+  {
+    return startupProfileWrite(path);
+  }
+
+  // Working path captured when the Android plugin attached, NULL on other platforms or before.
+  // The string is owned by the library and stays valid.
+  __attribute__((visibility("default"))) __attribute__((used)) const char *native_getWorkingPath()
+  {
+#if defined TARGET_ANDROID
+    return getWorkingPath();
+#else
+    return NULL;
+#endif
+  }
+
+  // Opens a pack of protected assets, see asset_pack.h. The handle is written to `handle`.
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_assetPackOpen(char *path, int32_t *handle)
+  {
+    return assetPackOpen(path, handle);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_assetPackClose(int32_t handle)
+  {
+    return assetPackClose(handle);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_assetPackEntryCount(int32_t handle)
+  {
+    return assetPackEntryCount(handle);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_assetPackRead(int32_t handle, char *name)
+  {
+    TakByteBufferResponse response;
+    response.buffer.data = NULL;
+    response.buffer.length = 0;
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = assetPackRead(handle, name, &readValue);
+    transferBuffer(&response, &readValue);
+
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_configureAssetCache(int64_t budgetBytes)
+  {
+    return assetCacheConfigure(budgetBytes);
+  }
+
+  // Decrypts the files into the asset cache in the background, for native_fileProtectorDecryptFromFile.
+  // The names are copied before returning.
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_prefetchAssets(char **fileNames, int count, char *extension)
+  {
+    return assetCachePrefetch(fileNames, count, extension);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  AssetCacheStats
+  native_getAssetCacheStats()
+  {
+    return assetCacheGetStats();
+  }
 
+  // Decrypts a large protected file from a read-only mapping instead of a copy on the heap. The
+  // decrypted buffer is handed over without copying, bypassing the asset cache.
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_fileProtectorDecryptMapped(char *fileName, char *extension)
+  {
     TakByteBufferResponse response;
-    response.returnCode = TAK_GENERAL_ERROR;
     response.buffer.data = NULL;
     response.buffer.length = 0;
- 
-    // Read value
-    char* certificate = NULL;
-    response.returnCode = TakLib_getPinnedCertificate(hostName, &certificate);
-
-    if (response.returnCode == TAK_SUCCESS && certificate != NULL) { 
-        size_t certLen = strlen(certificate); 
-        response.buffer.data = (unsigned char*)malloc(certLen);
-        if (response.buffer.data != NULL) {
-            memcpy(response.buffer.data, certificate, certLen);
-            response.buffer.length = certLen; 
-        } 
-        free(certificate);
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = assetSourceDecryptFile(fileName, extension, &readValue);
+    transferBuffer(&response, &readValue);
+
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  ReadIntoResponse
+  native_fileProtectorDecryptMappedInto(char *fileName, char *extension, unsigned char *destination, int capacity)
+  {
+    if (destination == NULL || capacity < 0)
+    {
+      ReadIntoResponse response = {TAK_INVALID_PARAMETER, 0};
+      return response;
+    }
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    int32_t returnCode = assetSourceDecryptFile(fileName, extension, &readValue);
+    return copyIntoCaller(returnCode, &readValue, destination, capacity);
+  }
+
+  // Batches of storage operations take their keys packed one after another in `keys`, the size of
+  // each of them in `keyLengths`. The storage is locked once for the whole batch.
+  //
+  // Reads return one buffer holding, for each key in order, its return code (int32), the size of
+  // its value (uint32) and the value, in native byte order. Keys that fail have no value.
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_storageReadBatch(int32_t handle, const unsigned char *keys, const int32_t *keyLengths, int count)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    TakByteBufferResponse response;
+    response.returnCode = TAK_INVALID_PARAMETER;
+    response.buffer.data = NULL;
+    response.buffer.length = 0;
+
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    if (storage == nullptr || count < 0 || (count > 0 && (keys == NULL || keyLengths == NULL)))
+    {
+      return response;
+    }
+
+    std::vector<int32_t> returnCodes(count, TAK_INVALID_PARAMETER);
+    std::vector<TAK_byte_buffer> values(count, TAK_byte_buffer{NULL, 0});
+    uint64_t packedLength = (uint64_t)count * 8;
+    const unsigned char *key = keys;
+    for (int i = 0; i < count; i++)
+    {
+      if (keyLengths[i] < 0)
+      {
+        break;
+      }
+      StorageKey storageKey(key, keyLengths[i]);
+      key += keyLengths[i];
+      if (storageKey.get() != NULL)
+      {
+        returnCodes[i] = storageIndexRead(storage->name.c_str(), storageKey.get(), &values[i]);
+      }
+      if (returnCodes[i] == TAK_SUCCESS && values[i].data != NULL)
+      {
+        packedLength += values[i].length;
+      }
+    }
+
+    TAK_byte_buffer packed = {NULL, 0};
+    response.returnCode = packedLength <= UINT32_MAX ? TAK_SUCCESS : TAK_OUT_OF_MEMORY;
+    if (response.returnCode == TAK_SUCCESS && count > 0)
+    {
+      packed.data = (unsigned char *)malloc(packedLength);
+      packed.length = (unsigned int)packedLength;
+      response.returnCode = packed.data != NULL ? TAK_SUCCESS : TAK_OUT_OF_MEMORY;
+    }
+    unsigned char *cursor = packed.data;
+    for (int i = 0; i < count; i++)
+    {
+      uint32_t length = returnCodes[i] == TAK_SUCCESS && values[i].data != NULL ? values[i].length : 0;
+      if (cursor != NULL)
+      {
+        memcpy(cursor, &returnCodes[i], 4);
+        memcpy(cursor + 4, &length, 4);
+        if (length > 0)
+        {
+          memcpy(cursor + 8, values[i].data, length);
+        }
+        cursor += 8 + length;
+      }
+      free(values[i].data);
     }
+    transferBuffer(&response, &packed);
+
     return response;
   }
 
+  // Writes the values packed in `values`, the size of each of them in `valueLengths`, under the
+  // keys of the batch. The return code of each entry is stored in `results`.
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_storageWriteBatch(int32_t handle, const unsigned char *keys, const int32_t *keyLengths,
+                           unsigned char *values, const int32_t *valueLengths, int count, int32_t *results)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    if (storage == nullptr || count < 0 ||
+        (count > 0 && (keys == NULL || keyLengths == NULL || values == NULL || valueLengths == NULL || results == NULL)))
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+
+    // Written together so the index of the storage is persisted once
+    std::vector<std::string> keysToStore;
+    std::vector<const char *> keyPointers(count, NULL);
+    std::vector<TAK_byte_buffer> valuesToStore(count, TAK_byte_buffer{NULL, 0});
+    keysToStore.reserve(count);
+    const unsigned char *key = keys;
+    unsigned char *value = values;
+    for (int i = 0; i < count; i++)
+    {
+      // Sizes locate the next entries, after a negative one the rest of the batch is not written
+      if (keyLengths[i] < 0 || valueLengths[i] < 0)
+      {
+        break;
+      }
+      StorageKey storageKey(key, keyLengths[i]);
+      if (storageKey.get() != NULL)
+      {
+        keysToStore.push_back(storageKey.get());
+        keyPointers[i] = keysToStore.back().c_str();
+        valuesToStore[i].length = valueLengths[i];
+        valuesToStore[i].data = value;
+      }
+      key += keyLengths[i];
+      value += valueLengths[i];
+    }
+    return storageIndexWriteBatch(storage->name.c_str(), keyPointers.data(), valuesToStore.data(), count, results);
+  }
 
+  // Deletes the keys of the batch. The return code of each key is stored in `results`.
   __attribute__((visibility("default"))) __attribute__((used))
   int32_t
-  native_updatePinnedCertificates()
+  native_storageDeleteBatch(int32_t handle, const unsigned char *keys, const int32_t *keyLengths, int count, int32_t *results)
   {
-    return TakLib_updatePinnedCertificates();
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    if (storage == nullptr || count < 0 || (count > 0 && (keys == NULL || keyLengths == NULL || results == NULL)))
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+
+    const unsigned char *key = keys;
+    bool malformed = false;
+    for (int i = 0; i < count; i++)
+    {
+      results[i] = TAK_INVALID_PARAMETER;
+      malformed = malformed || keyLengths[i] < 0;
+      if (malformed)
+      {
+        continue;
+      }
+      StorageKey storageKey(key, keyLengths[i]);
+      if (storageKey.get() != NULL)
+      {
+        results[i] = storageIndexDeleteEntry(storage->name.c_str(), storageKey.get());
+      }
+      key += keyLengths[i];
+    }
+    return TAK_SUCCESS;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_configureStorageCache(int64_t budgetBytes, bool mask)
+  {
+    return storageCacheConfigure(budgetBytes, mask);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  StorageCacheStats
+  native_getStorageCacheStats()
+  {
+    return storageCacheGetStats();
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_configureStorageWriter(int64_t windowMillis)
+  {
+    return storageWriterConfigure(windowMillis);
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_flushStorageWriter()
+  {
+    return storageWriterFlush();
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  StorageWriterStats
+  native_getStorageWriterStats()
+  {
+    return storageWriterGetStats();
+  }
+
+  // Lists the keys of the storage from `start` included to `end` excluded, UTF-8 and empty for no
+  // bound, at most `limit` of them when positive. For each key, the buffer holds its size (uint32,
+  // native byte order) and its bytes, in the order of the bytes.
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_storageListKeys(int32_t handle, const unsigned char *start, int startLength, const unsigned char *end,
+                         int endLength, int limit)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    TakByteBufferResponse response;
+    response.returnCode = TAK_INVALID_PARAMETER;
+    response.buffer.data = NULL;
+    response.buffer.length = 0;
+
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    StorageKey startKey(start, startLength);
+    StorageKey endKey(end, endLength);
+    if (storage == nullptr || (startLength > 0 && startKey.get() == NULL) || (endLength > 0 && endKey.get() == NULL))
+    {
+      return response;
+    }
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = storageIndexList(storage->name.c_str(), startKey.get(), endKey.get(), limit, &readValue);
+    transferBuffer(&response, &readValue);
+
+    return response;
+  }
+
+  // Lists the keys of the storage starting with `prefix`, as native_storageListKeys.
+  __attribute__((visibility("default"))) __attribute__((used))
+  TakByteBufferResponse
+  native_storageScanPrefix(int32_t handle, const unsigned char *prefix, int prefixLength, int limit)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    TakByteBufferResponse response;
+    response.returnCode = TAK_INVALID_PARAMETER;
+    response.buffer.data = NULL;
+    response.buffer.length = 0;
+
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    StorageKey prefixKey(prefix, prefixLength);
+    if (storage == nullptr || (prefixLength > 0 && prefixKey.get() == NULL))
+    {
+      return response;
+    }
+
+    TAK_byte_buffer readValue = {NULL, 0};
+    response.returnCode = storageIndexScanPrefix(storage->name.c_str(), prefixKey.get() != NULL ? prefixKey.get() : "",
+                                                 limit, &readValue);
+    transferBuffer(&response, &readValue);
+
+    return response;
+  }
+
+  __attribute__((visibility("default"))) __attribute__((used))
+  bool
+  native_storageHasCompleteKeyIndex(int32_t handle)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    return storage != nullptr && storageIndexIsComplete(storage->name.c_str());
+  }
+
+  // TAK_SUCCESS when the storage holds the key, TAK_STORAGE_KEY_NOT_FOUND when it does not. Keys
+  // missing from a complete key index are answered without TakLib, the others are read.
+  __attribute__((visibility("default"))) __attribute__((used))
+  int32_t
+  native_storageContains(int32_t handle, const unsigned char *key, int keyLength)
+  {
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    std::shared_ptr<StorageEntry> storage = storageRegistryFind(handle);
+    StorageKey storageKey(key, keyLength);
+    if (storage == nullptr || storageKey.get() == NULL)
+    {
+      return TAK_INVALID_PARAMETER;
+    }
+    return storageIndexContains(storage->name.c_str(), storageKey.get());
   }
 }
@@ -4,6 +4,10 @@
 #include "tak.h"
 #include <stdint.h>
 
+// Returned by the read-into variants when the value does not fit in the memory of the caller.
+// Outside of the ranges used by TakLib, so it is never confused with one of its codes.
+#define TAK_BUFFER_TOO_SMALL            ((int)0x00FF0001)
+
 typedef struct {
     char* takId;
     int returnCode;
@@ -25,9 +29,241 @@ typedef struct {
     TAK_byte_buffer buffer;
 } TakByteBufferResponse;
 
+typedef struct {
+    int32_t returnCode;
+    uint32_t length;
+} ReadIntoResponse;
+
+typedef struct {
+    int32_t handle;
+    int32_t returnCode;
+} StorageOpenResponse;
+
+typedef struct {
+    uint64_t capacity;
+    uint64_t reservedBytes;
+    uint64_t bytesInUse;
+    uint64_t allocations;
+    uint64_t threadCacheHits;
+    uint64_t misses;
+    uint64_t releases;
+} BufferPoolStats;
+
+typedef struct {
+    uint64_t capacity;
+    uint64_t bytesInUse;
+    uint64_t entries;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    // Assets decrypted by a prefetch
+    uint64_t prefetched;
+} AssetCacheStats;
+
+typedef struct {
+    uint64_t capacity;
+    uint64_t bytesInUse;
+    uint64_t entries;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    // Values dropped by a write or a delete
+    uint64_t invalidations;
+} StorageCacheStats;
+
+typedef struct {
+    // 0 when writes are not deferred
+    uint64_t windowMillis;
+    uint64_t pending;
+    uint64_t pendingBytes;
+    // Writes deferred, and among them the ones that replaced a pending value
+    uint64_t writes;
+    uint64_t coalesced;
+    uint64_t flushes;
+    // Values written by the flushes, and among them the ones that failed
+    uint64_t flushed;
+    uint64_t failures;
+} StorageWriterStats;
+
+// Blocking calls that can run on the worker pool, see native_submitAsync
+typedef enum {
+    ASYNC_REGISTER = 1,
+    ASYNC_CHECK_INTEGRITY = 2,
+    ASYNC_UPDATE_PINNED_CERTIFICATES = 3,
+    ASYNC_TLS_CONNECT = 4,
+    ASYNC_TLS_READ = 5,
+    ASYNC_TLS_READ_INTO = 6,
+    ASYNC_TLS_WRITEV = 7,
+    ASYNC_TLS_FLUSH = 8,
+    ASYNC_STORAGE_READ = 9,
+    ASYNC_STORAGE_WRITE = 10,
+    ASYNC_STORAGE_DELETE_ENTRY = 11,
+    ASYNC_FILE_PROTECTOR_ENCRYPT = 12,
+    ASYNC_FILE_PROTECTOR_DECRYPT = 13,
+    ASYNC_FILE_PROTECTOR_DECRYPT_FROM_FILE = 14
+} AsyncOperation;
+
+// Priority of a call run on the worker pool
+typedef enum {
+    // Lane of the operation: interactive for storage reads, background for network bound
+    // lifecycle calls (register, integrity checks, pinned certificate updates), normal otherwise
+    LANE_DEFAULT = 0,
+    LANE_INTERACTIVE = 1,
+    LANE_NORMAL = 2,
+    LANE_BACKGROUND = 3
+} AsyncLane;
+
+// Arguments and results of a call run on the worker pool.
+// Every pointer must stay valid until the completion is posted.
+typedef struct {
+    int32_t operation;
+    // AsyncLane
+    int32_t lane;
+    int32_t returnCode;
+    // Socket descriptor or storage handle
+    int32_t handle;
+    // Read size, capacity of data, segment count or timeout
+    int32_t size;
+    // User hash, fqdn, storage key or file name
+    const char* text;
+    // Port or file extension
+    const char* secondText;
+    // Input data, read destination or segment vector
+    unsigned char* data;
+    uint32_t dataLength;
+    // Socket descriptor of a connection, or number of bytes read
+    int32_t result;
+    // Output buffer, owned by the caller once posted
+    TAK_byte_buffer buffer;
+} AsyncCall;
+
+// Security checks cached by the posture cache
+typedef enum {
+    POSTURE_ROOT_STATUS = 0,
+    POSTURE_ADVANCED_ROOT_STATUS = 1,
+    POSTURE_INTEGRITY = 2,
+    POSTURE_REGISTRATION = 3,
+    POSTURE_CHECK_COUNT = 4,
+    POSTURE_CHECK_ALL = -1
+} PostureCheck;
+
+// Steps of the startup pipeline, see native_startStartup
+typedef enum {
+    STARTUP_INITIALIZE = 0,
+    STARTUP_REGISTER = 1,
+    STARTUP_CHECK_INTEGRITY = 2,
+    STARTUP_UPDATE_PINNED_CERTIFICATES = 3,
+    STARTUP_WARM_STORAGE = 4,
+    STARTUP_PRECONNECT = 5,
+    STARTUP_STEP_COUNT = 6
+} StartupStep;
+
+// Stage a startup step belongs to. Its number is posted once all its steps are done.
+typedef enum {
+    STARTUP_STAGE_NONE = 0,
+    // Time-to-interactive work, run on the interactive lane
+    STARTUP_STAGE_INTERACTIVE = 1,
+    // Work the application can wait for, run on the background lane
+    STARTUP_STAGE_DEFERRED = 2
+} StartupStage;
+
+// Arguments and results of a startup run.
+// Every pointer must stay valid until STARTUP_STAGE_NONE is posted, once the whole run is done.
+typedef struct {
+    // StartupStage of each step, STARTUP_STAGE_NONE to skip it
+    int32_t stages[STARTUP_STEP_COUNT];
+    int32_t returnCodes[STARTUP_STEP_COUNT];
+    // Bit (1 << step) is set for the steps that failed, or were not run because a dependency failed
+    uint32_t failedSteps;
+    char* workingPath;
+    char* license;
+    // May be NULL
+    char* userHash;
+    char** storageNames;
+    int32_t storageCount;
+    // Connections to open, the socket descriptor of each is written to sockets, or -1
+    char** hosts;
+    char** ports;
+    int32_t* sockets;
+    int32_t connectionCount;
+    int32_t connectTimeout;
+} StartupPlan;
+
+typedef struct {
+    uint64_t interactiveQueued;
+    uint64_t normalQueued;
+    uint64_t backgroundQueued;
+    uint64_t peakQueued;
+    uint64_t running;
+    uint64_t threads;
+    uint64_t dispatched;
+    // Jobs that ran before queued jobs of a higher lane, because they had waited long enough
+    uint64_t agedDispatches;
+    uint64_t totalWaitMicros;
+    uint64_t maxWaitMicros;
+} SchedulerStats;
+
+typedef struct {
+    // 1 while the TakLib runtime check thread is running
+    uint64_t active;
+    uint64_t runs;
+    // Times the thread was started while busy or over budget, because the last run was too old
+    uint64_t forcedStarts;
+    // Intervals that elapsed while the checks were deferred
+    uint64_t skippedSlots;
+    // CPU time of the runs
+    uint64_t lastRunMicros;
+    uint64_t maxRunMicros;
+    uint64_t totalRunMicros;
+    // CPU time of the runs in the current budget window
+    uint64_t windowRunMicros;
+    // Distance from the interval between the starts of two consecutive runs
+    uint64_t lastJitterMicros;
+    uint64_t maxJitterMicros;
+    // 1 while the CPU time of the TakLib thread is sampled, 0 when the thread could not be
+    // identified: runs are then not observed and the budget is not enforced
+    uint64_t sampled;
+} RuntimeSchedulerStats;
+
+// Timed phases of the startup, see native_getStartupProfile
+typedef enum {
+    // TakPlugin.initialize, or TakPlugin.start until its interactive stage, measured from Dart
+    STARTUP_PHASE_PLUGIN_INITIALIZE = 0,
+    // Working path lookup through the platform channel, measured from Dart
+    STARTUP_PHASE_LOAD_ENVIRONMENT = 1,
+    // native_initialize, including the wait for the subsystem locks
+    STARTUP_PHASE_INITIALIZE = 2,
+    // TakLib_initialize alone, which loads and validates the license
+    STARTUP_PHASE_LICENSE = 3,
+    STARTUP_PHASE_REGISTER = 4,
+    STARTUP_PHASE_CHECK_INTEGRITY = 5,
+    STARTUP_PHASE_UPDATE_PINNED_CERTIFICATES = 6,
+    STARTUP_PHASE_COUNT = 7
+} StartupPhase;
+
+typedef struct {
+    // Monotonic time since the library was loaded
+    int64_t startNanos;
+    int64_t durationNanos;
+    int32_t returnCode;
+} StartupPhaseTiming;
+
+typedef struct {
+    // First run of each phase in the process, the cold start
+    StartupPhaseTiming first[STARTUP_PHASE_COUNT];
+    // Latest run, a warm start once the library was initialized again
+    StartupPhaseTiming last[STARTUP_PHASE_COUNT];
+    // Runs of each phase, 0 when first and last are not set
+    uint32_t counts[STARTUP_PHASE_COUNT];
+} StartupProfile;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Native methods
 int32_t native_initialize(char *path, char *license);
-void native_release();
+int32_t native_release();
 void native_reset();
 int32_t native_register(char *user);
 IsRegisteredResponse native_isRegistered();
@@ -43,20 +279,80 @@ bool native_isRuntimeThreadActive(bool relaunch);
 TakByteBufferResponse native_fileProtectorDecryptFromFile(char* fileName,char* extension);
 TakByteBufferResponse native_fileProtectorEncrypt(TAK_byte_buffer input);
 TakByteBufferResponse native_fileProtectorDecrypt(TAK_byte_buffer input);
+TakByteBufferResponse native_fileProtectorEncryptData(unsigned char* data, int length);
+TakByteBufferResponse native_fileProtectorDecryptData(unsigned char* data, int length);
+ReadIntoResponse native_fileProtectorDecryptInto(unsigned char* data, int length, unsigned char* destination, int capacity);
 int32_t native_storageCreate(char* storageName);
 int32_t native_storageDelete(char* storageName);
 int32_t native_storageWrite(char* storageName, char* key, unsigned char* value, int valueLength);
 TakByteBufferResponse native_storageRead(char* storageName, char* key);
+StorageOpenResponse native_storageOpen(char* storageName);
+int32_t native_storageDeleteByHandle(int32_t handle);
+int32_t native_storageWriteByHandle(int32_t handle, const unsigned char* key, int keyLength, unsigned char* value, int valueLength);
+TakByteBufferResponse native_storageReadByHandle(int32_t handle, const unsigned char* key, int keyLength);
+ReadIntoResponse native_storageReadIntoByHandle(int32_t handle, const unsigned char* key, int keyLength, unsigned char* destination, int capacity);
+int32_t native_storageDeleteEntryByHandle(int32_t handle, const unsigned char* key, int keyLength);
+ReadIntoResponse native_storageReadInto(char* storageName, char* key, unsigned char* destination, int capacity);
 TlsConnectionResponse native_tlsConnectSecurePinning(const char *fqdn, const char *port, unsigned int timeout);
 int native_tlsClose(int socketDescriptor);
 TakByteBufferResponse native_tlsReadAll(int socketDescriptor);
 TakByteBufferResponse native_tlsRead(int socketDescriptor, int length);
+ReadIntoResponse native_tlsReadInto(int socketDescriptor, unsigned char* destination, int capacity);
 int32_t native_tlsWrite(int socketDescriptor,unsigned char* bufferData);
+int32_t native_tlsWritev(int socketDescriptor, const TAK_byte_buffer* segments, int count);
+int32_t native_tlsSetWriteBuffer(int socketDescriptor, int bufferSize, int autoFlushThreshold, bool flushBeforeRead);
+int32_t native_tlsFlush(int socketDescriptor);
 bool native_tlsIsClosed(int socketDescriptor);
 int32_t native_tlsClose(int socketDescriptor);
+void native_freeBuffer(void* buffer);
+int32_t native_configureBufferPool(int64_t capacity);
+BufferPoolStats native_getBufferPoolStats();
+void native_initializeAsync(void* postCObject);
+int32_t native_configureWorkerPool(int maxThreads);
+int32_t native_submitAsync(AsyncCall* call, int64_t port);
+SchedulerStats native_getSchedulerStats();
+int32_t native_configurePostureCache(int check, int64_t ttlMillis);
+int32_t native_invalidatePostureCache(int check);
+int64_t native_getPostureEvaluatedAt(int check);
+int32_t native_startRuntimeScheduler(int intervalSeconds, int64_t budgetMicros, int64_t windowMillis, int64_t maxGapMillis);
+int32_t native_stopRuntimeScheduler();
+void native_setRuntimeBusy(bool busy);
+RuntimeSchedulerStats native_getRuntimeSchedulerStats();
+int32_t native_startStartup(StartupPlan* plan, int64_t port);
+int64_t native_startupClockNanos();
+int32_t native_recordStartupPhase(int phase, int64_t startNanos, int32_t returnCode);
+StartupProfile native_getStartupProfile();
+int32_t native_writeStartupProfile(const char* path);
+const char* native_getWorkingPath();
+int32_t native_assetPackOpen(char* path, int32_t* handle);
+int32_t native_assetPackClose(int32_t handle);
+int32_t native_assetPackEntryCount(int32_t handle);
+TakByteBufferResponse native_assetPackRead(int32_t handle, char* name);
+int32_t native_configureAssetCache(int64_t budgetBytes);
+int32_t native_prefetchAssets(char** fileNames, int count, char* extension);
+AssetCacheStats native_getAssetCacheStats();
+TakByteBufferResponse native_fileProtectorDecryptMapped(char* fileName, char* extension);
+ReadIntoResponse native_fileProtectorDecryptMappedInto(char* fileName, char* extension, unsigned char* destination, int capacity);
+TakByteBufferResponse native_storageReadBatch(int32_t handle, const unsigned char* keys, const int32_t* keyLengths, int count);
+int32_t native_storageWriteBatch(int32_t handle, const unsigned char* keys, const int32_t* keyLengths, unsigned char* values, const int32_t* valueLengths, int count, int32_t* results);
+int32_t native_storageDeleteBatch(int32_t handle, const unsigned char* keys, const int32_t* keyLengths, int count, int32_t* results);
+int32_t native_configureStorageCache(int64_t budgetBytes, bool mask);
+StorageCacheStats native_getStorageCacheStats();
+int32_t native_configureStorageWriter(int64_t windowMillis);
+int32_t native_flushStorageWriter();
+StorageWriterStats native_getStorageWriterStats();
+TakByteBufferResponse native_storageListKeys(int32_t handle, const unsigned char* start, int startLength, const unsigned char* end, int endLength, int limit);
+TakByteBufferResponse native_storageScanPrefix(int32_t handle, const unsigned char* prefix, int prefixLength, int limit);
+bool native_storageHasCompleteKeyIndex(int32_t handle);
+int32_t native_storageContains(int32_t handle, const unsigned char* key, int keyLength);
 
 // VASS
 TakByteBufferResponse native_getPinnedCertificate(const char* hostName);
 int native_updatePinnedCertificates();
+int32_t native_configurePinnedCertificates(int64_t refreshIntervalMillis);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // #ifdef NATIVE_TAK_HEADER
@@ -0,0 +1,234 @@
+#include "pinned_certificates.h"
+#include "buffer_pool.h"
+#include "subsystem_lock.h"
+#include "worker_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static const int64_t kDefaultRefreshIntervalMillis = 12 * 60 * 60 * 1000LL;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Snapshot {
+    std::unordered_map<std::string, std::string> certificates;
+    // Time of the update the certificates were fetched after
+    Clock::time_point updatedAt;
+};
+
+struct PinnedCertificates {
+    std::atomic<Snapshot*> current;
+    // Lookups in progress, a replaced snapshot is freed once none is seen
+    std::atomic<int> readers;
+    std::atomic<int64_t> refreshIntervalMillis;
+    std::atomic<bool> refreshQueued;
+    // Bumped when cleared, certificates fetched before are not published
+    std::atomic<uint64_t> generation;
+    // Bumped by every successful update, under the lifecycle lock
+    std::atomic<uint64_t> updates;
+
+    // Publishing of snapshots
+    std::mutex publishMutex;
+    std::vector<Snapshot*> retired;
+
+    // Single flight of the updates
+    std::mutex updateMutex;
+    std::condition_variable updated;
+    bool inFlight = false;
+    uint64_t completedFlights = 0;
+    int32_t lastResult = TAK_SUCCESS;
+
+    PinnedCertificates()
+        : current(new Snapshot{{}, Clock::now()}), readers(0), refreshIntervalMillis(kDefaultRefreshIntervalMillis),
+          refreshQueued(false), generation(0), updates(0) {}
+};
+
+// Never destroyed: background updates may still run while static destructors run at exit
+static PinnedCertificates& pinned() {
+    static PinnedCertificates* instance = new PinnedCertificates();
+    return *instance;
+}
+
+// Must be called with the publish mutex held
+static void publish(PinnedCertificates& state, Snapshot* snapshot) {
+    state.retired.push_back(state.current.exchange(snapshot));
+    // A lookup that starts after the exchange reads the new snapshot
+    if (state.readers.load() == 0) {
+        for (Snapshot* retired : state.retired) {
+            delete retired;
+        }
+        state.retired.clear();
+    }
+}
+
+// Returns the PEM of the certificate, or the return code of TakLib. Must be called with the lifecycle lock held.
+static int32_t fetchCertificate(const char* hostName, std::string* pem) {
+    char* certificate = NULL;
+    int32_t returnCode = TakLib_getPinnedCertificate(hostName, &certificate);
+    if (returnCode == TAK_SUCCESS && certificate != NULL) {
+        pem->assign(certificate);
+    } else if (returnCode == TAK_SUCCESS) {
+        returnCode = TAK_GENERAL_ERROR;
+    }
+    if (certificate != NULL) {
+        free(certificate);
+    }
+    return returnCode;
+}
+
+static int32_t copyCertificate(const std::string& pem, TAK_byte_buffer* certificate) {
+    unsigned char* data = bufferPoolAllocate(pem.size());
+    if (data == NULL) {
+        data = (unsigned char*) malloc(pem.size() > 0 ? pem.size() : 1);
+    }
+    if (data == NULL) {
+        return TAK_OUT_OF_MEMORY;
+    }
+    memcpy(data, pem.data(), pem.size());
+    certificate->data = data;
+    certificate->length = pem.size();
+    return TAK_SUCCESS;
+}
+
+static int32_t updateCertificates(PinnedCertificates& state) {
+    uint64_t generation = state.generation.load();
+    std::vector<std::string> hostNames;
+    state.readers++;
+    for (const auto& entry : state.current.load()->certificates) {
+        hostNames.push_back(entry.first);
+    }
+    state.readers--;
+
+    Snapshot* snapshot = new Snapshot();
+    int32_t returnCode;
+    {
+        SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+        returnCode = TakLib_updatePinnedCertificates();
+        if (returnCode != TAK_SUCCESS) {
+            delete snapshot;
+            return returnCode;
+        }
+        state.updates++;
+        snapshot->updatedAt = Clock::now();
+        // Hostnames that have no certificate anymore are dropped
+        for (const std::string& hostName : hostNames) {
+            std::string pem;
+            if (fetchCertificate(hostName.c_str(), &pem) == TAK_SUCCESS) {
+                snapshot->certificates.emplace(hostName, std::move(pem));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(state.publishMutex);
+    if (generation != state.generation.load()) {
+        delete snapshot;
+        return returnCode;
+    }
+    publish(state, snapshot);
+    return returnCode;
+}
+
+static void refreshCertificates(void*) {
+    PinnedCertificates& state = pinned();
+    pinnedCertificatesUpdate();
+    state.refreshQueued = false;
+}
+
+extern "C" {
+
+    int32_t pinnedCertificatesGet(const char* hostName, TAK_byte_buffer* certificate) {
+        if (hostName == NULL || certificate == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        certificate->data = NULL;
+        certificate->length = 0;
+        PinnedCertificates& state = pinned();
+
+        state.readers++;
+        Snapshot* snapshot = state.current.load();
+        auto found = snapshot->certificates.find(hostName);
+        int32_t returnCode = TAK_GENERAL_ERROR;
+        bool hit = found != snapshot->certificates.end();
+        if (hit) {
+            returnCode = copyCertificate(found->second, certificate);
+        }
+        Clock::time_point updatedAt = snapshot->updatedAt;
+        state.readers--;
+
+        int64_t refreshIntervalMillis = state.refreshIntervalMillis.load();
+        if (refreshIntervalMillis > 0 && Clock::now() - updatedAt >= std::chrono::milliseconds(refreshIntervalMillis) &&
+            !state.refreshQueued.exchange(true)) {
+            if (!workerPoolSubmit(SUBSYSTEM_LIFECYCLE, LANE_BACKGROUND, refreshCertificates, NULL)) {
+                state.refreshQueued = false;
+            }
+        }
+        if (hit) {
+            return returnCode;
+        }
+
+        uint64_t generation = state.generation.load();
+        uint64_t updates;
+        std::string pem;
+        {
+            SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+            updates = state.updates.load();
+            returnCode = fetchCertificate(hostName, &pem);
+        }
+        if (returnCode != TAK_SUCCESS) {
+            return returnCode;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.publishMutex);
+            // An update that completed meanwhile may have changed the certificate, the next lookup fetches it again
+            if (generation == state.generation.load() && updates == state.updates.load()) {
+                Snapshot* current = state.current.load();
+                Snapshot* next = new Snapshot(*current);
+                next->certificates[hostName] = pem;
+                publish(state, next);
+            }
+        }
+        return copyCertificate(pem, certificate);
+    }
+
+    int32_t pinnedCertificatesUpdate(void) {
+        PinnedCertificates& state = pinned();
+        std::unique_lock<std::mutex> lock(state.updateMutex);
+        if (state.inFlight) {
+            uint64_t flight = state.completedFlights;
+            state.updated.wait(lock, [&state, flight] { return state.completedFlights != flight; });
+            return state.lastResult;
+        }
+        state.inFlight = true;
+        lock.unlock();
+        int32_t returnCode = updateCertificates(state);
+        lock.lock();
+        state.inFlight = false;
+        state.completedFlights++;
+        state.lastResult = returnCode;
+        state.updated.notify_all();
+        return returnCode;
+    }
+
+    int32_t pinnedCertificatesConfigure(int64_t refreshIntervalMillis) {
+        if (refreshIntervalMillis < 0) {
+            return TAK_INVALID_PARAMETER;
+        }
+        pinned().refreshIntervalMillis = refreshIntervalMillis;
+        return TAK_SUCCESS;
+    }
+
+    void pinnedCertificatesClear(void) {
+        PinnedCertificates& state = pinned();
+        std::lock_guard<std::mutex> lock(state.publishMutex);
+        state.generation++;
+        publish(state, new Snapshot{{}, Clock::now()});
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef PINNED_CERTIFICATES_HEADER
+#define PINNED_CERTIFICATES_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Cache of the pinned certificates, by hostname.
+//
+// Lookups read an immutable snapshot without taking any lock, TakLib is only called for the first
+// lookup of a hostname. Updates fetch the certificates again and swap in a new snapshot, readers
+// keep the previous one until they are done with it. Concurrent update requests share a single
+// TakLib_updatePinnedCertificates. Once the snapshot is older than the refresh interval, the next
+// lookup queues an update in the background and is still served from the current snapshot.
+extern "C" {
+    // Copies the PEM of the certificate, without terminator, into a buffer to release with native_freeBuffer.
+    int32_t pinnedCertificatesGet(const char* hostName, TAK_byte_buffer* certificate);
+    // Updates the certificates, or waits for the update in flight. Blocks for a network round trip.
+    int32_t pinnedCertificatesUpdate(void);
+    // A refreshIntervalMillis of 0 disables background updates.
+    int32_t pinnedCertificatesConfigure(int64_t refreshIntervalMillis);
+    // Forgets every certificate, for when TakLib is initialized, reset or released.
+    void pinnedCertificatesClear(void);
+}
+#endif // PINNED_CERTIFICATES_HEADER
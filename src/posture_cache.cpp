@@ -0,0 +1,148 @@
+#include "posture_cache.h"
+#include "worker_pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// Caching is opt-in: a cached verdict hides a change of the device until it expires
+static const int64_t kDefaultTtlMillis = 0;
+
+typedef std::chrono::steady_clock Clock;
+
+struct PostureEntry {
+    PostureEvaluator evaluate = NULL;
+    int64_t ttlMillis = kDefaultTtlMillis;
+    bool cached = false;
+    PostureResult result = {0, TAK_GENERAL_ERROR};
+    Clock::time_point cachedAt;
+    int64_t evaluatedAtMillis = 0;
+    bool inFlight = false;
+    bool refreshQueued = false;
+    // Generation the evaluation in flight started in
+    uint64_t flightGeneration = 0;
+    uint64_t completedFlights = 0;
+    // Result of the last evaluation, shared with the callers that waited for it
+    PostureResult lastResult = {0, TAK_GENERAL_ERROR};
+    // Bumped on invalidation, an evaluation started before is not cached
+    uint64_t generation = 0;
+};
+
+struct PostureCache {
+    std::mutex mutex;
+    std::condition_variable evaluated;
+    PostureEntry entries[POSTURE_CHECK_COUNT];
+};
+
+// Never destroyed: background refreshes may still run while static destructors run at exit
+static PostureCache& cache() {
+    static PostureCache* instance = new PostureCache();
+    return *instance;
+}
+
+// Errors, network ones in particular, are worth evaluating again on the next call. So are the
+// warnings of a successful integrity check: a re-registration or a license about to expire is
+// reported to the caller that triggered it, later callers get the code of their own evaluation.
+static bool isCacheable(int32_t returnCode) {
+    return returnCode == TAK_SUCCESS;
+}
+
+// Evaluates the check, the lock is released meanwhile
+static PostureResult evaluateEntry(PostureCache& state, std::unique_lock<std::mutex>& lock, PostureCheck check) {
+    PostureEntry& entry = state.entries[check];
+    PostureEvaluator evaluate = entry.evaluate;
+    uint64_t generation = entry.generation;
+    entry.inFlight = true;
+    entry.flightGeneration = generation;
+
+    lock.unlock();
+    PostureResult result = evaluate();
+    lock.lock();
+
+    entry.inFlight = false;
+    entry.completedFlights++;
+    entry.lastResult = result;
+    entry.evaluatedAtMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (generation == entry.generation && isCacheable(result.returnCode)) {
+        entry.cached = true;
+        entry.result = result;
+        entry.cachedAt = Clock::now();
+    }
+    state.evaluated.notify_all();
+    return result;
+}
+
+static void refreshEntry(void* argument) {
+    PostureCheck check = (PostureCheck) (intptr_t) argument;
+    PostureCache& state = cache();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    PostureEntry& entry = state.entries[check];
+    entry.refreshQueued = false;
+    // A caller may have evaluated it meanwhile
+    if (!entry.inFlight) {
+        evaluateEntry(state, lock, check);
+    }
+}
+
+PostureResult postureCacheGet(PostureCheck check, PostureEvaluator evaluate) {
+    PostureCache& state = cache();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    PostureEntry& entry = state.entries[check];
+    entry.evaluate = evaluate;
+
+    if (entry.cached && entry.ttlMillis > 0) {
+        int64_t ageMillis = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - entry.cachedAt).count();
+        if (ageMillis < entry.ttlMillis) {
+            if (ageMillis >= entry.ttlMillis * 4 / 5 && !entry.refreshQueued && !entry.inFlight) {
+                entry.refreshQueued = workerPoolSubmit(SUBSYSTEM_LIFECYCLE, LANE_BACKGROUND, refreshEntry, (void*) (intptr_t) check);
+            }
+            return entry.result;
+        }
+    }
+
+    while (entry.inFlight) {
+        // An evaluation started before an invalidation is not joined, its result may be outdated
+        if (entry.flightGeneration == entry.generation) {
+            uint64_t flight = entry.completedFlights;
+            state.evaluated.wait(lock, [&entry, flight] { return entry.completedFlights != flight; });
+            return entry.lastResult;
+        }
+        state.evaluated.wait(lock, [&entry] { return !entry.inFlight; });
+    }
+    return evaluateEntry(state, lock, check);
+}
+
+int32_t postureCacheConfigure(int check, int64_t ttlMillis) {
+    if (check < 0 || check >= POSTURE_CHECK_COUNT || ttlMillis < 0) {
+        return TAK_INVALID_PARAMETER;
+    }
+    PostureCache& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.entries[check].ttlMillis = ttlMillis;
+    return TAK_SUCCESS;
+}
+
+int32_t postureCacheInvalidate(int check) {
+    if (check != POSTURE_CHECK_ALL && (check < 0 || check >= POSTURE_CHECK_COUNT)) {
+        return TAK_INVALID_PARAMETER;
+    }
+    PostureCache& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (int i = 0; i < POSTURE_CHECK_COUNT; i++) {
+        if (check == POSTURE_CHECK_ALL || check == i) {
+            state.entries[i].cached = false;
+            state.entries[i].generation++;
+        }
+    }
+    return TAK_SUCCESS;
+}
+
+int64_t postureCacheEvaluatedAt(int check) {
+    if (check < 0 || check >= POSTURE_CHECK_COUNT) {
+        return 0;
+    }
+    PostureCache& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.entries[check].evaluatedAtMillis;
+}
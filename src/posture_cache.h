@@ -0,0 +1,28 @@
+#ifndef POSTURE_CACHE_HEADER
+#define POSTURE_CACHE_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Cache of the security checks that are expensive to evaluate: root detection scans the installed
+// packages and the integrity check is a server round trip.
+//
+// A result is reused until its TTL expires. Past 80% of the TTL it is still returned, and a
+// refresh starts in the background. Concurrent callers of a check that is being evaluated wait
+// for that evaluation instead of starting their own. Only successful results are cached, with
+// the code TakLib returned. The TTL defaults to 0, which disables caching, concurrent callers
+// still share one evaluation.
+struct PostureResult {
+    int64_t value;
+    int32_t returnCode;
+};
+
+typedef PostureResult (*PostureEvaluator)(void);
+
+PostureResult postureCacheGet(PostureCheck check, PostureEvaluator evaluate);
+int32_t postureCacheConfigure(int check, int64_t ttlMillis);
+// POSTURE_CHECK_ALL invalidates every check. Evaluations in flight are not cached.
+int32_t postureCacheInvalidate(int check);
+// Wall clock time of the last evaluation in milliseconds since the epoch, 0 if never evaluated.
+int64_t postureCacheEvaluatedAt(int check);
+#endif // POSTURE_CACHE_HEADER
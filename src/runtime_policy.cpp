@@ -0,0 +1,114 @@
+#include "runtime_policy.h"
+
+void runtimePolicyReset(RuntimePolicy* policy, bool sampled, RuntimeClock::time_point now) {
+    *policy = RuntimePolicy();
+    policy->lastRunAt = now;
+    policy->windowStart = now;
+    policy->retryAt = now;
+    runtimePolicyThreadStarted(policy, sampled, now);
+}
+
+void runtimePolicyThreadStarted(RuntimePolicy* policy, bool sampled, RuntimeClock::time_point now) {
+    policy->threadActive = true;
+    policy->sampled = sampled;
+    policy->threadStartedAt = now;
+    policy->restarted = true;
+    policy->lastCpuMicros = 0;
+    policy->inRun = false;
+    policy->stats.active = 1;
+    policy->stats.sampled = sampled ? 1 : 0;
+    if (policy->forcing) {
+        policy->stats.forcedStarts++;
+    }
+}
+
+void runtimePolicyStartFailed(RuntimePolicy* policy, RuntimeClock::time_point now) {
+    policy->retryAt = now + kRuntimeRetryPeriod;
+}
+
+void runtimePolicyThreadStopped(RuntimePolicy* policy, const RuntimePolicyConfig& config, RuntimeClock::time_point now) {
+    policy->threadActive = false;
+    policy->sampled = false;
+    policy->inRun = false;
+    policy->stats.active = 0;
+    policy->stats.sampled = 0;
+    policy->nextSkippedSlot = now + config.interval;
+}
+
+static void sample(RuntimePolicy* policy, const RuntimePolicyConfig& config, bool available, uint64_t cpuMicros,
+                   RuntimeClock::time_point now) {
+    RuntimeSchedulerStats& stats = policy->stats;
+    if (policy->sampled && !available) {
+        // TakLib ended or replaced its thread
+        policy->sampled = false;
+        policy->inRun = false;
+        stats.sampled = 0;
+    }
+    if (!policy->sampled) {
+        // Without samples the checks are assumed to run every interval
+        if (now - policy->threadStartedAt >= config.interval) {
+            policy->lastRunAt = now;
+        }
+        return;
+    }
+
+    if (cpuMicros - policy->lastCpuMicros > kRuntimeRunningCpuMicros) {
+        if (!policy->inRun) {
+            policy->inRun = true;
+            policy->runStartCpuMicros = policy->lastCpuMicros;
+            if (policy->hasRunStart && !policy->restarted) {
+                int64_t jitterMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - policy->lastRunStart - config.interval).count();
+                stats.lastJitterMicros = jitterMicros < 0 ? -jitterMicros : jitterMicros;
+                if (stats.lastJitterMicros > stats.maxJitterMicros) {
+                    stats.maxJitterMicros = stats.lastJitterMicros;
+                }
+            }
+            policy->hasRunStart = true;
+            policy->restarted = false;
+            policy->lastRunStart = now;
+        }
+    } else if (policy->inRun) {
+        policy->inRun = false;
+        uint64_t runMicros = cpuMicros - policy->runStartCpuMicros;
+        stats.runs++;
+        stats.lastRunMicros = runMicros;
+        stats.totalRunMicros += runMicros;
+        stats.windowRunMicros += runMicros;
+        if (runMicros > stats.maxRunMicros) {
+            stats.maxRunMicros = runMicros;
+        }
+        policy->lastRunAt = now;
+    }
+    policy->lastCpuMicros = cpuMicros;
+}
+
+RuntimeAction runtimePolicyStep(RuntimePolicy* policy, const RuntimePolicyConfig& config, bool busy, bool available,
+                                uint64_t cpuMicros, RuntimeClock::time_point now) {
+    if (now - policy->windowStart >= config.window) {
+        policy->windowStart = now;
+        policy->stats.windowRunMicros = 0;
+    }
+    if (policy->threadActive) {
+        sample(policy, config, available, cpuMicros, now);
+    }
+
+    bool overdue = now - policy->lastRunAt >= config.maxGap;
+    bool overBudget = config.budgetMicros > 0 && policy->stats.windowRunMicros >= config.budgetMicros;
+    bool deferred = busy || overBudget;
+    policy->forcing = false;
+    if (policy->threadActive && deferred && !overdue && !policy->inRun) {
+        return RUNTIME_STOP_THREAD;
+    }
+    if (!policy->threadActive && (!deferred || overdue) && now >= policy->retryAt) {
+        policy->forcing = deferred;
+        return RUNTIME_START_THREAD;
+    }
+    if (!policy->threadActive) {
+        while (now >= policy->nextSkippedSlot) {
+            policy->stats.skippedSlots++;
+            policy->nextSkippedSlot += config.interval;
+        }
+    }
+    return RUNTIME_KEEP;
+}
@@ -0,0 +1,68 @@
+#ifndef RUNTIME_POLICY_HEADER
+#define RUNTIME_POLICY_HEADER
+
+#include <chrono>
+#include <stdint.h>
+#include "native_tak.h"
+
+// Decisions of the runtime scheduler, kept apart from the threads and TakLib so they can be
+// driven with synthetic samples and times.
+//
+// Every sample period the scheduler hands the CPU time of the TakLib thread to runtimePolicyStep,
+// which tells whether to stop or start that thread.
+typedef std::chrono::steady_clock RuntimeClock;
+
+// CPU time over a sample above which the TakLib thread is running checks, below it only wakes up to wait again
+static const uint64_t kRuntimeRunningCpuMicros = 1000;
+// How long to wait before starting the TakLib thread again when it failed to start
+static const std::chrono::milliseconds kRuntimeRetryPeriod(1000);
+
+struct RuntimePolicyConfig {
+    RuntimeClock::duration interval;
+    RuntimeClock::duration window;
+    RuntimeClock::duration maxGap;
+    // 0 disables the budget
+    uint64_t budgetMicros;
+};
+
+struct RuntimePolicy {
+    bool threadActive = false;
+    // Whether the CPU time of the TakLib thread can be sampled
+    bool sampled = false;
+    RuntimeClock::time_point threadStartedAt;
+    // Whether the thread was started again since the last run, the next run is not on its interval then
+    bool restarted = false;
+    uint64_t lastCpuMicros = 0;
+    bool inRun = false;
+    uint64_t runStartCpuMicros = 0;
+    bool hasRunStart = false;
+    RuntimeClock::time_point lastRunStart;
+    // End of the last run, or when the checks were known to be covered
+    RuntimeClock::time_point lastRunAt;
+    RuntimeClock::time_point windowStart;
+    RuntimeClock::time_point nextSkippedSlot;
+    RuntimeClock::time_point retryAt;
+    // Whether the start being decided overrides the busy hint or the budget
+    bool forcing = false;
+
+    RuntimeSchedulerStats stats = {};
+};
+
+enum RuntimeAction {
+    RUNTIME_KEEP,
+    RUNTIME_STOP_THREAD,
+    RUNTIME_START_THREAD
+};
+
+// Starts over with a TakLib thread already running.
+void runtimePolicyReset(RuntimePolicy* policy, bool sampled, RuntimeClock::time_point now);
+// One sample period. `available` tells whether cpuMicros holds the CPU time of the TakLib thread:
+// without it the thread is gone or was never identified, and it is then assumed to run every
+// interval. Returns what to do with the thread, whose outcome is reported by the calls below.
+RuntimeAction runtimePolicyStep(RuntimePolicy* policy, const RuntimePolicyConfig& config, bool busy, bool available,
+                                uint64_t cpuMicros, RuntimeClock::time_point now);
+// `sampled` tells whether the CPU time of the new thread can be sampled.
+void runtimePolicyThreadStarted(RuntimePolicy* policy, bool sampled, RuntimeClock::time_point now);
+void runtimePolicyStartFailed(RuntimePolicy* policy, RuntimeClock::time_point now);
+void runtimePolicyThreadStopped(RuntimePolicy* policy, const RuntimePolicyConfig& config, RuntimeClock::time_point now);
+#endif // RUNTIME_POLICY_HEADER
@@ -0,0 +1,290 @@
+#include "runtime_scheduler.h"
+#include "runtime_policy.h"
+#include "subsystem_lock.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <pthread.h>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined __linux__
+#include <dirent.h>
+#endif
+#if defined TARGET_ANDROID
+#include "environmentProvider.h"
+#endif
+
+// How often the TakLib thread is sampled, run starts and ends are seen at most this late
+static const std::chrono::milliseconds kSamplePeriod(100);
+static const int64_t kDefaultWindowMillis = 60 * 1000;
+static const int kDefaultMaxGapIntervals = 4;
+
+typedef RuntimeClock Clock;
+
+// A thread of the process. Thread ids are reused, its start time tells it apart from a later
+// thread with the same id.
+struct ThreadIdentity {
+    long id = 0;
+    unsigned long long startTicks = 0;
+};
+
+struct Scheduler {
+    // Serializes start and stop
+    std::mutex controlMutex;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool running = false;
+    bool stopRequested = false;
+    int32_t stopReturnCode = TAK_SUCCESS;
+    bool busy = false;
+
+    int intervalSeconds = 0;
+    RuntimePolicyConfig config = {};
+    RuntimePolicy policy;
+    // TakLib thread, with an id of 0 when it could not be identified
+    ThreadIdentity thread;
+};
+
+// Never destroyed: the controller thread may still use it while static destructors run at exit
+static Scheduler& scheduler() {
+    static Scheduler* instance = new Scheduler();
+    return *instance;
+}
+
+#if defined __linux__
+static void listThreads(std::set<long>* threads) {
+    DIR* directory = opendir("/proc/self/task");
+    if (directory == NULL) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL) {
+        char* end;
+        long id = strtol(entry->d_name, &end, 10);
+        if (end != entry->d_name && *end == '\0') {
+            threads->insert(id);
+        }
+    }
+    closedir(directory);
+}
+
+static bool readThreadFile(long thread, const char* name, char* buffer, size_t size) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%ld/%s", thread, name);
+    FILE* file = fopen(path, "re");
+    if (file == NULL) {
+        return false;
+    }
+    size_t length = fread(buffer, 1, size - 1, file);
+    fclose(file);
+    buffer[length] = '\0';
+    return length > 0;
+}
+
+// Reads the start time and the user and system CPU time of a thread, in clock ticks, from
+// /proc/self/task/<id>/stat (see proc(5)). Its name may contain anything, fields follow its last ')'.
+static bool readThreadStat(long thread, unsigned long long* startTicks, unsigned long long* cpuTicks) {
+    char stat[512];
+    if (!readThreadFile(thread, "stat", stat, sizeof(stat))) {
+        return false;
+    }
+    const char* fields = strrchr(stat, ')');
+    unsigned long long userTicks;
+    unsigned long long systemTicks;
+    // Fields 14, 15 and 22: utime, stime and starttime
+    if (fields == NULL ||
+        sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %*d %*d %llu",
+               &userTicks, &systemTicks, startTicks) != 3) {
+        return false;
+    }
+    *cpuTicks = userTicks + systemTicks;
+    return true;
+}
+
+// CPU time of the thread, false once it has exited, even if its id was reused meanwhile
+static bool threadCpuMicros(const ThreadIdentity& thread, uint64_t* micros) {
+    // Nanoseconds on the CPU, when the kernel keeps scheduler statistics
+    char schedstat[128];
+    unsigned long long runNanos;
+    bool precise = readThreadFile(thread.id, "schedstat", schedstat, sizeof(schedstat)) &&
+                   sscanf(schedstat, "%llu", &runNanos) == 1;
+    // Read after schedstat, so the id still belonged to the thread when it was read
+    unsigned long long startTicks;
+    unsigned long long cpuTicks;
+    if (!readThreadStat(thread.id, &startTicks, &cpuTicks) || startTicks != thread.startTicks) {
+        return false;
+    }
+    if (precise) {
+        *micros = runNanos / 1000;
+    } else {
+        *micros = cpuTicks * 1000000 / (unsigned long long) sysconf(_SC_CLK_TCK);
+    }
+    return true;
+}
+#else
+static bool threadCpuMicros(const ThreadIdentity&, uint64_t*) {
+    return false;
+}
+#endif
+
+// Starts the TakLib thread and identifies it. It is left unidentified, with an id of 0, when
+// other threads started meanwhile or it already exited.
+static int32_t startRuntimeThread(int intervalSeconds, ThreadIdentity* thread) {
+    *thread = ThreadIdentity();
+#if defined __linux__
+    std::set<long> before;
+    listThreads(&before);
+#endif
+    int32_t returnCode;
+    {
+        SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+        returnCode = TakLib_createRuntimeCheckThread(intervalSeconds);
+    }
+#if defined __linux__
+    if (returnCode == TAK_SUCCESS) {
+        std::set<long> after;
+        listThreads(&after);
+        long started = 0;
+        int count = 0;
+        for (long id : after) {
+            if (before.count(id) == 0) {
+                started = id;
+                count++;
+            }
+        }
+        unsigned long long cpuTicks;
+        if (count == 1 && readThreadStat(started, &thread->startTicks, &cpuTicks)) {
+            thread->id = started;
+        }
+    }
+#endif
+    return returnCode;
+}
+
+static int32_t stopRuntimeThread() {
+    SubsystemLock lock(SUBSYSTEM_LIFECYCLE);
+    return TakLib_stopRuntimeThread();
+}
+
+static void* controllerMain(void*) {
+#if defined TARGET_ANDROID
+    // TakLib may call into the JVM from the start and stop of its thread
+    attachCurrentThread();
+#endif
+    Scheduler& state = scheduler();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (!state.stopRequested) {
+        Clock::time_point now = Clock::now();
+        uint64_t cpuMicros = 0;
+        bool available = state.thread.id != 0 && threadCpuMicros(state.thread, &cpuMicros);
+        RuntimeAction action = runtimePolicyStep(&state.policy, state.config, state.busy, available, cpuMicros, now);
+        if (action == RUNTIME_STOP_THREAD) {
+            lock.unlock();
+            stopRuntimeThread();
+            lock.lock();
+            state.thread = ThreadIdentity();
+            runtimePolicyThreadStopped(&state.policy, state.config, now);
+        } else if (action == RUNTIME_START_THREAD) {
+            ThreadIdentity thread;
+            lock.unlock();
+            int32_t returnCode = startRuntimeThread(state.intervalSeconds, &thread);
+            lock.lock();
+            if (returnCode == TAK_SUCCESS) {
+                state.thread = thread;
+                runtimePolicyThreadStarted(&state.policy, thread.id != 0, now);
+            } else {
+                runtimePolicyStartFailed(&state.policy, now);
+            }
+        }
+
+        state.changed.wait_for(lock, kSamplePeriod, [&state] { return state.stopRequested; });
+    }
+
+    state.stopReturnCode = TAK_SUCCESS;
+    if (state.policy.threadActive) {
+        lock.unlock();
+        int32_t returnCode = stopRuntimeThread();
+        lock.lock();
+        state.stopReturnCode = returnCode;
+        state.thread = ThreadIdentity();
+        runtimePolicyThreadStopped(&state.policy, state.config, Clock::now());
+    }
+    state.running = false;
+    state.changed.notify_all();
+    return NULL;
+}
+
+extern "C" {
+
+    int32_t runtimeSchedulerStart(int intervalSeconds, int64_t budgetMicros, int64_t windowMillis, int64_t maxGapMillis) {
+        if (budgetMicros < 0 || windowMillis < 0 || maxGapMillis < 0) {
+            return TAK_INVALID_PARAMETER;
+        }
+        Scheduler& state = scheduler();
+        std::lock_guard<std::mutex> control(state.controlMutex);
+        runtimeSchedulerStop();
+
+        // TakLib validates the interval and its own state
+        ThreadIdentity thread;
+        int32_t returnCode = startRuntimeThread(intervalSeconds, &thread);
+        if (returnCode != TAK_SUCCESS) {
+            return returnCode;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.intervalSeconds = intervalSeconds;
+        state.config.interval = std::chrono::seconds(intervalSeconds);
+        state.config.budgetMicros = (uint64_t) budgetMicros;
+        state.config.window = std::chrono::milliseconds(windowMillis > 0 ? windowMillis : kDefaultWindowMillis);
+        state.config.maxGap = maxGapMillis > 0 ? Clock::duration(std::chrono::milliseconds(maxGapMillis))
+                                               : Clock::duration(state.config.interval * kDefaultMaxGapIntervals);
+        state.thread = thread;
+        runtimePolicyReset(&state.policy, thread.id != 0, Clock::now());
+
+        pthread_attr_t attributes;
+        bool started = pthread_attr_init(&attributes) == 0;
+        if (started) {
+            pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+            pthread_t controller;
+            started = pthread_create(&controller, &attributes, controllerMain, NULL) == 0;
+            pthread_attr_destroy(&attributes);
+        }
+        if (!started) {
+            state.thread = ThreadIdentity();
+            runtimePolicyThreadStopped(&state.policy, state.config, Clock::now());
+            stopRuntimeThread();
+            return TAK_GENERAL_ERROR;
+        }
+        state.stopRequested = false;
+        state.running = true;
+        return TAK_SUCCESS;
+    }
+
+    int32_t runtimeSchedulerStop(void) {
+        Scheduler& state = scheduler();
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (!state.running) {
+            return TAK_SUCCESS;
+        }
+        state.stopRequested = true;
+        state.changed.notify_all();
+        state.changed.wait(lock, [&state] { return !state.running; });
+        return state.stopReturnCode;
+    }
+
+    void runtimeSchedulerSetBusy(bool busy) {
+        Scheduler& state = scheduler();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.busy = busy;
+    }
+
+    RuntimeSchedulerStats runtimeSchedulerGetStats(void) {
+        Scheduler& state = scheduler();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.policy.stats;
+    }
+}
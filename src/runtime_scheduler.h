@@ -0,0 +1,30 @@
+#ifndef RUNTIME_SCHEDULER_HEADER
+#define RUNTIME_SCHEDULER_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Scheduling of the TakLib runtime checks around the activity of the application.
+//
+// TakLib_createRuntimeCheckThread runs the checks every interval, whatever the application is
+// doing. The scheduler keeps that thread running only while the application is not busy and the
+// checks stay within their CPU budget, and stops it otherwise. A check pass is never interrupted,
+// and once the last pass is older than the maximum gap the thread runs again whatever the hint
+// and the budget.
+//
+// Passes are observed by sampling the CPU time of the TakLib thread in /proc/self/task. The thread
+// is the one that appears there when it starts, told apart from a later thread reusing its id by
+// its start time. When another thread starts at the same moment it cannot be identified: the
+// sampled stat is then 0, the run metrics stay at 0, the checks are assumed to run every interval
+// and the budget is not enforced.
+extern "C" {
+    // intervalSeconds is handed to TakLib_createRuntimeCheckThread, whose errors are returned.
+    // A budgetMicros of 0 disables the budget. A maxGapMillis of 0 defaults to four intervals.
+    int32_t runtimeSchedulerStart(int intervalSeconds, int64_t budgetMicros, int64_t windowMillis, int64_t maxGapMillis);
+    // Stops the scheduler and the TakLib thread it runs. Returns TAK_SUCCESS if it was not running.
+    int32_t runtimeSchedulerStop(void);
+    // Hint that the application is busy (scrolling, animating), checks are deferred meanwhile.
+    void runtimeSchedulerSetBusy(bool busy);
+    RuntimeSchedulerStats runtimeSchedulerGetStats(void);
+}
+#endif // RUNTIME_SCHEDULER_HEADER
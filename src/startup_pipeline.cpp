@@ -0,0 +1,232 @@
+#include "startup_pipeline.h"
+#include "dart_port.h"
+#include "worker_pool.h"
+
+#include <mutex>
+#include <new>
+#include <stdlib.h>
+#include <vector>
+
+static const int kStageCount = 3;
+
+// Step each step depends on, -1 for none
+static const int kDependencies[STARTUP_STEP_COUNT] = {
+    -1,
+    STARTUP_INITIALIZE,
+    STARTUP_REGISTER,
+    STARTUP_REGISTER,
+    STARTUP_INITIALIZE,
+    STARTUP_UPDATE_PINNED_CERTIFICATES,
+};
+
+struct StartupRun {
+    StartupPlan* plan;
+    int64_t port;
+    std::mutex mutex;
+    bool started[STARTUP_STEP_COUNT] = {};
+    bool finished[STARTUP_STEP_COUNT] = {};
+    bool succeeded[STARTUP_STEP_COUNT] = {};
+    // Steps of each stage that are not finished
+    int remaining[kStageCount] = {};
+    int unfinished = STARTUP_STEP_COUNT;
+};
+
+struct StepJob {
+    StartupRun* run;
+    int step;
+};
+
+static void runStepJob(void* argument);
+
+// Return codes the dependents of a step can go on with
+static bool isSuccess(int step, int32_t returnCode) {
+    switch (step) {
+    case STARTUP_INITIALIZE:
+        // The library is initialized, the rest are warnings
+        return returnCode == TAK_SUCCESS || returnCode == TAK_API_ALREADY_INITIALIZED ||
+               returnCode == TAK_LICENSE_ABOUT_TO_EXPIRE || returnCode == TAK_INSTANCE_LOCKED;
+    case STARTUP_REGISTER:
+        return returnCode == TAK_SUCCESS || returnCode == TAK_LICENSE_ABOUT_TO_EXPIRE || returnCode == TAK_ALREADY_REGISTERED;
+    case STARTUP_CHECK_INTEGRITY:
+        return returnCode == TAK_SUCCESS || returnCode == TAK_RE_REGISTER_SUCCESS || returnCode == TAK_LICENSE_ABOUT_TO_EXPIRE;
+    default:
+        return returnCode == TAK_SUCCESS;
+    }
+}
+
+static TakSubsystem stepSubsystem(int step) {
+    switch (step) {
+    case STARTUP_WARM_STORAGE:
+        return SUBSYSTEM_STORAGE;
+    case STARTUP_PRECONNECT:
+        return SUBSYSTEM_TLS;
+    default:
+        return SUBSYSTEM_LIFECYCLE;
+    }
+}
+
+static int32_t runStep(StartupPlan* plan, int step) {
+    switch (step) {
+    case STARTUP_INITIALIZE:
+        return native_initialize(plan->workingPath, plan->license);
+    case STARTUP_REGISTER:
+    {
+        // Registering again would be a server round trip for nothing
+        IsRegisteredResponse registered = native_isRegistered();
+        if (registered.returnCode == TAK_SUCCESS && registered.isRegistered) {
+            return TAK_SUCCESS;
+        }
+        return native_register(plan->userHash);
+    }
+    case STARTUP_CHECK_INTEGRITY:
+        return native_checkIntegrity();
+    case STARTUP_UPDATE_PINNED_CERTIFICATES:
+        return native_updatePinnedCertificates();
+    case STARTUP_WARM_STORAGE:
+    {
+        int32_t returnCode = TAK_SUCCESS;
+        for (int i = 0; i < plan->storageCount; i++) {
+            StorageOpenResponse response = native_storageOpen(plan->storageNames[i]);
+            if (response.returnCode != TAK_SUCCESS && response.returnCode != TAK_STORAGE_ALREADY_EXISTS &&
+                returnCode == TAK_SUCCESS) {
+                returnCode = response.returnCode;
+            }
+        }
+        return returnCode;
+    }
+    case STARTUP_PRECONNECT:
+    {
+        int32_t returnCode = TAK_SUCCESS;
+        for (int i = 0; i < plan->connectionCount; i++) {
+            TlsConnectionResponse response =
+                native_tlsConnectSecurePinning(plan->hosts[i], plan->ports[i], plan->connectTimeout);
+            if (response.peerCertificate != NULL) {
+                free(response.peerCertificate);
+            }
+            plan->sockets[i] = response.returnCode == TAK_SUCCESS ? response.socketDescriptor : -1;
+            if (response.returnCode != TAK_SUCCESS && returnCode == TAK_SUCCESS) {
+                returnCode = response.returnCode;
+            }
+        }
+        return returnCode;
+    }
+    }
+    return TAK_INVALID_PARAMETER;
+}
+
+// Must be called with the run mutex held
+static void finishStep(StartupRun* run, int step, int32_t returnCode, bool succeeded) {
+    run->plan->returnCodes[step] = returnCode;
+    run->finished[step] = true;
+    run->succeeded[step] = succeeded;
+    if (!succeeded) {
+        run->plan->failedSteps |= 1u << step;
+    }
+    run->unfinished--;
+    int stage = run->plan->stages[step];
+    // Posted under the lock, so STARTUP_STAGE_NONE is always the last message
+    if (stage != STARTUP_STAGE_NONE && --run->remaining[stage] == 0) {
+        dartPortPostInt64(run->port, stage);
+    }
+}
+
+// Finishes the steps that need no work and starts the others whose dependency is done.
+// Consumes the lock, the run may be deleted on return.
+static void advance(StartupRun* run, std::unique_lock<std::mutex>& lock) {
+    std::vector<int> ready;
+    bool progressed = true;
+    while (progressed) {
+        progressed = false;
+        for (int step = 0; step < STARTUP_STEP_COUNT; step++) {
+            int dependency = kDependencies[step];
+            if (run->started[step] || (dependency >= 0 && !run->finished[dependency])) {
+                continue;
+            }
+            run->started[step] = true;
+            progressed = true;
+            if (dependency >= 0 && !run->succeeded[dependency]) {
+                finishStep(run, step, run->plan->returnCodes[dependency], false);
+            } else if (run->plan->stages[step] == STARTUP_STAGE_NONE) {
+                finishStep(run, step, TAK_SUCCESS, true);
+            } else {
+                ready.push_back(step);
+            }
+        }
+    }
+
+    if (run->unfinished == 0) {
+        dartPortPostInt64(run->port, STARTUP_STAGE_NONE);
+        lock.unlock();
+        delete run;
+        return;
+    }
+    lock.unlock();
+
+    // The run stays alive until the ready steps are finished
+    for (int step : ready) {
+        int lane = run->plan->stages[step] == STARTUP_STAGE_INTERACTIVE ? LANE_INTERACTIVE : LANE_BACKGROUND;
+        StepJob* job = new (std::nothrow) StepJob{run, step};
+        if (job == NULL || !workerPoolSubmit(stepSubsystem(step), lane, runStepJob, job)) {
+            delete job;
+            std::unique_lock<std::mutex> failed(run->mutex);
+            finishStep(run, step, TAK_GENERAL_ERROR, false);
+            advance(run, failed);
+        }
+    }
+}
+
+static void runStepJob(void* argument) {
+    StepJob* job = (StepJob*) argument;
+    StartupRun* run = job->run;
+    int step = job->step;
+    delete job;
+
+    int32_t returnCode = runStep(run->plan, step);
+    std::unique_lock<std::mutex> lock(run->mutex);
+    finishStep(run, step, returnCode, isSuccess(step, returnCode));
+    advance(run, lock);
+}
+
+extern "C" {
+
+    int32_t startupPipelineStart(StartupPlan* plan, int64_t port) {
+        if (plan == NULL || plan->workingPath == NULL || plan->license == NULL ||
+            (plan->storageCount > 0 && plan->storageNames == NULL) ||
+            (plan->connectionCount > 0 && (plan->hosts == NULL || plan->ports == NULL || plan->sockets == NULL))) {
+            return TAK_INVALID_PARAMETER;
+        }
+        for (int step = 0; step < STARTUP_STEP_COUNT; step++) {
+            if (plan->stages[step] < STARTUP_STAGE_NONE || plan->stages[step] > STARTUP_STAGE_DEFERRED) {
+                return TAK_INVALID_PARAMETER;
+            }
+        }
+        if (!dartPortIsInitialized()) {
+            return TAK_GENERAL_ERROR;
+        }
+
+        StartupRun* run = new (std::nothrow) StartupRun();
+        if (run == NULL) {
+            return TAK_OUT_OF_MEMORY;
+        }
+        run->plan = plan;
+        run->port = port;
+        plan->failedSteps = 0;
+        for (int step = 0; step < STARTUP_STEP_COUNT; step++) {
+            plan->returnCodes[step] = TAK_GENERAL_ERROR;
+            run->remaining[plan->stages[step]]++;
+        }
+        for (int i = 0; i < plan->connectionCount; i++) {
+            plan->sockets[i] = -1;
+        }
+
+        std::unique_lock<std::mutex> lock(run->mutex);
+        // A stage without steps is ready right away
+        for (int stage = STARTUP_STAGE_INTERACTIVE; stage <= STARTUP_STAGE_DEFERRED; stage++) {
+            if (run->remaining[stage] == 0) {
+                dartPortPostInt64(port, stage);
+            }
+        }
+        advance(run, lock);
+        return TAK_SUCCESS;
+    }
+}
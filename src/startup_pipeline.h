@@ -0,0 +1,21 @@
+#ifndef STARTUP_PIPELINE_HEADER
+#define STARTUP_PIPELINE_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Startup of the library as a graph of steps run on the worker pool.
+//
+// Every step waits for the steps it depends on, and starts as soon as they succeeded:
+//   initialize <- register <- check integrity
+//                          <- update pinned certificates <- preconnect
+//              <- warm storage
+// A skipped step is satisfied once its own dependencies are. When a dependency fails, its
+// dependents are not run and take its return code. Steps of different subsystems run in parallel,
+// steps of the lifecycle subsystem one after the other.
+extern "C" {
+    // Posts to `port` the StartupStage of each stage once its steps are done, then
+    // STARTUP_STAGE_NONE once the run no longer uses the plan.
+    int32_t startupPipelineStart(StartupPlan* plan, int64_t port);
+}
+#endif // STARTUP_PIPELINE_HEADER
@@ -0,0 +1,109 @@
+#include "startup_profile.h"
+
+#include <chrono>
+#include <inttypes.h>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef std::chrono::steady_clock Clock;
+
+// Set when the library is loaded, before any phase can start
+static const Clock::time_point kLoadedAt = Clock::now();
+
+static const char* const kPhaseNames[STARTUP_PHASE_COUNT] = {
+    "pluginInitialize",
+    "loadEnvironment",
+    "initialize",
+    "license",
+    "register",
+    "checkIntegrity",
+    "updatePinnedCertificates",
+};
+
+struct Profile {
+    std::mutex mutex;
+    StartupProfile profile = {};
+};
+
+// Never destroyed: phases may still be recorded by worker threads while static destructors run at exit
+static Profile& profile() {
+    static Profile* instance = new Profile();
+    return *instance;
+}
+
+static void writeTiming(FILE* file, const char* name, const StartupPhaseTiming& timing) {
+    fprintf(file, "\"%s\":{\"startNanos\":%" PRId64 ",\"durationNanos\":%" PRId64 ",\"returnCode\":%" PRId32 "}", name,
+            timing.startNanos, timing.durationNanos, timing.returnCode);
+}
+
+// Versions are printed as they are, TakLib only returns digits and dots
+static void writeVersion(FILE* file, const char* name, TAK_RETURN (*getVersion)(char**)) {
+    char* version = NULL;
+    if (getVersion(&version) == TAK_SUCCESS && version != NULL) {
+        fprintf(file, "\"%s\":\"%s\",", name, version);
+    }
+    if (version != NULL) {
+        free(version);
+    }
+}
+
+extern "C" {
+
+    int64_t startupProfileNow(void) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - kLoadedAt).count();
+    }
+
+    int32_t startupProfileRecord(int phase, int64_t startNanos, int32_t returnCode) {
+        int64_t now = startupProfileNow();
+        if (phase < 0 || phase >= STARTUP_PHASE_COUNT || startNanos < 0 || startNanos > now) {
+            return TAK_INVALID_PARAMETER;
+        }
+        StartupPhaseTiming timing = {startNanos, now - startNanos, returnCode};
+        Profile& state = profile();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.profile.counts[phase] == 0) {
+            state.profile.first[phase] = timing;
+        }
+        state.profile.last[phase] = timing;
+        state.profile.counts[phase]++;
+        return TAK_SUCCESS;
+    }
+
+    StartupProfile startupProfileGet(void) {
+        Profile& state = profile();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.profile;
+    }
+
+    int32_t startupProfileWrite(const char* path) {
+        if (path == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        StartupProfile snapshot = startupProfileGet();
+        FILE* file = fopen(path, "a");
+        if (file == NULL) {
+            return TAK_GENERAL_ERROR;
+        }
+
+        fputc('{', file);
+        writeVersion(file, "takVersion", TakLib_getTAKVersion);
+        writeVersion(file, "buildVersion", TakLib_getBuildVersion);
+        fputs("\"phases\":{", file);
+        bool separator = false;
+        for (int phase = 0; phase < STARTUP_PHASE_COUNT; phase++) {
+            if (snapshot.counts[phase] == 0) {
+                continue;
+            }
+            fprintf(file, "%s\"%s\":{\"count\":%" PRIu32 ",", separator ? "," : "", kPhaseNames[phase],
+                    snapshot.counts[phase]);
+            writeTiming(file, "first", snapshot.first[phase]);
+            fputc(',', file);
+            writeTiming(file, "last", snapshot.last[phase]);
+            fputc('}', file);
+            separator = true;
+        }
+        fputs("}}\n", file);
+        return fclose(file) == 0 ? TAK_SUCCESS : TAK_GENERAL_ERROR;
+    }
+}
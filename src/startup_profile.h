@@ -0,0 +1,21 @@
+#ifndef STARTUP_PROFILE_HEADER
+#define STARTUP_PROFILE_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Timings of the startup phases, on the monotonic clock.
+//
+// Each phase keeps its first run in the process and its latest one, so a cold start can be told
+// apart from the warm starts that initialize the library again. Phases may be recorded from any
+// thread, the startup pipeline runs some of them in parallel.
+extern "C" {
+    // Monotonic time since the library was loaded, in nanoseconds.
+    int64_t startupProfileNow(void);
+    // Records a run of `phase` that started at `startNanos` and ends now.
+    int32_t startupProfileRecord(int phase, int64_t startNanos, int32_t returnCode);
+    StartupProfile startupProfileGet(void);
+    // Appends the profile to the file at `path` as a line of JSON, with the versions of TakLib.
+    int32_t startupProfileWrite(const char* path);
+}
+#endif // STARTUP_PROFILE_HEADER
@@ -0,0 +1,261 @@
+#include "storage_cache.h"
+
+#include <list>
+#include <mutex>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+
+struct CachedValue {
+    unsigned char* data;
+    size_t size;
+    // Seed of the key stream the value is masked with, unused when masking is off
+    uint64_t nonce;
+    // Position in the recency list
+    std::list<std::string>::iterator position;
+};
+
+struct StorageCache {
+    std::mutex mutex;
+    uint64_t budgetBytes = 0;
+    bool mask = false;
+    // Secret mixed into every key stream, drawn when masking is first turned on
+    uint64_t maskSecret = 0;
+    uint64_t nextNonce = 0;
+    // Keyed by storage name and key, separated by a NUL byte
+    std::unordered_map<std::string, CachedValue> values;
+    // Most recently used first
+    std::list<std::string> recency;
+    StorageCacheStats stats = {};
+};
+
+static StorageCache& cache() {
+    static StorageCache* instance = new StorageCache();
+    return *instance;
+}
+
+// The compiler may not drop the stores, unlike a memset before free
+static void zeroize(unsigned char* data, size_t size) {
+    volatile unsigned char* cursor = data;
+    while (size-- > 0) {
+        *cursor++ = 0;
+    }
+}
+
+static uint64_t splitMix64(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// XORs `size` bytes from `source` with the key stream of `nonce` into `destination`.
+// Masking hides the values from memory scans, it is not encryption.
+static void applyMask(uint64_t secret, uint64_t nonce, const unsigned char* source, unsigned char* destination,
+                      size_t size) {
+    uint64_t counter = secret ^ splitMix64(nonce);
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t stream = splitMix64(counter++);
+        for (size_t j = 0; j < 8 && i + j < size; j++) {
+            destination[i + j] = source[i + j] ^ (unsigned char) (stream >> (8 * j));
+        }
+    }
+}
+
+static std::string cacheKey(const char* storageName, const char* key) {
+    std::string cacheKey(storageName);
+    cacheKey += '\0';
+    cacheKey += key;
+    return cacheKey;
+}
+
+// Must be called with the cache mutex held
+static void dropValue(StorageCache& state, std::unordered_map<std::string, CachedValue>::iterator found) {
+    zeroize(found->second.data, found->second.size);
+    free(found->second.data);
+    state.stats.bytesInUse -= found->second.size;
+    state.stats.entries--;
+    state.recency.erase(found->second.position);
+    state.values.erase(found);
+}
+
+// Must be called with the cache mutex held
+static void evictToBudget(StorageCache& state, uint64_t budgetBytes) {
+    while (state.stats.bytesInUse > budgetBytes && !state.recency.empty()) {
+        dropValue(state, state.values.find(state.recency.back()));
+        state.stats.evictions++;
+    }
+}
+
+static void invalidateValue(const char* storageName, const char* key) {
+    StorageCache& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto found = state.values.find(cacheKey(storageName, key));
+    if (found != state.values.end()) {
+        dropValue(state, found);
+        state.stats.invalidations++;
+    }
+}
+
+static void invalidateStorage(const char* storageName) {
+    StorageCache& state = cache();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::string prefix = cacheKey(storageName, "");
+    for (auto found = state.values.begin(); found != state.values.end();) {
+        auto next = std::next(found);
+        if (found->first.compare(0, prefix.size(), prefix) == 0) {
+            dropValue(state, found);
+            state.stats.invalidations++;
+        }
+        found = next;
+    }
+}
+
+// TakLib deletes the storage when it finds the application on another device
+static void checkDeviceMismatch(const char* storageName, int32_t returnCode) {
+    if (returnCode == TAK_STORAGE_DEVICE_MISMATCH) {
+        invalidateStorage(storageName);
+    }
+}
+
+// Must be called with the cache mutex held
+static void insertValue(StorageCache& state, const std::string& key, const TAK_byte_buffer& value) {
+    if (value.length > state.budgetBytes) {
+        return;
+    }
+    unsigned char* copy = (unsigned char*) malloc(value.length > 0 ? value.length : 1);
+    if (copy == NULL) {
+        return;
+    }
+    uint64_t nonce = state.nextNonce++;
+    if (state.mask) {
+        applyMask(state.maskSecret, nonce, value.data, copy, value.length);
+    } else if (value.length > 0) {
+        memcpy(copy, value.data, value.length);
+    }
+    evictToBudget(state, state.budgetBytes - value.length);
+    state.recency.push_front(key);
+    state.values.emplace(key, CachedValue{copy, value.length, nonce, state.recency.begin()});
+    state.stats.bytesInUse += value.length;
+    state.stats.entries++;
+}
+
+extern "C" {
+
+    int32_t storageCacheRead(const char* storageName, const char* key, TAK_byte_buffer* output) {
+        if (storageName == NULL || key == NULL || output == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        output->data = NULL;
+        output->length = 0;
+        StorageCache& state = cache();
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (state.budgetBytes == 0) {
+            lock.unlock();
+            int32_t returnCode = TakLib_storageRead(storageName, key, output);
+            checkDeviceMismatch(storageName, returnCode);
+            return returnCode;
+        }
+
+        std::string valueKey = cacheKey(storageName, key);
+        auto found = state.values.find(valueKey);
+        if (found != state.values.end()) {
+            CachedValue& value = found->second;
+            state.recency.splice(state.recency.begin(), state.recency, value.position);
+            state.stats.hits++;
+            output->data = (unsigned char*) malloc(value.size > 0 ? value.size : 1);
+            if (output->data == NULL) {
+                return TAK_OUT_OF_MEMORY;
+            }
+            if (state.mask) {
+                applyMask(state.maskSecret, value.nonce, value.data, output->data, value.size);
+            } else if (value.size > 0) {
+                memcpy(output->data, value.data, value.size);
+            }
+            output->length = (unsigned int) value.size;
+            return TAK_SUCCESS;
+        }
+
+        state.stats.misses++;
+        // The caller holds the storage lock, no write can change the value meanwhile
+        lock.unlock();
+        int32_t returnCode = TakLib_storageRead(storageName, key, output);
+        checkDeviceMismatch(storageName, returnCode);
+        if (returnCode == TAK_SUCCESS && output->data != NULL) {
+            lock.lock();
+            if (state.budgetBytes > 0 && state.values.count(valueKey) == 0) {
+                insertValue(state, valueKey, *output);
+            }
+        }
+        return returnCode;
+    }
+
+    int32_t storageCacheWrite(const char* storageName, const char* key, TAK_byte_buffer value) {
+        if (storageName == NULL || key == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        // Dropped even when the write fails, TakLib may have changed the value before failing
+        invalidateValue(storageName, key);
+        int32_t returnCode = TakLib_storageWrite(storageName, key, value);
+        checkDeviceMismatch(storageName, returnCode);
+        return returnCode;
+    }
+
+    int32_t storageCacheDeleteEntry(const char* storageName, const char* key) {
+        if (storageName == NULL || key == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        invalidateValue(storageName, key);
+        int32_t returnCode = TakLib_storageDeleteEntry(storageName, key);
+        checkDeviceMismatch(storageName, returnCode);
+        return returnCode;
+    }
+
+    int32_t storageCacheDeleteStorage(const char* storageName) {
+        if (storageName == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        invalidateStorage(storageName);
+        return TakLib_storageDelete(storageName);
+    }
+
+    int32_t storageCacheConfigure(int64_t budgetBytes, bool mask) {
+        if (budgetBytes < 0) {
+            return TAK_INVALID_PARAMETER;
+        }
+        StorageCache& state = cache();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (mask != state.mask) {
+            // Values are kept in one form only
+            while (!state.values.empty()) {
+                dropValue(state, state.values.begin());
+            }
+            if (mask && state.maskSecret == 0) {
+                std::random_device device;
+                state.maskSecret = ((uint64_t) device() << 32) | device();
+            }
+            state.mask = mask;
+        }
+        state.budgetBytes = (uint64_t) budgetBytes;
+        evictToBudget(state, state.budgetBytes);
+        return TAK_SUCCESS;
+    }
+
+    void storageCacheClear(void) {
+        StorageCache& state = cache();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        while (!state.values.empty()) {
+            dropValue(state, state.values.begin());
+        }
+    }
+
+    StorageCacheStats storageCacheGetStats(void) {
+        StorageCache& state = cache();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        StorageCacheStats stats = state.stats;
+        stats.capacity = state.budgetBytes;
+        return stats;
+    }
+}
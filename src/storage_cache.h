@@ -0,0 +1,28 @@
+#ifndef STORAGE_CACHE_HEADER
+#define STORAGE_CACHE_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Read-through cache of the values read with TakLib_storageRead, by storage and key.
+//
+// Disabled until it is given a budget. The least recently used values are evicted once the cached
+// bytes exceed the budget, and their memory is zeroed before it is released. Writes and deletes go
+// through the cache, which drops the values they change. When masking is on, cached values are kept
+// XOR-ed with a random key stream, so the plaintext does not sit in memory between reads.
+//
+// The functions call TakLib and must be called with the storage subsystem lock held.
+extern "C" {
+    // Copies the value from the cache, or reads it into the cache, into `output` allocated with malloc.
+    int32_t storageCacheRead(const char* storageName, const char* key, TAK_byte_buffer* output);
+    int32_t storageCacheWrite(const char* storageName, const char* key, TAK_byte_buffer value);
+    int32_t storageCacheDeleteEntry(const char* storageName, const char* key);
+    int32_t storageCacheDeleteStorage(const char* storageName);
+    // Sets the budget in bytes of cached values, 0 disables the cache. Evicts down to the budget.
+    // Changing the masking drops every value.
+    int32_t storageCacheConfigure(int64_t budgetBytes, bool mask);
+    // Zeroes and drops every value, for when TakLib is initialized, reset or released.
+    void storageCacheClear(void);
+    StorageCacheStats storageCacheGetStats(void);
+}
+#endif // STORAGE_CACHE_HEADER
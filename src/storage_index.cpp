@@ -0,0 +1,454 @@
+#include "storage_index.h"
+#include "bloom_filter.h"
+#include "storage_cache.h"
+#include "storage_writer.h"
+
+#include <set>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Starts with a control character, which no key of the application is expected to use
+static const char kIndexKey[] = "\x1f" "tak.keyIndex";
+static const char kMagic[8] = {'T', 'A', 'K', 'K', 'E', 'Y', 'S', '2'};
+// Layout of indexes that went through the storage writer with the values, and may have been stored
+// after some of them: read as incomplete
+static const char kUnorderedMagic[8] = {'T', 'A', 'K', 'K', 'E', 'Y', 'S', '1'};
+static const size_t kHeaderSize = sizeof(kMagic) + 1 + 4;
+
+// The persisted index holds at least every key of the storage: it is written to TakLib right away,
+// with the keys added, before their values are, and keys are removed after their values are deleted.
+struct KeyIndex {
+    bool complete = false;
+    // False once the storage is known to be missing, for TakLib to report it on the next access
+    bool exists = true;
+    // Whether it changed since it was persisted. Changes for deferred writes are persisted once, before
+    // the writer flushes the values of the storage.
+    bool dirty = false;
+    std::set<std::string> keys;
+    // Filter of `keys`, rejecting most keys that are not in the storage without a lookup
+    BloomFilter filter;
+};
+
+static int32_t persistBeforeFlush(const char* storageName);
+static void dropAfterFlushError(const char* storageName, int32_t);
+
+static std::unordered_map<std::string, KeyIndex>* createIndexes() {
+    storageWriterSetFlushHooks(persistBeforeFlush, dropAfterFlushError);
+    return new std::unordered_map<std::string, KeyIndex>();
+}
+
+// Guarded by the storage subsystem lock
+static std::unordered_map<std::string, KeyIndex>& indexes() {
+    static std::unordered_map<std::string, KeyIndex>* instance = createIndexes();
+    return *instance;
+}
+
+// Storages written while their index was not loaded, whose index misses keys once loaded
+static std::unordered_set<std::string>& unindexedStorages() {
+    static std::unordered_set<std::string>* instance = new std::unordered_set<std::string>();
+    return *instance;
+}
+
+// The compiler may not drop the stores, unlike a memset before free
+static void zeroize(unsigned char* data, size_t size) {
+    volatile unsigned char* cursor = data;
+    while (size-- > 0) {
+        *cursor++ = 0;
+    }
+}
+
+static uint32_t readLittleEndian32(const unsigned char* data) {
+    return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+static void appendLittleEndian32(std::vector<unsigned char>& output, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        output.push_back((unsigned char) (value >> (8 * i)));
+    }
+}
+
+static bool parseIndex(const unsigned char* data, size_t size, KeyIndex* index) {
+    if (size < kHeaderSize) {
+        return false;
+    }
+    bool ordered = memcmp(data, kMagic, sizeof(kMagic)) == 0;
+    if (!ordered && memcmp(data, kUnorderedMagic, sizeof(kUnorderedMagic)) != 0) {
+        return false;
+    }
+    index->complete = ordered && data[sizeof(kMagic)] != 0;
+    uint32_t count = readLittleEndian32(data + sizeof(kMagic) + 1);
+    size_t position = kHeaderSize;
+    for (uint32_t i = 0; i < count; i++) {
+        if (size - position < 4) {
+            return false;
+        }
+        uint32_t keySize = readLittleEndian32(data + position);
+        position += 4;
+        if (keySize == 0 || size - position < keySize) {
+            return false;
+        }
+        index->keys.emplace((const char*) data + position, keySize);
+        position += keySize;
+    }
+    return position == size;
+}
+
+// Written through to TakLib, never deferred, so the index is stored before the values it lists
+static int32_t persistIndex(const char* storageName, KeyIndex& index) {
+    std::vector<unsigned char> serialized(kMagic, kMagic + sizeof(kMagic));
+    serialized.push_back(index.complete ? 1 : 0);
+    appendLittleEndian32(serialized, (uint32_t) index.keys.size());
+    for (const std::string& key : index.keys) {
+        appendLittleEndian32(serialized, (uint32_t) key.size());
+        serialized.insert(serialized.end(), key.begin(), key.end());
+    }
+    TAK_byte_buffer value = {serialized.data(), (unsigned int) serialized.size()};
+    int32_t returnCode = storageCacheWrite(storageName, kIndexKey, value);
+    zeroize(serialized.data(), serialized.size());
+    if (returnCode == TAK_SUCCESS) {
+        index.dirty = false;
+    }
+    return returnCode;
+}
+
+// Sized for the index to double before it is rebuilt
+static void rebuildFilter(KeyIndex& index) {
+    index.filter.reset(index.keys.size() * 2);
+    for (const std::string& key : index.keys) {
+        index.filter.add(key);
+    }
+}
+
+// A storage that does not exist, or that TakLib deleted, has no key
+static KeyIndex* resetIndex(const char* storageName, bool exists) {
+    KeyIndex& index = indexes()[storageName];
+    index.complete = true;
+    index.exists = exists;
+    index.dirty = false;
+    index.keys.clear();
+    rebuildFilter(index);
+    unindexedStorages().erase(storageName);
+    return &index;
+}
+
+static void checkDeviceMismatch(const char* storageName, int32_t returnCode) {
+    if (returnCode == TAK_STORAGE_DEVICE_MISMATCH) {
+        resetIndex(storageName, false);
+    }
+}
+
+// Returns NULL, and the error in `returnCode`, when the index cannot be read
+static KeyIndex* loadIndex(const char* storageName, int32_t* returnCode) {
+    auto found = indexes().find(storageName);
+    *returnCode = TAK_SUCCESS;
+    if (found != indexes().end()) {
+        return &found->second;
+    }
+
+    TAK_byte_buffer value = {NULL, 0};
+    int32_t readReturnCode = storageCacheRead(storageName, kIndexKey, &value);
+    if (readReturnCode == TAK_STORAGE_NOT_FOUND || readReturnCode == TAK_STORAGE_DEVICE_MISMATCH) {
+        return resetIndex(storageName, false);
+    }
+    if (readReturnCode != TAK_SUCCESS && readReturnCode != TAK_STORAGE_KEY_NOT_FOUND) {
+        *returnCode = readReturnCode;
+        return NULL;
+    }
+    KeyIndex index;
+    if (value.data != NULL) {
+        if (!parseIndex(value.data, value.length, &index)) {
+            // Rebuilt from the next writes, as for a storage created before the index existed
+            index = KeyIndex();
+        }
+        zeroize(value.data, value.length);
+        free(value.data);
+    }
+    rebuildFilter(index);
+    KeyIndex& loaded = indexes()[storageName] = index;
+    if (unindexedStorages().erase(storageName) > 0 && loaded.complete) {
+        // Persisted again before the next flush when it cannot be now
+        loaded.complete = false;
+        loaded.dirty = true;
+        persistIndex(storageName, loaded);
+    }
+    return &loaded;
+}
+
+// Saves the changes to the index before the deferred values of the storage are written
+static int32_t persistBeforeFlush(const char* storageName) {
+    if (indexes().count(storageName) == 0 && unindexedStorages().count(storageName) == 0) {
+        return TAK_SUCCESS;
+    }
+    int32_t returnCode;
+    KeyIndex* index = loadIndex(storageName, &returnCode);
+    if (index == NULL || !index->dirty) {
+        return returnCode;
+    }
+    returnCode = persistIndex(storageName, *index);
+    checkDeviceMismatch(storageName, returnCode);
+    return returnCode;
+}
+
+// The index in memory may list keys whose values were not stored, or miss keys removed from the
+// persisted one: it is read again from TakLib on its next use
+static void dropAfterFlushError(const char* storageName, int32_t) {
+    indexes().erase(storageName);
+}
+
+// Once the keys added to the index are stored, or will be before the values are flushed
+static int32_t saveAddedKeys(const char* storageName, KeyIndex& index) {
+    index.dirty = true;
+    if (storageWriterIsDeferring()) {
+        return TAK_SUCCESS;
+    }
+    return persistIndex(storageName, index);
+}
+
+static bool isReservedKey(const char* key) {
+    return strcmp(key, kIndexKey) == 0;
+}
+
+// Whether a key missing from the index is missing from the storage
+static bool knowsEveryKey(const KeyIndex* index) {
+    return index != NULL && index->complete && index->exists;
+}
+
+template <typename Iterator>
+static int32_t packKeys(Iterator begin, Iterator end, int limit, TAK_byte_buffer* output) {
+    std::vector<unsigned char> packed;
+    int count = 0;
+    for (Iterator key = begin; key != end && (limit <= 0 || count < limit); ++key, ++count) {
+        uint32_t size = (uint32_t) key->size();
+        packed.insert(packed.end(), (const unsigned char*) &size, (const unsigned char*) &size + 4);
+        packed.insert(packed.end(), key->begin(), key->end());
+    }
+    if (packed.empty()) {
+        return TAK_SUCCESS;
+    }
+    output->data = (unsigned char*) malloc(packed.size());
+    if (output->data == NULL) {
+        return TAK_OUT_OF_MEMORY;
+    }
+    memcpy(output->data, packed.data(), packed.size());
+    output->length = (unsigned int) packed.size();
+    return TAK_SUCCESS;
+}
+
+extern "C" {
+
+    void storageIndexOpen(const char* storageName, bool created) {
+        if (storageName == NULL) {
+            return;
+        }
+        if (created) {
+            persistIndex(storageName, *resetIndex(storageName, true));
+            return;
+        }
+        int32_t returnCode;
+        loadIndex(storageName, &returnCode);
+    }
+
+    int32_t storageIndexWrite(const char* storageName, const char* key, TAK_byte_buffer value) {
+        int32_t result;
+        int32_t returnCode = storageIndexWriteBatch(storageName, &key, &value, 1, &result);
+        return returnCode == TAK_SUCCESS ? result : returnCode;
+    }
+
+    int32_t storageIndexWriteBatch(const char* storageName, const char* const* keys, const TAK_byte_buffer* values,
+                                   int count, int32_t* results) {
+        if (storageName == NULL || count < 0 || (count > 0 && (keys == NULL || values == NULL || results == NULL))) {
+            return TAK_INVALID_PARAMETER;
+        }
+        int32_t returnCode;
+        KeyIndex* index = loadIndex(storageName, &returnCode);
+        if (index == NULL) {
+            unindexedStorages().insert(storageName);
+        }
+        std::vector<bool> added(count, false);
+        bool anyAdded = false;
+        for (int i = 0; i < count; i++) {
+            results[i] = keys[i] == NULL || isReservedKey(keys[i]) ? TAK_INVALID_PARAMETER : TAK_SUCCESS;
+            if (index != NULL && results[i] == TAK_SUCCESS && index->keys.insert(keys[i]).second) {
+                added[i] = true;
+                anyAdded = true;
+                index->filter.add(keys[i]);
+            }
+        }
+        if (anyAdded) {
+            // Persisted once for the whole batch
+            returnCode = saveAddedKeys(storageName, *index);
+            if (returnCode != TAK_SUCCESS) {
+                for (int i = 0; i < count; i++) {
+                    if (added[i]) {
+                        index->keys.erase(keys[i]);
+                        index->filter.remove(keys[i]);
+                    }
+                    if (results[i] == TAK_SUCCESS) {
+                        results[i] = returnCode;
+                    }
+                }
+                checkDeviceMismatch(storageName, returnCode);
+                return TAK_SUCCESS;
+            }
+            if (index->filter.isOverloaded()) {
+                rebuildFilter(*index);
+            }
+        }
+
+        bool anyRemoved = false;
+        for (int i = 0; i < count; i++) {
+            if (results[i] != TAK_SUCCESS) {
+                continue;
+            }
+            results[i] = storageWriterWrite(storageName, keys[i], values[i]);
+            checkDeviceMismatch(storageName, results[i]);
+            if (results[i] == TAK_STORAGE_DEVICE_MISMATCH) {
+                // The index was reset and `index` still points to it, no key is left to remove
+                added.assign(count, false);
+            } else if (index != NULL && results[i] == TAK_SUCCESS) {
+                index->exists = true;
+            } else if (added[i]) {
+                index->keys.erase(keys[i]);
+                index->filter.remove(keys[i]);
+                anyRemoved = true;
+            }
+        }
+        if (anyRemoved && !storageWriterIsDeferring()) {
+            persistIndex(storageName, *index);
+        }
+        return TAK_SUCCESS;
+    }
+
+    int32_t storageIndexRead(const char* storageName, const char* key, TAK_byte_buffer* output) {
+        if (storageName == NULL || key == NULL || output == NULL || isReservedKey(key)) {
+            return TAK_INVALID_PARAMETER;
+        }
+        output->data = NULL;
+        output->length = 0;
+        int32_t returnCode;
+        KeyIndex* index = loadIndex(storageName, &returnCode);
+        if (knowsEveryKey(index) && !index->filter.mightContain(key)) {
+            return TAK_STORAGE_KEY_NOT_FOUND;
+        }
+        returnCode = storageWriterRead(storageName, key, output);
+        checkDeviceMismatch(storageName, returnCode);
+        return returnCode;
+    }
+
+    int32_t storageIndexDeleteEntry(const char* storageName, const char* key) {
+        if (storageName == NULL || key == NULL || isReservedKey(key)) {
+            return TAK_INVALID_PARAMETER;
+        }
+        int32_t returnCode = storageWriterDeleteEntry(storageName, key);
+        checkDeviceMismatch(storageName, returnCode);
+        if (returnCode == TAK_SUCCESS || returnCode == TAK_STORAGE_KEY_NOT_FOUND) {
+            int32_t loadReturnCode;
+            KeyIndex* index = loadIndex(storageName, &loadReturnCode);
+            // When it cannot be written the index keeps the key, listed but not found
+            if (index != NULL && index->keys.erase(key) > 0) {
+                index->filter.remove(key);
+                if (storageWriterIsDeferring()) {
+                    index->dirty = true;
+                } else {
+                    persistIndex(storageName, *index);
+                }
+            }
+        }
+        return returnCode;
+    }
+
+    int32_t storageIndexDeleteStorage(const char* storageName) {
+        if (storageName == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        int32_t returnCode = storageWriterDeleteStorage(storageName);
+        if (returnCode == TAK_SUCCESS || returnCode == TAK_STORAGE_NOT_FOUND) {
+            resetIndex(storageName, false);
+        }
+        return returnCode;
+    }
+
+    int32_t storageIndexList(const char* storageName, const char* start, const char* end, int limit,
+                             TAK_byte_buffer* output) {
+        if (storageName == NULL || output == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        output->data = NULL;
+        output->length = 0;
+        int32_t returnCode;
+        KeyIndex* index = loadIndex(storageName, &returnCode);
+        if (index == NULL) {
+            return returnCode;
+        }
+        auto first = start != NULL && start[0] != '\0' ? index->keys.lower_bound(start) : index->keys.begin();
+        auto last = end != NULL && end[0] != '\0' ? index->keys.lower_bound(end) : index->keys.end();
+        if (last != index->keys.end() && (first == index->keys.end() || *last < *first)) {
+            last = first;
+        }
+        return packKeys(first, last, limit, output);
+    }
+
+    int32_t storageIndexScanPrefix(const char* storageName, const char* prefix, int limit, TAK_byte_buffer* output) {
+        if (storageName == NULL || prefix == NULL || output == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        output->data = NULL;
+        output->length = 0;
+        int32_t returnCode;
+        KeyIndex* index = loadIndex(storageName, &returnCode);
+        if (index == NULL) {
+            return returnCode;
+        }
+        size_t prefixSize = strlen(prefix);
+        auto first = index->keys.lower_bound(prefix);
+        auto last = first;
+        while (last != index->keys.end() && last->compare(0, prefixSize, prefix) == 0) {
+            ++last;
+        }
+        return packKeys(first, last, limit, output);
+    }
+
+    bool storageIndexIsComplete(const char* storageName) {
+        if (storageName == NULL) {
+            return false;
+        }
+        int32_t returnCode;
+        KeyIndex* index = loadIndex(storageName, &returnCode);
+        return index != NULL && index->complete;
+    }
+
+    int32_t storageIndexContains(const char* storageName, const char* key) {
+        if (storageName == NULL || key == NULL || isReservedKey(key)) {
+            return TAK_INVALID_PARAMETER;
+        }
+        int32_t returnCode;
+        KeyIndex* index = loadIndex(storageName, &returnCode);
+        if (knowsEveryKey(index) && (!index->filter.mightContain(key) || index->keys.count(key) == 0)) {
+            return TAK_STORAGE_KEY_NOT_FOUND;
+        }
+
+        // The index may list keys whose values were never stored, and misses keys written before it
+        // existed: TakLib tells
+        TAK_byte_buffer value = {NULL, 0};
+        returnCode = storageIndexRead(storageName, key, &value);
+        if (value.data != NULL) {
+            zeroize(value.data, value.length);
+            free(value.data);
+        }
+        return returnCode;
+    }
+
+    void storageIndexClear(void) {
+        // Values may still be pending for the keys that were not persisted
+        for (auto& entry : indexes()) {
+            if (entry.second.dirty && persistIndex(entry.first.c_str(), entry.second) != TAK_SUCCESS) {
+                unindexedStorages().insert(entry.first);
+            }
+        }
+        indexes().clear();
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef STORAGE_INDEX_HEADER
+#define STORAGE_INDEX_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Index of the keys of each secure storage, which TakLib cannot list.
+//
+// The keys are kept sorted by their bytes and persisted in a reserved entry of the storage, encrypted
+// like any other value. The index is loaded when the storage is opened or first used, and written
+// again only when a write adds a key or a delete removes one. It is written straight to TakLib, before
+// the values of the keys it adds: right away, once per batch, or when the storage writer defers the
+// values, once before it flushes them. A write fails when its key cannot be added to the persisted
+// index. The reserved key cannot be read, written or deleted by callers.
+//
+// An index is complete when it has followed the storage since it was created. Storages created
+// before the index existed may hold keys written earlier, which are only listed once they are
+// written again.
+//
+// Each index has a Bloom filter of its keys, rebuilt when the index is loaded. Reads and existence
+// checks of keys the filter rejects return TAK_STORAGE_KEY_NOT_FOUND without calling TakLib, when
+// the index is complete. Indexes persisted by the earlier layout, which went through the storage
+// writer with the values and could be stored after them, are read as incomplete. When a flush of
+// deferred writes fails, the index of the storage is read again from TakLib on its next use.
+//
+// The functions call TakLib and must be called with the storage subsystem lock held.
+extern "C" {
+    // Loads the index of a storage that was just opened, `created` when TakLib created it.
+    void storageIndexOpen(const char* storageName, bool created);
+    int32_t storageIndexWrite(const char* storageName, const char* key, TAK_byte_buffer value);
+    // Writes `values[i]` under `keys[i]`, storing the return code of each entry in `results`. NULL
+    // keys are invalid. The index is persisted once for the batch.
+    int32_t storageIndexWriteBatch(const char* storageName, const char* const* keys, const TAK_byte_buffer* values,
+                                   int count, int32_t* results);
+    int32_t storageIndexRead(const char* storageName, const char* key, TAK_byte_buffer* output);
+    int32_t storageIndexDeleteEntry(const char* storageName, const char* key);
+    int32_t storageIndexDeleteStorage(const char* storageName);
+    // Lists at most `limit` keys (all when not positive) from `start` included to `end` excluded,
+    // NULL or empty for no bound, into `output` allocated with malloc: for each key, its size
+    // (uint32, native byte order) and its bytes.
+    int32_t storageIndexList(const char* storageName, const char* start, const char* end, int limit,
+                             TAK_byte_buffer* output);
+    // Lists the keys starting with `prefix`, as storageIndexList.
+    int32_t storageIndexScanPrefix(const char* storageName, const char* prefix, int limit, TAK_byte_buffer* output);
+    // TAK_SUCCESS when the key is in the storage, TAK_STORAGE_KEY_NOT_FOUND when it is not. Keys a
+    // complete index does not hold are answered without TakLib, the others are read.
+    int32_t storageIndexContains(const char* storageName, const char* key);
+    // Whether every key of the storage is in its index. False when the index could not be loaded.
+    bool storageIndexIsComplete(const char* storageName);
+    // Forgets the indexes loaded, for when TakLib is initialized, reset or released.
+    void storageIndexClear(void);
+}
+#endif // STORAGE_INDEX_HEADER
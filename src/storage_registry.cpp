@@ -0,0 +1,67 @@
+#include "storage_registry.h"
+
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+static std::mutex gRegistryMutex;
+static std::vector<std::shared_ptr<StorageEntry>> gEntries;
+static std::unordered_map<std::string, int32_t> gHandlesByName;
+
+int32_t storageRegistryOpen(const char* storageName, int32_t* handle) {
+    if (storageName == NULL || storageName[0] == '\0' || handle == NULL) {
+        return TAK_INVALID_PARAMETER;
+    }
+
+    // The storage may have been deleted since it was registered, it is created every time
+    int32_t returnCode = TakLib_storageCreate(storageName);
+    if (returnCode != TAK_SUCCESS && returnCode != TAK_STORAGE_ALREADY_EXISTS) {
+        return returnCode;
+    }
+
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    auto found = gHandlesByName.find(storageName);
+    if (found != gHandlesByName.end()) {
+        *handle = found->second;
+        return returnCode;
+    }
+    std::shared_ptr<StorageEntry> entry = std::make_shared<StorageEntry>();
+    // Handle 0 is never given out, so it can stand for "no storage" on the Dart side
+    entry->handle = (int32_t) gEntries.size() + 1;
+    entry->name = storageName;
+    gEntries.push_back(entry);
+    gHandlesByName.emplace(entry->name, entry->handle);
+    *handle = entry->handle;
+    return returnCode;
+}
+
+std::shared_ptr<StorageEntry> storageRegistryFind(int32_t handle) {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    if (handle <= 0 || (size_t) handle > gEntries.size()) {
+        return nullptr;
+    }
+    return gEntries[handle - 1];
+}
+
+StorageKey::StorageKey(const unsigned char* data, int length) : heapBuffer(NULL), value(NULL) {
+    if (data == NULL || length <= 0 || memchr(data, '\0', length) != NULL) {
+        return;
+    }
+    char* buffer = inlineBuffer;
+    if ((size_t) length >= sizeof(inlineBuffer)) {
+        heapBuffer = (char*) malloc(length + 1);
+        if (heapBuffer == NULL) {
+            return;
+        }
+        buffer = heapBuffer;
+    }
+    memcpy(buffer, data, length);
+    buffer[length] = '\0';
+    value = buffer;
+}
+
+StorageKey::~StorageKey() {
+    free(heapBuffer);
+}
@@ -0,0 +1,37 @@
+#ifndef STORAGE_REGISTRY_HEADER
+#define STORAGE_REGISTRY_HEADER
+
+#include <memory>
+#include <string>
+#include "native_tak.h"
+
+// Registry of the secure storages opened through native_storageOpen.
+//
+// A storage is identified by a small integer handle, stable for the whole process. Opening the
+// same name again returns the same handle, so per-storage state can be attached to its entry.
+struct StorageEntry {
+    int32_t handle;
+    std::string name;
+};
+
+// Creates the storage if needed and returns its handle through `handle`.
+int32_t storageRegistryOpen(const char* storageName, int32_t* handle);
+std::shared_ptr<StorageEntry> storageRegistryFind(int32_t handle);
+
+// NUL-terminated copy of a length-prefixed key, kept on the stack for usual key sizes.
+class StorageKey {
+public:
+    StorageKey(const unsigned char* data, int length);
+    ~StorageKey();
+    // NULL when the key is empty or contains a NUL byte.
+    const char* get() const { return value; }
+
+private:
+    StorageKey(const StorageKey&) = delete;
+    StorageKey& operator=(const StorageKey&) = delete;
+
+    char inlineBuffer[128];
+    char* heapBuffer;
+    const char* value;
+};
+#endif // STORAGE_REGISTRY_HEADER
@@ -0,0 +1,374 @@
+#include "storage_writer.h"
+#include "storage_cache.h"
+#include "subsystem_lock.h"
+#include "worker_pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// Read to find out whether a storage exists: TakLib tells a missing storage from a missing key
+static const char* const kProbeKey = "tak.storage_writer.probe";
+
+struct PendingWrite {
+    std::string storageName;
+    std::string key;
+    std::vector<unsigned char> value;
+};
+
+struct Writer {
+    std::mutex mutex;
+    std::condition_variable changed;
+    Clock::duration window = Clock::duration::zero();
+    bool timerStarted = false;
+    // Whether a flush is queued on the worker pool
+    bool flushQueued = false;
+    // Storages known to exist, deferred writes to the others check them first
+    std::unordered_set<std::string> knownStorages;
+    // Keyed by storage name and key, separated by a NUL byte
+    std::unordered_map<std::string, PendingWrite> pending;
+    // When the oldest pending write was made
+    Clock::time_point oldest;
+    // First error of the deferred writes since the last explicit flush
+    int32_t unreportedError = TAK_SUCCESS;
+    int32_t (*beforeFlush)(const char* storageName) = NULL;
+    void (*flushFailed)(const char* storageName, int32_t returnCode) = NULL;
+    StorageWriterStats stats = {};
+};
+
+// Outcome of a flush for one storage
+struct FlushedStorage {
+    int32_t prepared;
+    int32_t firstError;
+};
+
+// Never destroyed: the flusher thread may still use it while static destructors run at exit
+static Writer& writer() {
+    static Writer* instance = new Writer();
+    return *instance;
+}
+
+// The compiler may not drop the stores, unlike a memset before free
+static void zeroize(std::vector<unsigned char>& value) {
+    volatile unsigned char* cursor = value.data();
+    for (size_t i = 0; i < value.size(); i++) {
+        cursor[i] = 0;
+    }
+}
+
+static std::string pendingKey(const char* storageName, const char* key) {
+    std::string pendingKey(storageName);
+    pendingKey += '\0';
+    pendingKey += key;
+    return pendingKey;
+}
+
+// Must be called with the writer mutex held
+static void dropPending(Writer& state, std::unordered_map<std::string, PendingWrite>::iterator found) {
+    zeroize(found->second.value);
+    state.stats.pendingBytes -= found->second.value.size();
+    state.pending.erase(found);
+    state.stats.pending = state.pending.size();
+}
+
+// Must be called with the storage lock held, and not the writer mutex
+static void flushPending(Writer& state) {
+    std::unordered_map<std::string, PendingWrite> batch;
+    int32_t (*beforeFlush)(const char* storageName);
+    void (*flushFailed)(const char* storageName, int32_t returnCode);
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.pending.empty()) {
+            return;
+        }
+        beforeFlush = state.beforeFlush;
+        flushFailed = state.flushFailed;
+        batch.swap(state.pending);
+        state.stats.pending = 0;
+        state.stats.pendingBytes = 0;
+        state.stats.flushes++;
+    }
+    // The storage lock keeps reads out until the values are written
+    int32_t firstError = TAK_SUCCESS;
+    uint64_t failures = 0;
+    // The writes of a storage are dropped when the hook failed for it
+    std::unordered_map<std::string, FlushedStorage> storages;
+    for (auto& entry : batch) {
+        PendingWrite& write = entry.second;
+        auto storage = storages.find(write.storageName);
+        if (storage == storages.end()) {
+            int32_t returnCode = beforeFlush != NULL ? beforeFlush(write.storageName.c_str()) : TAK_SUCCESS;
+            storage = storages.emplace(write.storageName, FlushedStorage{returnCode, returnCode}).first;
+        }
+        int32_t returnCode = storage->second.prepared;
+        if (returnCode == TAK_SUCCESS) {
+            TAK_byte_buffer value = {write.value.data(), (unsigned int) write.value.size()};
+            returnCode = storageCacheWrite(write.storageName.c_str(), write.key.c_str(), value);
+        }
+        if (returnCode != TAK_SUCCESS) {
+            failures++;
+            if (firstError == TAK_SUCCESS) {
+                firstError = returnCode;
+            }
+            if (storage->second.firstError == TAK_SUCCESS) {
+                storage->second.firstError = returnCode;
+            }
+        }
+        zeroize(write.value);
+    }
+    for (auto& storage : storages) {
+        if (flushFailed != NULL && storage.second.firstError != TAK_SUCCESS) {
+            flushFailed(storage.first.c_str(), storage.second.firstError);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.stats.flushed += batch.size();
+    state.stats.failures += failures;
+    if (state.unreportedError == TAK_SUCCESS) {
+        state.unreportedError = firstError;
+    }
+}
+
+// Runs on the worker pool, whose threads are attached to the JVM before they call TakLib
+static void flushJob(void*) {
+    Writer& state = writer();
+    {
+        SubsystemLock storage(SUBSYSTEM_STORAGE);
+        flushPending(state);
+    }
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.flushQueued = false;
+    state.changed.notify_all();
+}
+
+// Only waits for the window of the oldest pending write and queues the flush, it never calls TakLib
+static void* timerMain(void*) {
+    Writer& state = writer();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (true) {
+        if (state.pending.empty() || state.window == Clock::duration::zero() || state.flushQueued) {
+            state.changed.wait(lock);
+            continue;
+        }
+        Clock::time_point due = state.oldest + state.window;
+        if (Clock::now() < due) {
+            state.changed.wait_until(lock, due);
+            continue;
+        }
+        state.flushQueued = workerPoolSubmit(SUBSYSTEM_STORAGE, LANE_BACKGROUND, flushJob, NULL);
+        if (!state.flushQueued) {
+            // Tried again once another window has elapsed
+            state.oldest = Clock::now();
+        }
+    }
+    return NULL;
+}
+
+// Must be called with the writer mutex held
+static bool startTimer(Writer& state) {
+    if (state.timerStarted) {
+        return true;
+    }
+    pthread_attr_t attributes;
+    if (pthread_attr_init(&attributes) != 0) {
+        return false;
+    }
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    state.timerStarted = pthread_create(&thread, &attributes, timerMain, NULL) == 0;
+    pthread_attr_destroy(&attributes);
+    return state.timerStarted;
+}
+
+// Must be called with the storage lock held, and not the writer mutex
+static int32_t probeStorage(const char* storageName) {
+    TAK_byte_buffer value = {NULL, 0};
+    int32_t returnCode = storageCacheRead(storageName, kProbeKey, &value);
+    if (value.data != NULL) {
+        free(value.data);
+    }
+    return returnCode == TAK_STORAGE_KEY_NOT_FOUND ? TAK_SUCCESS : returnCode;
+}
+
+extern "C" {
+
+    int32_t storageWriterWrite(const char* storageName, const char* key, TAK_byte_buffer value) {
+        if (storageName == NULL || key == NULL || (value.data == NULL && value.length > 0)) {
+            return TAK_INVALID_PARAMETER;
+        }
+        Writer& state = writer();
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (state.window != Clock::duration::zero() && state.knownStorages.count(storageName) == 0) {
+            // A deferred write to a missing storage would only fail at the next flush
+            lock.unlock();
+            int32_t returnCode = probeStorage(storageName);
+            if (returnCode != TAK_SUCCESS) {
+                return returnCode;
+            }
+            lock.lock();
+            state.knownStorages.insert(storageName);
+        }
+        if (state.window == Clock::duration::zero()) {
+            lock.unlock();
+            return storageCacheWrite(storageName, key, value);
+        }
+
+        state.stats.writes++;
+        std::string keyOfWrite = pendingKey(storageName, key);
+        auto found = state.pending.find(keyOfWrite);
+        if (found != state.pending.end()) {
+            // Last write wins, the key keeps its place in the window
+            state.stats.coalesced++;
+            state.stats.pendingBytes -= found->second.value.size();
+            zeroize(found->second.value);
+            found->second.value.assign(value.data, value.data + value.length);
+            state.stats.pendingBytes += value.length;
+            return TAK_SUCCESS;
+        }
+        if (state.pending.empty()) {
+            state.oldest = Clock::now();
+            state.changed.notify_all();
+        }
+        PendingWrite& write = state.pending[keyOfWrite];
+        write.storageName = storageName;
+        write.key = key;
+        write.value.assign(value.data, value.data + value.length);
+        state.stats.pending = state.pending.size();
+        state.stats.pendingBytes += value.length;
+        return TAK_SUCCESS;
+    }
+
+    bool storageWriterIsDeferring(void) {
+        Writer& state = writer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.window != Clock::duration::zero();
+    }
+
+    int32_t storageWriterRead(const char* storageName, const char* key, TAK_byte_buffer* output) {
+        if (storageName == NULL || key == NULL || output == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        Writer& state = writer();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            auto found = state.pending.find(pendingKey(storageName, key));
+            if (found != state.pending.end()) {
+                const std::vector<unsigned char>& value = found->second.value;
+                output->data = (unsigned char*) malloc(value.size() > 0 ? value.size() : 1);
+                output->length = 0;
+                if (output->data == NULL) {
+                    return TAK_OUT_OF_MEMORY;
+                }
+                memcpy(output->data, value.data(), value.size());
+                output->length = (unsigned int) value.size();
+                return TAK_SUCCESS;
+            }
+        }
+        return storageCacheRead(storageName, key, output);
+    }
+
+    int32_t storageWriterDeleteEntry(const char* storageName, const char* key) {
+        if (storageName == NULL || key == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        Writer& state = writer();
+        bool wasPending = false;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            auto found = state.pending.find(pendingKey(storageName, key));
+            if (found != state.pending.end()) {
+                dropPending(state, found);
+                wasPending = true;
+            }
+        }
+        int32_t returnCode = storageCacheDeleteEntry(storageName, key);
+        // A key that was only written in memory existed for the caller
+        if (wasPending && returnCode == TAK_STORAGE_KEY_NOT_FOUND) {
+            return TAK_SUCCESS;
+        }
+        return returnCode;
+    }
+
+    int32_t storageWriterDeleteStorage(const char* storageName) {
+        if (storageName == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+        Writer& state = writer();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.knownStorages.erase(storageName);
+            std::string prefix = pendingKey(storageName, "");
+            for (auto found = state.pending.begin(); found != state.pending.end();) {
+                auto next = std::next(found);
+                if (found->first.compare(0, prefix.size(), prefix) == 0) {
+                    dropPending(state, found);
+                }
+                found = next;
+            }
+        }
+        return storageCacheDeleteStorage(storageName);
+    }
+
+    int32_t storageWriterFlush(void) {
+        SubsystemLock storage(SUBSYSTEM_STORAGE);
+        Writer& state = writer();
+        flushPending(state);
+        std::lock_guard<std::mutex> lock(state.mutex);
+        int32_t returnCode = state.unreportedError;
+        state.unreportedError = TAK_SUCCESS;
+        return returnCode;
+    }
+
+    void storageWriterDiscard(void) {
+        Writer& state = writer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        while (!state.pending.empty()) {
+            dropPending(state, state.pending.begin());
+        }
+        state.knownStorages.clear();
+        state.unreportedError = TAK_SUCCESS;
+    }
+
+    int32_t storageWriterConfigure(int64_t windowMillis) {
+        if (windowMillis < 0) {
+            return TAK_INVALID_PARAMETER;
+        }
+        SubsystemLock storage(SUBSYSTEM_STORAGE);
+        Writer& state = writer();
+        if (windowMillis == 0) {
+            flushPending(state);
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (windowMillis > 0 && !startTimer(state)) {
+            return TAK_GENERAL_ERROR;
+        }
+        state.window = std::chrono::milliseconds(windowMillis);
+        state.stats.windowMillis = (uint64_t) windowMillis;
+        state.changed.notify_all();
+        return TAK_SUCCESS;
+    }
+
+    void storageWriterSetFlushHooks(int32_t (*beforeFlush)(const char* storageName),
+                                    void (*flushFailed)(const char* storageName, int32_t returnCode)) {
+        Writer& state = writer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.beforeFlush = beforeFlush;
+        state.flushFailed = flushFailed;
+    }
+
+    StorageWriterStats storageWriterGetStats(void) {
+        Writer& state = writer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.stats;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef STORAGE_WRITER_HEADER
+#define STORAGE_WRITER_HEADER
+
+#include <stdint.h>
+#include "native_tak.h"
+
+// Write path of the secure storages.
+//
+// By default every write goes to TakLib right away. Given a window, writes are kept in memory
+// instead and written on the worker pool once the oldest of them has waited for the window. The
+// first deferred write to a storage checks that it exists, so a missing storage is reported by
+// the write rather than by the next flush.
+// Writes to a key that is already pending replace its value, so a key rewritten many times within
+// the window is encrypted and persisted once, with its last value. Reads see the pending values and
+// deletes drop them, so callers observe the same values as without the window.
+//
+// Errors of deferred writes are reported by the next storageWriterFlush. The functions that call
+// TakLib must be called with the storage subsystem lock held, except storageWriterFlush and
+// storageWriterConfigure which take it.
+extern "C" {
+    int32_t storageWriterWrite(const char* storageName, const char* key, TAK_byte_buffer value);
+    // Whether storageWriterWrite keeps the values in memory rather than writing them right away.
+    bool storageWriterIsDeferring(void);
+    int32_t storageWriterRead(const char* storageName, const char* key, TAK_byte_buffer* output);
+    int32_t storageWriterDeleteEntry(const char* storageName, const char* key);
+    int32_t storageWriterDeleteStorage(const char* storageName);
+    // Writes what is pending. Returns the first error of the deferred writes since the last flush.
+    int32_t storageWriterFlush(void);
+    // Zeroes and drops what is pending, for when TakLib is reset.
+    void storageWriterDiscard(void);
+    // A windowMillis of 0 writes right away, flushing what is pending first.
+    int32_t storageWriterConfigure(int64_t windowMillis);
+    // Sets the functions called, with the storage lock held, before the pending writes of each storage
+    // are flushed and after some of them failed. When `beforeFlush` fails, the writes of that storage
+    // are dropped and its error is reported.
+    void storageWriterSetFlushHooks(int32_t (*beforeFlush)(const char* storageName),
+                                    void (*flushFailed)(const char* storageName, int32_t returnCode));
+    StorageWriterStats storageWriterGetStats(void);
+}
+#endif // STORAGE_WRITER_HEADER
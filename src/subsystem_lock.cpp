@@ -0,0 +1,69 @@
+#include "subsystem_lock.h"
+
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+
+// Recursive, so calls made while holding every subsystem can take their own lock again.
+// Never destroyed: detached worker threads may still hold them while static destructors run.
+static std::recursive_mutex* subsystemMutexes() {
+    static std::recursive_mutex* mutexes = new std::recursive_mutex[SUBSYSTEM_COUNT];
+    return mutexes;
+}
+
+// Shared by the calls on TLS connections, held exclusively with every subsystem
+static std::shared_mutex& tlsLibraryMutex() {
+    static std::shared_mutex* mutex = new std::shared_mutex();
+    return *mutex;
+}
+
+// One per socket descriptor ever used. Descriptors are reused by TakLib, so they stay bounded.
+static std::recursive_mutex& tlsConnectionMutex(int socketDescriptor) {
+    static std::mutex* mapMutex = new std::mutex();
+    static std::map<int, std::recursive_mutex*>* mutexes = new std::map<int, std::recursive_mutex*>();
+    std::lock_guard<std::mutex> lock(*mapMutex);
+    std::recursive_mutex*& mutex = (*mutexes)[socketDescriptor];
+    if (mutex == NULL) {
+        mutex = new std::recursive_mutex();
+    }
+    return *mutex;
+}
+
+SubsystemLock::SubsystemLock(TakSubsystem subsystem) : subsystem(subsystem) {
+    subsystemMutexes()[subsystem].lock();
+}
+
+SubsystemLock::~SubsystemLock() {
+    subsystemMutexes()[subsystem].unlock();
+}
+
+TlsConnectionLock::TlsConnectionLock(int socketDescriptor, bool serialized)
+    : socketDescriptor(socketDescriptor), serialized(serialized) {
+    tlsLibraryMutex().lock_shared();
+    if (serialized) {
+        tlsConnectionMutex(socketDescriptor).lock();
+    }
+}
+
+TlsConnectionLock::~TlsConnectionLock() {
+    if (serialized) {
+        tlsConnectionMutex(socketDescriptor).unlock();
+    }
+    tlsLibraryMutex().unlock_shared();
+}
+
+// Always taken in the same order, so two threads cannot each hold what the other waits for.
+// Calls on TLS connections take no subsystem lock, waiting for them last cannot deadlock.
+AllSubsystemsLock::AllSubsystemsLock() {
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        subsystemMutexes()[i].lock();
+    }
+    tlsLibraryMutex().lock();
+}
+
+AllSubsystemsLock::~AllSubsystemsLock() {
+    tlsLibraryMutex().unlock();
+    for (int i = SUBSYSTEM_COUNT - 1; i >= 0; i--) {
+        subsystemMutexes()[i].unlock();
+    }
+}
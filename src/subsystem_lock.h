@@ -0,0 +1,57 @@
+#ifndef SUBSYSTEM_LOCK_HEADER
+#define SUBSYSTEM_LOCK_HEADER
+
+// TakLib must not be used concurrently (see TAK_MULTI_THREAD_ERROR), but its subsystems are
+// independent of each other. Every call into TakLib holds the lock of its subsystem, or the lock of
+// its TLS connection, whether it comes straight from Dart or from the worker pool.
+enum TakSubsystem {
+    SUBSYSTEM_LIFECYCLE,
+    SUBSYSTEM_STORAGE,
+    SUBSYSTEM_TLS,
+    SUBSYSTEM_CRYPTO,
+    SUBSYSTEM_COUNT
+};
+
+class SubsystemLock {
+public:
+    explicit SubsystemLock(TakSubsystem subsystem);
+    ~SubsystemLock();
+
+private:
+    SubsystemLock(const SubsystemLock&) = delete;
+    SubsystemLock& operator=(const SubsystemLock&) = delete;
+
+    TakSubsystem subsystem;
+};
+
+// Serializes the calls on one TLS connection. TakLib keeps every connection apart, so calls on
+// different connections run concurrently, while calls holding every subsystem still wait for all
+// of them. Handshakes lock TLS_NEW_CONNECTION and run one at a time.
+// Calls that only read the state of a connection pass `serialized` false: they do not wait for
+// the calls on the connection, only keep the library from being released meanwhile.
+static const int TLS_NEW_CONNECTION = -1;
+
+class TlsConnectionLock {
+public:
+    explicit TlsConnectionLock(int socketDescriptor, bool serialized = true);
+    ~TlsConnectionLock();
+
+private:
+    TlsConnectionLock(const TlsConnectionLock&) = delete;
+    TlsConnectionLock& operator=(const TlsConnectionLock&) = delete;
+
+    int socketDescriptor;
+    bool serialized;
+};
+
+// Holds every subsystem, for calls changing the state of the whole library.
+class AllSubsystemsLock {
+public:
+    AllSubsystemsLock();
+    ~AllSubsystemsLock();
+
+private:
+    AllSubsystemsLock(const AllSubsystemsLock&) = delete;
+    AllSubsystemsLock& operator=(const AllSubsystemsLock&) = delete;
+};
+#endif // SUBSYSTEM_LOCK_HEADER
@@ -0,0 +1,192 @@
+#include "runtime_policy.h"
+
+#include <stdio.h>
+
+static int gFailures = 0;
+
+#define CHECK(condition)                                                     \
+    do {                                                                     \
+        if (!(condition)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                    #condition);                                             \
+            gFailures++;                                                     \
+        }                                                                    \
+    } while (0)
+
+typedef std::chrono::milliseconds Millis;
+
+static const RuntimeClock::time_point kStart = RuntimeClock::time_point() + std::chrono::hours(1);
+
+static RuntimePolicyConfig config(uint64_t budgetMicros) {
+    RuntimePolicyConfig config;
+    config.interval = std::chrono::seconds(1);
+    config.window = std::chrono::seconds(10);
+    config.maxGap = std::chrono::seconds(4);
+    config.budgetMicros = budgetMicros;
+    return config;
+}
+
+// Drives the policy every 100 ms, like the controller thread, with the TakLib thread using
+// `runMicros` of CPU during the first 200 ms of every interval it is running
+struct Driver {
+    RuntimePolicyConfig config;
+    RuntimePolicy policy;
+    RuntimeClock::time_point now = kStart;
+    uint64_t cpuMicros = 0;
+    RuntimeClock::time_point threadStartedAt = kStart;
+    bool sampled = true;
+    bool startFails = false;
+    int stops = 0;
+    int starts = 0;
+
+    explicit Driver(const RuntimePolicyConfig& config) : config(config) {
+        runtimePolicyReset(&policy, sampled, now);
+    }
+
+    RuntimeAction step(bool busy, uint64_t runMicros) {
+        now += Millis(100);
+        if (policy.threadActive) {
+            int64_t sinceStart = std::chrono::duration_cast<Millis>(now - threadStartedAt).count();
+            // The thread runs its checks between 1000 and 1200 ms of every interval
+            if ((sinceStart % 1000 == 100 || sinceStart % 1000 == 200) && sinceStart >= 1000) {
+                cpuMicros += runMicros / 2;
+            }
+        }
+        RuntimeAction action = runtimePolicyStep(&policy, config, busy, sampled, cpuMicros, now);
+        if (action == RUNTIME_STOP_THREAD) {
+            stops++;
+            runtimePolicyThreadStopped(&policy, config, now);
+        } else if (action == RUNTIME_START_THREAD) {
+            if (startFails) {
+                runtimePolicyStartFailed(&policy, now);
+            } else {
+                // A new thread, its CPU time starts over
+                starts++;
+                threadStartedAt = now;
+                cpuMicros = 0;
+                runtimePolicyThreadStarted(&policy, sampled, now);
+            }
+        }
+        return action;
+    }
+
+    void run(Millis duration, bool busy, uint64_t runMicros) {
+        for (int64_t i = 0; i < duration.count() / 100; i++) {
+            step(busy, runMicros);
+        }
+    }
+};
+
+static void testRunsAreMeasured() {
+    Driver driver(config(0));
+    driver.run(Millis(3500), false, 20000);
+    CHECK(driver.policy.stats.runs == 3);
+    CHECK(driver.policy.stats.lastRunMicros == 20000);
+    CHECK(driver.policy.stats.totalRunMicros == 60000);
+    CHECK(driver.policy.stats.maxJitterMicros == 0);
+    CHECK(driver.policy.stats.sampled == 1);
+    CHECK(driver.stops == 0);
+}
+
+static void testBusyDefersUntilMaxGap() {
+    Driver driver(config(0));
+    driver.run(Millis(1500), false, 20000);
+    CHECK(driver.policy.stats.runs == 1);
+    driver.step(true, 20000);
+    CHECK(driver.stops == 1);
+    CHECK(driver.policy.stats.active == 0);
+    // Stays stopped while busy, until the last run is older than the maximum gap
+    driver.run(Millis(3000), true, 20000);
+    CHECK(driver.starts == 0);
+    CHECK(driver.policy.stats.skippedSlots >= 2);
+    driver.run(Millis(1000), true, 20000);
+    CHECK(driver.starts == 1);
+    CHECK(driver.policy.stats.forcedStarts == 1);
+}
+
+static void testIdleRestartsRightAway() {
+    Driver driver(config(0));
+    driver.step(true, 20000);
+    CHECK(driver.stops == 1);
+    driver.step(false, 20000);
+    CHECK(driver.starts == 1);
+    CHECK(driver.policy.stats.forcedStarts == 0);
+}
+
+static void testRunIsNotInterrupted() {
+    Driver driver(config(0));
+    // 1100 ms: the thread is in the middle of its first run
+    driver.run(Millis(1100), false, 20000);
+    CHECK(driver.policy.inRun);
+    driver.step(true, 20000);
+    CHECK(driver.stops == 0);
+    driver.step(true, 20000);
+    CHECK(driver.stops == 1);
+    CHECK(driver.policy.stats.runs == 1);
+}
+
+static void testBudgetStopsUntilNextWindow() {
+    Driver driver(config(50000));
+    driver.run(Millis(3500), false, 20000);
+    // Third run brings the window to 60 ms, over the 50 ms budget
+    CHECK(driver.policy.stats.windowRunMicros == 60000);
+    CHECK(driver.stops == 1);
+    // The maximum gap forces runs while over budget
+    driver.run(Millis(4500), false, 20000);
+    CHECK(driver.policy.stats.forcedStarts >= 1);
+    // A new window resets the budget
+    driver.run(Millis(2500), false, 20000);
+    CHECK(driver.policy.stats.windowRunMicros < 50000);
+}
+
+static void testUnsampledThreadIsAssumedToRun() {
+    Driver driver(config(1));
+    driver.sampled = false;
+    runtimePolicyReset(&driver.policy, false, driver.now);
+    CHECK(driver.policy.stats.sampled == 0);
+    driver.run(Millis(5000), false, 20000);
+    // Without samples the budget cannot be enforced and the thread is never overdue
+    CHECK(driver.policy.stats.runs == 0);
+    CHECK(driver.stops == 0);
+    CHECK(driver.policy.stats.active == 1);
+}
+
+static void testLostThreadStopsSampling() {
+    Driver driver(config(0));
+    driver.run(Millis(1500), false, 20000);
+    CHECK(driver.policy.stats.sampled == 1);
+    driver.sampled = false;
+    driver.step(false, 20000);
+    CHECK(driver.policy.stats.sampled == 0);
+    CHECK(!driver.policy.inRun);
+}
+
+static void testFailedStartIsRetriedLater() {
+    Driver driver(config(0));
+    driver.step(true, 20000);
+    driver.startFails = true;
+    CHECK(driver.step(false, 20000) == RUNTIME_START_THREAD);
+    // Not tried again before the retry period
+    for (int i = 0; i < 9; i++) {
+        CHECK(driver.step(false, 20000) == RUNTIME_KEEP);
+    }
+    CHECK(driver.step(false, 20000) == RUNTIME_START_THREAD);
+}
+
+int main() {
+    testRunsAreMeasured();
+    testBusyDefersUntilMaxGap();
+    testIdleRestartsRightAway();
+    testRunIsNotInterrupted();
+    testBudgetStopsUntilNextWindow();
+    testUnsampledThreadIsAssumedToRun();
+    testLostThreadStopsSampling();
+    testFailedStartIsRetriedLater();
+
+    if (gFailures != 0) {
+        fprintf(stderr, "%d checks failed\n", gFailures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
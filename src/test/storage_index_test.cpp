@@ -0,0 +1,154 @@
+#include "storage_index.h"
+#include "storage_writer.h"
+#include "subsystem_lock.h"
+
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static int gFailures = 0;
+
+#define CHECK(condition)                                                     \
+    do {                                                                     \
+        if (!(condition)) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                    #condition);                                             \
+            gFailures++;                                                     \
+        }                                                                    \
+    } while (0)
+
+static const std::string kIndexKey = std::string("\x1f") + "tak.keyIndex";
+
+// In-memory TakLib storage. Writes to the keys in `gFailingKeys` fail, and so do writes of the key
+// index once `gIndexWritesLeft` reaches 0.
+static std::map<std::string, std::map<std::string, std::vector<unsigned char>>> gStorages;
+static std::vector<std::string> gFailingKeys;
+static int gIndexWritesLeft = -1;
+
+static bool isFailing(const char* key) {
+    if (kIndexKey == key && gIndexWritesLeft >= 0 && gIndexWritesLeft-- == 0) {
+        gIndexWritesLeft = 0;
+        return true;
+    }
+    for (const std::string& failing : gFailingKeys) {
+        if (failing == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+extern "C" {
+    TAK_RETURN TakLib_storageWrite(const char* storageName, const char* key, TAK_byte_buffer value) {
+        auto storage = gStorages.find(storageName);
+        if (storage == gStorages.end()) {
+            return TAK_STORAGE_NOT_FOUND;
+        }
+        if (isFailing(key)) {
+            return TAK_GENERAL_ERROR;
+        }
+        storage->second[key].assign(value.data, value.data + value.length);
+        return TAK_SUCCESS;
+    }
+
+    TAK_RETURN TakLib_storageRead(const char* storageName, const char* key, TAK_byte_buffer* value) {
+        auto storage = gStorages.find(storageName);
+        if (storage == gStorages.end()) {
+            return TAK_STORAGE_NOT_FOUND;
+        }
+        auto found = storage->second.find(key);
+        if (found == storage->second.end()) {
+            return TAK_STORAGE_KEY_NOT_FOUND;
+        }
+        value->data = (unsigned char*) malloc(found->second.size() + 1);
+        memcpy(value->data, found->second.data(), found->second.size());
+        value->length = (unsigned int) found->second.size();
+        return TAK_SUCCESS;
+    }
+
+    TAK_RETURN TakLib_storageDeleteEntry(const char* storageName, const char* key) {
+        auto storage = gStorages.find(storageName);
+        if (storage == gStorages.end()) {
+            return TAK_STORAGE_NOT_FOUND;
+        }
+        return storage->second.erase(key) > 0 ? TAK_SUCCESS : TAK_STORAGE_KEY_NOT_FOUND;
+    }
+
+    TAK_RETURN TakLib_storageDelete(const char* storageName) {
+        return gStorages.erase(storageName) > 0 ? TAK_SUCCESS : TAK_STORAGE_NOT_FOUND;
+    }
+}
+
+static unsigned char gValue[] = {1, 2, 3};
+static const TAK_byte_buffer kValue = {gValue, sizeof(gValue)};
+
+static void createStorage(const char* storageName) {
+    gStorages[storageName];
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    storageIndexOpen(storageName, true);
+}
+
+static void testMissesAreAnsweredByTheIndex() {
+    createStorage("misses");
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    CHECK(storageIndexWrite("misses", "present", kValue) == TAK_SUCCESS);
+    CHECK(storageIndexIsComplete("misses"));
+    CHECK(storageIndexContains("misses", "present") == TAK_SUCCESS);
+    // Stored behind the index, it is not looked up
+    gStorages["misses"]["unindexed"] = {1};
+    CHECK(storageIndexContains("misses", "unindexed") == TAK_STORAGE_KEY_NOT_FOUND);
+}
+
+static void testFailedFlushIsNotContained() {
+    createStorage("flush");
+    CHECK(storageWriterConfigure(60000) == TAK_SUCCESS);
+    {
+        SubsystemLock lock(SUBSYSTEM_STORAGE);
+        CHECK(storageIndexWrite("flush", "stored", kValue) == TAK_SUCCESS);
+        CHECK(storageIndexWrite("flush", "lost", kValue) == TAK_SUCCESS);
+        CHECK(storageIndexContains("flush", "lost") == TAK_SUCCESS);
+    }
+    gFailingKeys = {"lost"};
+    CHECK(storageWriterFlush() == TAK_GENERAL_ERROR);
+    gFailingKeys.clear();
+    CHECK(storageWriterConfigure(0) == TAK_SUCCESS);
+
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    // The index read again from TakLib still lists the key, whose value was never stored
+    CHECK(storageIndexIsComplete("flush"));
+    CHECK(storageIndexContains("flush", "stored") == TAK_SUCCESS);
+    CHECK(storageIndexContains("flush", "lost") == TAK_STORAGE_KEY_NOT_FOUND);
+    TAK_byte_buffer value = {NULL, 0};
+    CHECK(storageIndexRead("flush", "lost", &value) == TAK_STORAGE_KEY_NOT_FOUND);
+}
+
+static void testFailedWriteIsNotContained() {
+    createStorage("write");
+    SubsystemLock lock(SUBSYSTEM_STORAGE);
+    CHECK(storageIndexWrite("write", "other", kValue) == TAK_SUCCESS);
+    // The index listing the key is stored, removing it again is not
+    gFailingKeys = {"lost"};
+    gIndexWritesLeft = 1;
+    CHECK(storageIndexWrite("write", "lost", kValue) == TAK_GENERAL_ERROR);
+    gFailingKeys.clear();
+    gIndexWritesLeft = -1;
+    storageIndexClear();
+    CHECK(storageIndexContains("write", "other") == TAK_SUCCESS);
+    CHECK(storageIndexContains("write", "lost") == TAK_STORAGE_KEY_NOT_FOUND);
+}
+
+int main() {
+    testMissesAreAnsweredByTheIndex();
+    testFailedFlushIsNotContained();
+    testFailedWriteIsNotContained();
+
+    if (gFailures != 0) {
+        fprintf(stderr, "%d checks failed\n", gFailures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
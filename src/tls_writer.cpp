@@ -0,0 +1,229 @@
+#include "tls_writer.h"
+#include "buffer_pool.h"
+
+#include <memory>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+// Matches the maximum plaintext size of a TLS record
+static const size_t kGatherSize = 16 * 1024;
+
+struct Gather {
+    unsigned char* data;
+    size_t capacity;
+    size_t length;
+    // First error of TakLib_tlsWrite, after which the connection cannot be written any more
+    int32_t failure;
+};
+
+struct WriteBuffer {
+    std::mutex mutex;
+    Gather gather = {NULL, 0, 0, TAK_SUCCESS};
+    size_t autoFlushThreshold = 0;
+    bool flushBeforeRead = false;
+
+    ~WriteBuffer() {
+        if (gather.data != NULL) {
+            // Pending request data must not linger in freed memory
+            memset(gather.data, 0, gather.capacity);
+            free(gather.data);
+        }
+    }
+};
+
+static std::mutex gWriteBuffersMutex;
+static std::unordered_map<int, std::shared_ptr<WriteBuffer>> gWriteBuffers;
+
+static std::shared_ptr<WriteBuffer> findWriteBuffer(int socketDescriptor) {
+    std::lock_guard<std::mutex> lock(gWriteBuffersMutex);
+    auto found = gWriteBuffers.find(socketDescriptor);
+    return found != gWriteBuffers.end() ? found->second : nullptr;
+}
+
+static std::shared_ptr<WriteBuffer> takeWriteBuffer(int socketDescriptor) {
+    std::lock_guard<std::mutex> lock(gWriteBuffersMutex);
+    auto found = gWriteBuffers.find(socketDescriptor);
+    if (found == gWriteBuffers.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<WriteBuffer> buffer = found->second;
+    gWriteBuffers.erase(found);
+    return buffer;
+}
+
+static int32_t flushGather(int socketDescriptor, Gather* gather) {
+    if (gather->length == 0) {
+        return TAK_SUCCESS;
+    }
+    TAK_byte_buffer valueToWrite = {gather->data, (unsigned int) gather->length};
+    int32_t returnCode = TakLib_tlsWrite(socketDescriptor, valueToWrite);
+    gather->length = 0;
+    if (returnCode != TAK_SUCCESS) {
+        // Part of the data may have been sent, so sending it again could corrupt the stream
+        memset(gather->data, 0, gather->capacity);
+        gather->failure = returnCode;
+    }
+    return returnCode;
+}
+
+// Appends the segments to the gather buffer, writing it out whenever it cannot take the next one.
+// Segments that fill a whole gather buffer on their own are written directly without being copied.
+// The gather buffer is allocated on first use when it has none.
+static int32_t gatherSegments(int socketDescriptor, Gather* gather, const TAK_byte_buffer* segments, int count) {
+    for (int i = 0; i < count; i++) {
+        if (segments[i].length > 0 && segments[i].data == NULL) {
+            return TAK_INVALID_PARAMETER;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        const TAK_byte_buffer* segment = &segments[i];
+        if (segment->length == 0) {
+            continue;
+        }
+
+        if (gather->length + segment->length > gather->capacity && gather->length > 0) {
+            int32_t returnCode = flushGather(socketDescriptor, gather);
+            if (returnCode != TAK_SUCCESS) {
+                return returnCode;
+            }
+        }
+
+        if (segment->length >= gather->capacity) {
+            int32_t returnCode = TakLib_tlsWrite(socketDescriptor, *segment);
+            if (returnCode != TAK_SUCCESS) {
+                gather->failure = returnCode;
+                return returnCode;
+            }
+            continue;
+        }
+
+        if (gather->data == NULL) {
+            gather->data = bufferPoolAllocate(gather->capacity);
+            if (gather->data == NULL) {
+                gather->data = (unsigned char*) malloc(gather->capacity);
+            }
+            if (gather->data == NULL) {
+                return TAK_OUT_OF_MEMORY;
+            }
+        }
+        memcpy(gather->data + gather->length, segment->data, segment->length);
+        gather->length += segment->length;
+    }
+    return TAK_SUCCESS;
+}
+
+extern "C" {
+
+    int32_t tlsWriterWrite(int socketDescriptor, const TAK_byte_buffer* segments, int count) {
+        if (segments == NULL || count < 0) {
+            return TAK_INVALID_PARAMETER;
+        }
+
+        std::shared_ptr<WriteBuffer> buffer = findWriteBuffer(socketDescriptor);
+        if (buffer == nullptr) {
+            Gather gather = {NULL, kGatherSize, 0, TAK_SUCCESS};
+            int32_t returnCode = gatherSegments(socketDescriptor, &gather, segments, count);
+            if (returnCode == TAK_SUCCESS) {
+                returnCode = flushGather(socketDescriptor, &gather);
+            }
+            if (gather.data != NULL && !bufferPoolRelease(gather.data)) {
+                free(gather.data);
+            }
+            return returnCode;
+        }
+
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (buffer->gather.failure != TAK_SUCCESS) {
+            return buffer->gather.failure;
+        }
+        int32_t returnCode = gatherSegments(socketDescriptor, &buffer->gather, segments, count);
+        if (returnCode == TAK_SUCCESS && buffer->autoFlushThreshold > 0 &&
+            buffer->gather.length >= buffer->autoFlushThreshold) {
+            returnCode = flushGather(socketDescriptor, &buffer->gather);
+        }
+        return returnCode;
+    }
+
+    int32_t tlsWriterConfigure(int socketDescriptor, size_t bufferSize, size_t autoFlushThreshold, bool flushBeforeRead) {
+        if (bufferSize == 0) {
+            return tlsWriterClose(socketDescriptor);
+        }
+
+        std::shared_ptr<WriteBuffer> buffer = findWriteBuffer(socketDescriptor);
+        if (buffer == nullptr) {
+            std::shared_ptr<WriteBuffer> created = std::make_shared<WriteBuffer>();
+            std::lock_guard<std::mutex> lock(gWriteBuffersMutex);
+            buffer = gWriteBuffers.emplace(socketDescriptor, created).first->second;
+        }
+
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (buffer->gather.failure != TAK_SUCCESS) {
+            return buffer->gather.failure;
+        }
+        int32_t returnCode = flushGather(socketDescriptor, &buffer->gather);
+        if (buffer->gather.capacity != bufferSize) {
+            unsigned char* data = (unsigned char*) malloc(bufferSize);
+            if (data == NULL) {
+                return TAK_OUT_OF_MEMORY;
+            }
+            if (buffer->gather.data != NULL) {
+                memset(buffer->gather.data, 0, buffer->gather.capacity);
+                free(buffer->gather.data);
+            }
+            buffer->gather.data = data;
+            buffer->gather.capacity = bufferSize;
+        }
+        buffer->autoFlushThreshold = autoFlushThreshold < bufferSize ? autoFlushThreshold : bufferSize;
+        buffer->flushBeforeRead = flushBeforeRead;
+        return returnCode;
+    }
+
+    int32_t tlsWriterFlush(int socketDescriptor) {
+        std::shared_ptr<WriteBuffer> buffer = findWriteBuffer(socketDescriptor);
+        if (buffer == nullptr) {
+            return TAK_SUCCESS;
+        }
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (buffer->gather.failure != TAK_SUCCESS) {
+            return buffer->gather.failure;
+        }
+        return flushGather(socketDescriptor, &buffer->gather);
+    }
+
+    int32_t tlsWriterBeforeRead(int socketDescriptor) {
+        std::shared_ptr<WriteBuffer> buffer = findWriteBuffer(socketDescriptor);
+        if (buffer == nullptr) {
+            return TAK_SUCCESS;
+        }
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (buffer->gather.failure != TAK_SUCCESS) {
+            return buffer->gather.failure;
+        }
+        return buffer->flushBeforeRead ? flushGather(socketDescriptor, &buffer->gather) : TAK_SUCCESS;
+    }
+
+    bool tlsWriterHasFailed(int socketDescriptor) {
+        std::shared_ptr<WriteBuffer> buffer = findWriteBuffer(socketDescriptor);
+        if (buffer == nullptr) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        return buffer->gather.failure != TAK_SUCCESS;
+    }
+
+    int32_t tlsWriterClose(int socketDescriptor) {
+        std::shared_ptr<WriteBuffer> buffer = takeWriteBuffer(socketDescriptor);
+        if (buffer == nullptr) {
+            return TAK_SUCCESS;
+        }
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        // A failure was already reported by the write or flush that hit it
+        if (buffer->gather.failure != TAK_SUCCESS) {
+            return TAK_SUCCESS;
+        }
+        return flushGather(socketDescriptor, &buffer->gather);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef TLS_WRITER_HEADER
+#define TLS_WRITER_HEADER
+
+#include <stddef.h>
+#include "native_tak.h"
+
+// Write path of the TLS connections.
+//
+// By default every call is sent right away, gathering its segments into as few TakLib_tlsWrite as
+// possible. A connection can be given a write buffer instead: writes are then combined until the
+// buffer fills, the auto-flush threshold is reached, an explicit flush, or (optionally) the next read.
+//
+// When TakLib fails to write buffered data, part of it may already have been sent, so it is not
+// sent again. The data is dropped and the connection is marked failed: every later write, flush or
+// read returns the same error and it reports itself closed. It can only be closed.
+extern "C" {
+    int32_t tlsWriterWrite(int socketDescriptor, const TAK_byte_buffer* segments, int count);
+    // A bufferSize of 0 removes the write buffer of the connection, flushing it first.
+    // An autoFlushThreshold of 0 only flushes when the buffer cannot take the next write.
+    int32_t tlsWriterConfigure(int socketDescriptor, size_t bufferSize, size_t autoFlushThreshold, bool flushBeforeRead);
+    int32_t tlsWriterFlush(int socketDescriptor);
+    // Flushes the connection if it was configured to do so before reading.
+    int32_t tlsWriterBeforeRead(int socketDescriptor);
+    // Whether writing buffered data to the connection failed.
+    bool tlsWriterHasFailed(int socketDescriptor);
+    // Flushes what is pending and forgets the connection.
+    int32_t tlsWriterClose(int socketDescriptor);
+}
+#endif // TLS_WRITER_HEADER
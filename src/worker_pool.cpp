@@ -0,0 +1,225 @@
+#include "worker_pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <pthread.h>
+
+// Jobs of a subsystem that may run at the same time. TLS jobs only wait for the jobs on their own
+// connection, the others would wait for their subsystem lock.
+static const int kSubsystemConcurrency[SUBSYSTEM_COUNT] = {1, 1, 4, 1};
+// One thread per job that can run at the same time
+static const int kDefaultMaxThreads = 7;
+static const int kLaneCount = 3;
+// How long a job of each lane may be overtaken by jobs of higher lanes
+static const std::chrono::microseconds kLaneDelays[kLaneCount] = {
+    std::chrono::microseconds(0),
+    std::chrono::microseconds(50 * 1000),
+    std::chrono::microseconds(500 * 1000),
+};
+
+typedef std::chrono::steady_clock Clock;
+
+struct Job {
+    void (*run)(void*);
+    void* argument;
+    Clock::time_point queuedAt;
+};
+
+struct Pool {
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs[SUBSYSTEM_COUNT][kLaneCount];
+    int busy[SUBSYSTEM_COUNT] = {};
+    int threads = 0;
+    int idleThreads = 0;
+    int maxThreads = kDefaultMaxThreads;
+    void (*threadStartHook)(void) = NULL;
+
+    uint64_t queued[kLaneCount] = {};
+    uint64_t peakQueued = 0;
+    uint64_t running = 0;
+    uint64_t dispatched = 0;
+    uint64_t agedDispatches = 0;
+    uint64_t totalWaitMicros = 0;
+    uint64_t maxWaitMicros = 0;
+};
+
+// Never destroyed: detached threads may still wait on it while static destructors run at exit
+static Pool& pool() {
+    static Pool* instance = new Pool();
+    return *instance;
+}
+
+// Must be called with the pool mutex held
+static bool takeNextJob(Pool& state, Job* job, int* subsystem) {
+    int bestSubsystem = -1;
+    int bestLane = -1;
+    int highestLane = kLaneCount;
+    Clock::time_point bestDeadline;
+
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        if (state.busy[i] >= kSubsystemConcurrency[i]) {
+            continue;
+        }
+        for (int lane = 0; lane < kLaneCount; lane++) {
+            if (state.jobs[i][lane].empty()) {
+                continue;
+            }
+            if (lane < highestLane) {
+                highestLane = lane;
+            }
+            // Jobs of a lane are queued in order, only its first one can have the earliest deadline
+            Clock::time_point deadline = state.jobs[i][lane].front().queuedAt + kLaneDelays[lane];
+            if (bestSubsystem < 0 || deadline < bestDeadline) {
+                bestSubsystem = i;
+                bestLane = lane;
+                bestDeadline = deadline;
+            }
+        }
+    }
+    if (bestSubsystem < 0) {
+        return false;
+    }
+
+    *job = state.jobs[bestSubsystem][bestLane].front();
+    *subsystem = bestSubsystem;
+    state.jobs[bestSubsystem][bestLane].pop_front();
+    state.busy[bestSubsystem]++;
+
+    uint64_t waitMicros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - job->queuedAt).count();
+    state.queued[bestLane]--;
+    state.running++;
+    state.dispatched++;
+    state.totalWaitMicros += waitMicros;
+    if (waitMicros > state.maxWaitMicros) {
+        state.maxWaitMicros = waitMicros;
+    }
+    if (bestLane > highestLane) {
+        state.agedDispatches++;
+    }
+    return true;
+}
+
+// Must be called with the pool mutex held
+static int runnableJobs(Pool& state) {
+    int runnable = 0;
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        size_t queued = 0;
+        for (int lane = 0; lane < kLaneCount; lane++) {
+            queued += state.jobs[i][lane].size();
+        }
+        size_t free = (size_t) (kSubsystemConcurrency[i] - state.busy[i]);
+        runnable += (int) (queued < free ? queued : free);
+    }
+    return runnable;
+}
+
+static void* workerMain(void*) {
+    Pool& state = pool();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    void (*threadStartHook)(void) = state.threadStartHook;
+    if (threadStartHook != NULL) {
+        lock.unlock();
+        threadStartHook();
+        lock.lock();
+    }
+    for (;;) {
+        Job job;
+        int subsystem;
+        state.idleThreads++;
+        state.jobReady.wait(lock, [&] { return takeNextJob(state, &job, &subsystem); });
+        state.idleThreads--;
+
+        lock.unlock();
+        job.run(job.argument);
+        lock.lock();
+
+        state.busy[subsystem]--;
+        state.running--;
+        // Jobs of this subsystem may be waiting while other threads are idle
+        state.jobReady.notify_all();
+    }
+    return NULL;
+}
+
+// Must be called with the pool mutex held
+static bool startThread(Pool& state) {
+    pthread_attr_t attributes;
+    if (pthread_attr_init(&attributes) != 0) {
+        return false;
+    }
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    pthread_t thread;
+    bool started = pthread_create(&thread, &attributes, workerMain, NULL) == 0;
+    pthread_attr_destroy(&attributes);
+    if (started) {
+        state.threads++;
+    }
+    return started;
+}
+
+extern "C" {
+
+    bool workerPoolSubmit(TakSubsystem subsystem, int lane, void (*run)(void*), void* argument) {
+        int laneIndex = lane - LANE_INTERACTIVE;
+        if (run == NULL || subsystem < 0 || subsystem >= SUBSYSTEM_COUNT || laneIndex < 0 || laneIndex >= kLaneCount) {
+            return false;
+        }
+
+        Pool& state = pool();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.jobs[subsystem][laneIndex].push_back(Job{run, argument, Clock::now()});
+        // Every job that can run now should have a thread to run it
+        if (state.idleThreads < runnableJobs(state) && state.threads < state.maxThreads) {
+            // With at least one thread around the job will run eventually
+            if (!startThread(state) && state.threads == 0) {
+                state.jobs[subsystem][laneIndex].pop_back();
+                return false;
+            }
+        }
+
+        state.queued[laneIndex]++;
+        uint64_t queued = state.queued[0] + state.queued[1] + state.queued[2];
+        if (queued > state.peakQueued) {
+            state.peakQueued = queued;
+        }
+        // The woken thread may find the subsystem busy, any idle thread can take the job then
+        state.jobReady.notify_all();
+        return true;
+    }
+
+    void workerPoolSetThreadStartHook(void (*hook)(void)) {
+        Pool& state = pool();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.threadStartHook = hook;
+    }
+
+    int32_t workerPoolConfigure(int maxThreads) {
+        if (maxThreads <= 0) {
+            return TAK_INVALID_PARAMETER;
+        }
+        Pool& state = pool();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.maxThreads = maxThreads;
+        return TAK_SUCCESS;
+    }
+
+    SchedulerStats workerPoolGetStats(void) {
+        Pool& state = pool();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        SchedulerStats stats;
+        stats.interactiveQueued = state.queued[0];
+        stats.normalQueued = state.queued[1];
+        stats.backgroundQueued = state.queued[2];
+        stats.peakQueued = state.peakQueued;
+        stats.running = state.running;
+        stats.threads = state.threads;
+        stats.dispatched = state.dispatched;
+        stats.agedDispatches = state.agedDispatches;
+        stats.totalWaitMicros = state.totalWaitMicros;
+        stats.maxWaitMicros = state.maxWaitMicros;
+        return stats;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef WORKER_POOL_HEADER
+#define WORKER_POOL_HEADER
+
+#include <stddef.h>
+#include "native_tak.h"
+#include "subsystem_lock.h"
+
+// Threads running the blocking TakLib calls requested from Dart.
+//
+// Threads are started on demand, when a job is queued and every thread is busy, up to the
+// configured maximum. They live until the process exits.
+//
+// Jobs of a subsystem run one at a time, since they would wait for each other on the subsystem
+// lock anyway. TLS jobs are the exception: they only wait for the jobs on their own connection,
+// so a few of them run at the same time. Among the subsystems that are free, the next job is the one with the earliest
+// deadline: its queueing time plus the delay of its lane. Interactive jobs overtake normal and
+// background ones, which still run once they have waited for longer than the delay of their lane.
+extern "C" {
+    // Queues `run(argument)`. `lane` is an AsyncLane other than LANE_DEFAULT.
+    // Returns false if the job could not be queued.
+    bool workerPoolSubmit(TakSubsystem subsystem, int lane, void (*run)(void*), void* argument);
+    // Sets a function every thread calls once when it starts, before running jobs.
+    void workerPoolSetThreadStartHook(void (*hook)(void));
+    // Sets the maximum number of threads. Threads already running are kept.
+    int32_t workerPoolConfigure(int maxThreads);
+    SchedulerStats workerPoolGetStats(void);
+}
+#endif // WORKER_POOL_HEADER